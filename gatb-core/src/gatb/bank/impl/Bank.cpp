@@ -23,6 +23,8 @@
 #include <gatb/tools/compression/Leon.hpp>
 
 #include <gatb/bank/impl/BankBinary.hpp>
+#include <gatb/bank/impl/BankBinaryIndexed.hpp>
+#include <gatb/bank/impl/BankKff.hpp>
 #include <gatb/bank/impl/BankAlbum.hpp>
 
 #include <gatb/system/api/Exception.hpp>
@@ -47,6 +49,8 @@ Bank::Bank ()
 {
     /** We register most known factories. */
     _registerFactory_ ("album",  new BankAlbumFactory(),  false);
+    _registerFactory_ (BankBinaryIndexed::name(), new BankBinaryIndexedFactory(), false);
+    _registerFactory_ (BankKff::name(), new BankKffFactory(), false);
     _registerFactory_ ("fasta",  new BankFastaFactory(),  false);
 	_registerFactory_ ("leon", new BankLeonFactory(), false);
     _registerFactory_ ("binary", new BankBinaryFactory(), false);
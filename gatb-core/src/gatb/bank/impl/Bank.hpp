@@ -54,8 +54,11 @@ namespace impl      {
  *
  * Today, the following factories are registered:
  *  1) BankAlbumFactory
- *  2) BankFastaFactory
- *  3) BankBinaryFactory
+ *  2) BankBinaryIndexedFactory (checked before BankFastaFactory, since its check only reads a header)
+ *  3) BankKffFactory (idem)
+ *  4) BankFastaFactory
+ *  5) BankLeonFactory
+ *  6) BankBinaryFactory
  *
  * During a call to 'open', each factory is tried (in the order of registration)
  * until a correct IBank object is returned; if no valid IBank is found, an exception
@@ -0,0 +1,685 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/bank/impl/BankBinaryIndexed.hpp>
+#include <gatb/tools/misc/api/StringsRepository.hpp>
+
+#include <gatb/system/impl/System.hpp>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+using namespace gatb::core::tools::misc;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace bank {  namespace impl {
+/********************************************************************************/
+
+/** Size above which a block is appended to the file. */
+static const size_t BLOCK_SIZE = 1 << 20;
+
+static const u_int64_t MAGIC_NUMBER = 0x4741544242494e32ULL;  // "GATBBIN2"
+
+static const u_int32_t VERSION = 2;
+
+/** Flags of the stored streams. */
+static const u_int32_t FLAG_COMMENTS = 1;
+static const u_int32_t FLAG_QUALITY  = 2;
+
+/** Header: magic number, version and flags, nb sequences, total size, max size, nb blocks, index offset. */
+struct Header
+{
+    u_int64_t magic;
+    u_int32_t version;
+    u_int32_t flags;
+    u_int64_t nbSequences;
+    u_int64_t totalSize;
+    u_int64_t maxSize;
+    u_int64_t nbBlocks;
+    u_int64_t indexOffset;
+};
+
+/** Size of the block header: sizes of the nucleotides, comments and quality streams. */
+static const size_t BLOCK_HEADER_SIZE = 3*sizeof(u_int32_t);
+
+/** Size of the sequence header in a block: length and number of runs of invalid characters. */
+static const size_t SEQ_HEADER_SIZE = 2*sizeof(u_int32_t);
+
+/** Append a string (length and characters) to a stream. */
+static void appendString (vector<u_int8_t>& stream, const string& str)
+{
+    u_int32_t len   = str.size();
+    size_t    start = stream.size();
+    stream.resize (start + sizeof(len) + len);
+    memcpy (stream.data() + start,               &len,        sizeof(len));
+    memcpy (stream.data() + start + sizeof(len), str.data(),  len);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinaryIndexed::BankBinaryIndexed (const std::string& filename, bool withComments, bool withQuality)
+    : _filename(filename), _file(0), _withComments(withComments), _withQuality(withQuality),
+      _nbSequences(0), _totalSize(0), _maxSize(0), _isIndexed(false),
+      _writer(0), _synchro(0)
+{
+    _synchro = System::thread().newSynchronizer();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinaryIndexed::~BankBinaryIndexed ()
+{
+    if (_file != 0)  {  flush ();  }
+
+    delete _writer;
+
+    if (_file != 0)  {  fclose (_file);  }
+
+    delete _synchro;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : not thread safe; use one Writer per thread instead.
+*********************************************************************/
+void BankBinaryIndexed::insert (const Sequence& seq)
+{
+    if (_writer == 0)  {  _writer = new Writer (*this);  }
+
+    _writer->insert (seq);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the writers used concurrently must have been flushed before.
+*********************************************************************/
+void BankBinaryIndexed::flush ()
+{
+    if (_writer != 0)  {  _writer->flush();  }
+
+    /** An empty bank is still a valid file. */
+    if (_isIndexed == false && System::file().doesExist (_filename) == false)  {  open ();  }
+
+    if (_file != 0)
+    {
+        u_int64_t indexOffset = ftell (_file);
+
+        bool ok = _blocks.empty() || fwrite (_blocks.data(), sizeof(BlockInfo), _blocks.size(), _file) == _blocks.size();
+
+        /** The header is written again, with the counts and the index offset. */
+        ok = ok && fseek (_file, 0, SEEK_SET) == 0;
+        if (ok)
+        {
+            Header header = { MAGIC_NUMBER, VERSION, (_withComments ? FLAG_COMMENTS : 0) | (_withQuality ? FLAG_QUALITY : 0),
+                _nbSequences, _totalSize, _maxSize, _blocks.size(), indexOffset
+            };
+            ok = fwrite (&header, sizeof(header), 1, _file) == 1;
+        }
+
+        fclose (_file);
+        _file = 0;
+
+        if (!ok)  {  throw ExceptionErrno (STR_BANK_unable_write_file);  }
+
+        _isIndexed = true;
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the header is written with a null index offset, ie. an unfinished file.
+*********************************************************************/
+void BankBinaryIndexed::open ()
+{
+    LocalSynchronizer ls (_synchro);
+
+    if (_file != 0)  { return; }
+
+    _file = fopen (_filename.c_str(), "wb");
+    if (_file == 0)  {  throw ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());  }
+
+    Header header = { MAGIC_NUMBER, VERSION, 0, 0, 0, 0, 0, 0 };
+    if (fwrite (&header, sizeof(header), 1, _file) != 1)  {  throw ExceptionErrno (STR_BANK_unable_write_file);  }
+
+    _blocks.clear();
+    _blocksFirstSequence.clear();
+    _nbSequences = _totalSize = _maxSize = 0;
+    _isIndexed   = false;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : empty blocks are not stored
+*********************************************************************/
+void BankBinaryIndexed::writeBlock (
+    const vector<u_int8_t>& nucleotides, const vector<u_int8_t>& comments, const vector<u_int8_t>& quality,
+    u_int32_t nbSequences, u_int64_t totalSize, u_int64_t maxSize
+)
+{
+    /** We may have to create the file at first call. */
+    open ();
+
+    if (nbSequences == 0)  { return; }
+
+    LocalSynchronizer ls (_synchro);
+
+    u_int32_t sizes[] = { (u_int32_t)nucleotides.size(), (u_int32_t)comments.size(), (u_int32_t)quality.size() };
+
+    BlockInfo info;
+    info.offset      = ftell (_file);
+    info.size        = BLOCK_HEADER_SIZE + sizes[0] + sizes[1] + sizes[2];
+    info.nbSequences = nbSequences;
+
+    bool ok = fwrite (sizes, sizeof(sizes), 1, _file) == 1;
+    ok = ok && fwrite (nucleotides.data(), 1, sizes[0], _file) == sizes[0];
+    ok = ok && (sizes[1] == 0 || fwrite (comments.data(), 1, sizes[1], _file) == sizes[1]);
+    ok = ok && (sizes[2] == 0 || fwrite (quality.data(),  1, sizes[2], _file) == sizes[2]);
+
+    if (!ok)  {  throw ExceptionErrno (STR_BANK_unable_write_file);  }
+
+    _blocks.push_back (info);
+    _blocksFirstSequence.push_back (_nbSequences);
+
+    _nbSequences += nbSequences;
+    _totalSize   += totalSize;
+    if (maxSize > _maxSize)  { _maxSize = maxSize; }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::loadIndex ()
+{
+    LocalSynchronizer ls (_synchro);
+
+    if (_isIndexed)  { return; }
+
+    FILE* file = fopen (_filename.c_str(), "rb");
+    if (file == 0)  {  throw ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());  }
+
+    /** A null index offset means that the file has not been flushed. */
+    Header header;
+    bool ok = fread (&header, sizeof(header), 1, file) == 1
+           && header.magic == MAGIC_NUMBER  &&  header.version == VERSION  &&  header.indexOffset > 0;
+
+    if (ok)
+    {
+        _blocks.resize (header.nbBlocks);
+        ok = fseek (file, header.indexOffset, SEEK_SET) == 0
+          && (_blocks.empty() || fread (_blocks.data(), sizeof(BlockInfo), _blocks.size(), file) == _blocks.size());
+    }
+
+    fclose (file);
+
+    if (!ok)  {  throw Exception (STR_BANK_unable_open_file, _filename.c_str());  }
+
+    _withComments = (header.flags & FLAG_COMMENTS) != 0;
+    _withQuality  = (header.flags & FLAG_QUALITY)  != 0;
+    _nbSequences  = header.nbSequences;
+    _totalSize    = header.totalSize;
+    _maxSize      = header.maxSize;
+
+    _blocksFirstSequence.resize (_blocks.size());
+    for (size_t b=0, nb=0; b<_blocks.size(); nb += _blocks[b].nbSequences, b++)  {  _blocksFirstSequence[b] = nb;  }
+
+    _isIndexed = true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int64_t BankBinaryIndexed::getSize ()
+{
+    return System::file().getSize (_filename);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the information is exact since it is stored in the file.
+*********************************************************************/
+void BankBinaryIndexed::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize)
+{
+    loadIndex ();
+
+    number    = _nbSequences;
+    totalSize = _totalSize;
+    maxSize   = _maxSize;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::remove ()
+{
+    System::file().remove (_filename);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool BankBinaryIndexed::check (const std::string& uri)
+{
+    bool result = false;
+
+    FILE* file = fopen (uri.c_str(), "rb");
+    if (file != NULL)
+    {
+        Header header;
+        result = fread (&header, sizeof(header), 1, file) == 1  &&  header.magic == MAGIC_NUMBER  &&  header.version == VERSION;
+        fclose (file);
+    }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the nucleotides are encoded as in BankBinary (code = (ascii>>1)&3), the
+**           invalid characters being encoded as 'A' and recorded as runs.
+*********************************************************************/
+void BankBinaryIndexed::Writer::insert (const Sequence& seq)
+{
+    const char*       data     = seq.getDataBuffer();
+    u_int32_t         len      = seq.getDataSize();
+    Data::Encoding_e  encoding = seq.getDataEncoding();
+    size_t            nbBytes  = (len+3)/4;
+
+    size_t start = _block.size();
+    _block.resize (start + SEQ_HEADER_SIZE + nbBytes, 0);
+
+    u_int8_t* bytes = _block.data() + start + SEQ_HEADER_SIZE;
+
+    _runs.clear();
+
+    if (encoding == Data::BINARY)
+    {
+        memcpy (bytes, data, nbBytes);
+    }
+    else
+    {
+        for (u_int32_t i=0; i<len; i++)
+        {
+            u_int8_t c    = data[i];
+            u_int8_t code = (encoding == Data::INTEGER) ? (c & 3) : ((c>>1) & 3);
+
+            if (encoding == Data::ASCII && Data::validNucleotide[c])
+            {
+                /** We extend the current run of invalid characters, or start a new one. */
+                if (!_runs.empty() && _runs[_runs.size()-2] + _runs.back() == i)  {  _runs.back() ++;  }
+                else                                                              {  _runs.push_back (i);  _runs.push_back (1);  }
+                code = 0;
+            }
+
+            bytes[i>>2] |= code << ((3-(i&3))*2);
+        }
+    }
+
+    u_int32_t nbRuns = _runs.size() / 2;
+    memcpy (_block.data() + start,                     &len,    sizeof(len));
+    memcpy (_block.data() + start + sizeof(u_int32_t), &nbRuns, sizeof(nbRuns));
+
+    if (nbRuns > 0)
+    {
+        size_t runsStart = _block.size();
+        _block.resize (runsStart + _runs.size()*sizeof(u_int32_t));
+        memcpy (_block.data() + runsStart, _runs.data(), _runs.size()*sizeof(u_int32_t));
+    }
+
+    if (_ref._withComments)  {  appendString (_comments, seq.getComment());  }
+    if (_ref._withQuality)   {  appendString (_quality,  seq.getQuality());  }
+
+    _nbSequences ++;
+    _totalSize += len;
+    if (len > _maxSize)  { _maxSize = len; }
+
+    if (_block.size() + _comments.size() + _quality.size() >= BLOCK_SIZE)  {  flush();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::Writer::flush ()
+{
+    if (_nbSequences == 0)  { return; }
+
+    _ref.writeBlock (_block, _comments, _quality, _nbSequences, _totalSize, _maxSize);
+
+    reset ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinaryIndexed::Iterator::Iterator (BankBinaryIndexed& ref, size_t* nextBlock)
+    : _ref(ref), _nextBlock(nextBlock), _isDone(true), _bufferData(0), _asciiData(0),
+      _block(0), _cpt_buffer(0), _cpt_comments(0), _cpt_quality(0), _blocksize_toread(0), _file(0), _index(0)
+{
+    setAsciiData (new Data (Data::ASCII));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinaryIndexed::Iterator::~Iterator ()
+{
+    if (_file != 0)  {  fclose (_file);  }
+
+    setBufferData (0);
+    setAsciiData  (0);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::Iterator::first()
+{
+    _ref.loadIndex ();
+
+    if (_file == 0)
+    {
+        /** We open the binary file at first call; each iterator has its own file handle. */
+        _file = fopen (_ref._filename.c_str(), "rb");
+
+        /** We check that the file is opened => send an exception otherwise. */
+        if (_file == 0)  {  throw ExceptionErrno (STR_BANK_unable_open_file, _ref._filename.c_str());  }
+    }
+
+    /** We reinitialize some attributes. */
+    _isDone           = false;
+    _block            = 0;
+    _cpt_buffer       = 0;
+    _blocksize_toread = 0;
+
+    /** We go to the next sequence. */
+    next();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the block of the sequence is found in the index, then the previous sequences
+**           of the block are skipped.
+*********************************************************************/
+void BankBinaryIndexed::Iterator::first (u_int64_t index)
+{
+    if (_nextBlock != 0)  {  throw Exception ("BankBinaryIndexed: no random access with a shared blocks counter");  }
+
+    first ();
+
+    const vector<u_int64_t>& firstSequences = _ref._blocksFirstSequence;
+
+    if (_isDone || index < _index)  { return; }
+
+    /** We look for the block holding the sequence. */
+    size_t b = std::upper_bound (firstSequences.begin(), firstSequences.end(), index) - firstSequences.begin() - 1;
+
+    if (b >= _ref._blocks.size() || index >= _ref._nbSequences)  {  _isDone = true;  return;  }
+
+    _block = b;
+    readBlock ();
+
+    /** We skip the previous sequences of the block. */
+    while (_index < index)  {  skip();  }
+
+    next ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool BankBinaryIndexed::Iterator::readBlock ()
+{
+    size_t b = _nextBlock != 0 ? __sync_fetch_and_add (_nextBlock, 1) : _block++;
+
+    if (b >= _ref._blocks.size())  { return false; }
+
+    const BlockInfo& info = _ref._blocks[b];
+
+    /** We are about to read another chunk of data from the disk. */
+    setBufferData (new Data (info.size));
+
+    if (fseek (_file, info.offset, SEEK_SET) != 0 || fread (_bufferData->getBuffer(), 1, info.size, _file) != info.size)
+    {
+        throw ExceptionErrno (STR_BANK_unable_open_file, _ref._filename.c_str());
+    }
+
+    /** The streams follow the block header. */
+    u_int32_t sizes[3];
+    memcpy (sizes, _bufferData->getBuffer(), sizeof(sizes));
+
+    _cpt_buffer       = BLOCK_HEADER_SIZE;
+    _blocksize_toread = BLOCK_HEADER_SIZE + sizes[0];
+    _cpt_comments     = _blocksize_toread;
+    _cpt_quality      = _blocksize_toread + sizes[1];
+    _index            = _ref._blocksFirstSequence[b];
+
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::Iterator::skip ()
+{
+    const char* buffer = _bufferData->getBuffer() + _cpt_buffer;
+
+    u_int32_t len = 0, nbRuns = 0;
+    memcpy (&len,    buffer,                     sizeof(len));
+    memcpy (&nbRuns, buffer + sizeof(u_int32_t), sizeof(nbRuns));
+
+    _cpt_buffer += SEQ_HEADER_SIZE + (len+3)/4 + 2*nbRuns*sizeof(u_int32_t);
+
+    if (_ref._withComments)  {  memcpy (&len, _bufferData->getBuffer() + _cpt_comments, sizeof(len));  _cpt_comments += sizeof(len) + len;  }
+    if (_ref._withQuality)   {  memcpy (&len, _bufferData->getBuffer() + _cpt_quality,  sizeof(len));  _cpt_quality  += sizeof(len) + len;  }
+
+    _index ++;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+std::string BankBinaryIndexed::Iterator::readString (size_t& cpt)
+{
+    u_int32_t len = 0;
+    memcpy (&len, _bufferData->getBuffer() + cpt, sizeof(len));
+
+    std::string result (_bufferData->getBuffer() + cpt + sizeof(len), len);
+    cpt += sizeof(len) + len;
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::Iterator::next ()
+{
+    static const char table[] = { 'A', 'C', 'T', 'G' };
+
+    /** We may have to read the next block from disk. */
+    while (_cpt_buffer >= _blocksize_toread)
+    {
+        if (readBlock() == false)  {  _isDone = true;  return;  }
+    }
+
+    const char* buffer = _bufferData->getBuffer() + _cpt_buffer;
+
+    u_int32_t len = 0, nbRuns = 0;
+    memcpy (&len,    buffer,                     sizeof(len));
+    memcpy (&nbRuns, buffer + sizeof(u_int32_t), sizeof(nbRuns));
+
+    size_t nbBytes = (len+3)/4;
+
+    if (nbRuns == 0)
+    {
+        /** We refer to the nucleotides in the block (binary encoding). */
+        _item->setDataRef (_bufferData, _cpt_buffer + SEQ_HEADER_SIZE, len);
+    }
+    else
+    {
+        /** We decode the sequence and restore its invalid characters. */
+        const u_int8_t* bytes = (const u_int8_t*) buffer + SEQ_HEADER_SIZE;
+
+        _asciiData->resize (len);
+        char* ascii = _asciiData->getBuffer();
+
+        for (u_int32_t i=0; i<len; i++)  {  ascii[i] = table[(bytes[i>>2] >> ((3-(i&3))*2)) & 3];  }
+
+        const char* runs = buffer + SEQ_HEADER_SIZE + nbBytes;
+        for (u_int32_t r=0; r<nbRuns; r++)
+        {
+            u_int32_t run[2];
+            memcpy (run, runs + r*sizeof(run), sizeof(run));
+            memset (ascii + run[0], 'N', run[1]);
+        }
+
+        _item->setDataRef (_asciiData, 0, len);
+    }
+
+    /** We set the comment and the quality, if stored. */
+    if (_ref._withComments)  {  _item->setComment (readString (_cpt_comments));  }
+    if (_ref._withQuality)   {  _item->setQuality (readString (_cpt_quality));   }
+
+    /** We set the sequence index. */
+    _item->setIndex (_index++);
+
+    /** We go ahead in the block parsing. */
+    _cpt_buffer += SEQ_HEADER_SIZE + nbBytes + 2*nbRuns*sizeof(u_int32_t);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize)
+{
+    _ref.estimate (number, totalSize, maxSize);
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
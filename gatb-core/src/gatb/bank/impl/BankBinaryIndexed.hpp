@@ -0,0 +1,356 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file BankBinaryIndexed.hpp
+ *  \brief Binary bank format with a blocks index
+ */
+
+#ifndef _GATB_CORE_BANK__IMPL_BANK_BINARY_INDEXED_HPP_
+#define _GATB_CORE_BANK__IMPL_BANK_BINARY_INDEXED_HPP_
+
+/********************************************************************************/
+
+#include <gatb/bank/impl/AbstractBank.hpp>
+#include <gatb/tools/designpattern/api/ICommand.hpp>
+#include <gatb/system/api/IThread.hpp>
+
+#include <vector>
+#include <string>
+#include <stdio.h>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace bank      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Implementation of IBank for a compressed format indexed by blocks
+ *
+ * This is the version 2 of the binary format of BankBinary. As in BankBinary, nucleotides are
+ * stored on 2 bits (4 nucleotides in one byte, the first one in the high bits), but:
+ *    - the invalid characters (like 'N') are kept: each sequence has the list of its runs of
+ *      invalid characters, which are restored as 'N' when the sequence is read.
+ *    - the comments and the qualities of the sequences may be stored too.
+ *    - the header gives the exact number of sequences, and the file ends with an index of its
+ *      blocks, so blocks can be read independently.
+ *
+ * A file is made of:
+ *    - a header: magic number, version and flags (comments, qualities), number of sequences, total
+ *      and max sizes of the sequences, number of blocks and offset of the index (8 bytes each,
+ *      version and flags being 4 bytes each)
+ *    - a list of blocks; a block has the sizes of its 3 streams (4 bytes each), then the streams:
+ *        - nucleotides; for each sequence:
+ *            - a sequence length (on 4 bytes)
+ *            - a number of runs of invalid characters (on 4 bytes)
+ *            - the nucleotides of the sequence (4 nucleotides encoded in 1 byte)
+ *            - the runs of invalid characters, as (position,length) pairs (4 bytes each)
+ *        - comments (if any); for each sequence, a length (on 4 bytes) and the characters
+ *        - qualities (if any); for each sequence, a length (on 4 bytes) and the characters
+ *    - the blocks index: for each block, its offset in the file (8 bytes), its size (4 bytes)
+ *      and its number of sequences (4 bytes)
+ *
+ * Sequences without invalid characters are provided with the Data::BINARY encoding, the other
+ * ones with the Data::ASCII encoding.
+ *
+ * Sequences can be inserted by several threads at the same time through Writer instances
+ * (one per thread); in such a case, the order of the sequences in the bank is not the insertion one.
+ *
+ * Thanks to the index:
+ *    - an iterator can start at any sequence (see Iterator::first(u_int64_t)).
+ *    - a bank can be read by several threads without a shared iterator, each thread decoding
+ *      its own blocks (see the 'iterate' method).
+ */
+class BankBinaryIndexed : public AbstractBank
+{
+public:
+
+    /** Returns the name of the bank format. */
+    static const char* name()  { return "binary_indexed"; }
+
+    /** Constructor. When an existing bank is read, the stored streams are given by the file.
+     * \param[in] filename : uri of the bank.
+     * \param[in] withComments : tells whether the comments of the inserted sequences are stored
+     * \param[in] withQuality : tells whether the qualities of the inserted sequences are stored */
+    BankBinaryIndexed (const std::string& filename, bool withComments=false, bool withQuality=false);
+
+    /** Destructor. */
+    ~BankBinaryIndexed ();
+
+    /** \copydoc IBank::getId. */
+    std::string getId ()  { return _filename; }
+
+    /** \copydoc IBank::iterator */
+    tools::dp::Iterator<Sequence>* iterator ()  { return new Iterator (*this); }
+
+    /** \copydoc IBank::getNbItems */
+    int64_t getNbItems ()  { loadIndex();  return _nbSequences; }
+
+    /** \copydoc IBank::insert */
+    void insert (const Sequence& item);
+
+    /** \copydoc IBank::flush */
+    void flush ();
+
+    /** \copydoc IBank::getSize */
+    u_int64_t getSize ();
+
+    /** \copydoc IBank::estimate */
+    void estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize);
+
+    /** \copydoc IBank::remove. */
+    void remove ();
+
+    /** Check that the given uri is a correct indexed binary bank. */
+    static bool check (const std::string& uri);
+
+    /** Iterate the sequences of the bank with several threads, each thread decoding the blocks
+     * it takes from a shared counter. The provided functor is cloned once per thread (as in
+     * IDispatcher::iterate); the clones are deleted by the calling thread after the iteration.
+     * \param[in] dispatcher : dispatcher providing the threads
+     * \param[in] functor : functor to be called on each sequence */
+    template <typename Functor>
+    void iterate (tools::dp::IDispatcher* dispatcher, const Functor& functor)
+    {
+        loadIndex ();
+
+        size_t nextBlock = 0;
+
+        std::vector<Functor*>               functors;
+        std::vector<tools::dp::ICommand*>   commands;
+        for (size_t i=0; i<dispatcher->getExecutionUnitsNumber(); i++)
+        {
+            functors.push_back (new Functor (functor));
+            commands.push_back (new IterateCommand<Functor> (*this, &nextBlock, *functors.back()));
+        }
+
+        dispatcher->dispatchCommands (commands, 0);
+
+        for (size_t i=0; i<functors.size(); i++)  {  delete functors[i];  }
+    }
+
+    /************************************************************/
+    /** \brief Writer of sequences into the bank.
+     *
+     * A writer fills a block in memory and appends it to the bank when it is full; several
+     * writers of the same bank can be used concurrently. A copy of a writer has its own block,
+     * so a functor holding a writer can be cloned for each thread by a dispatcher.
+     */
+    class Writer
+    {
+    public:
+
+        /** Constructor.
+         * \param[in] ref : the bank to be written. */
+        Writer (BankBinaryIndexed& ref) : _ref(ref)  { reset(); }
+
+        /** Copy constructor: the new writer starts with an empty block. */
+        Writer (const Writer& other) : _ref(other._ref)  { reset(); }
+
+        /** Destructor: the current block is appended to the bank. */
+        ~Writer ()  { flush(); }
+
+        /** Add a sequence to the current block.
+         * \param[in] seq : the sequence to be added. */
+        void insert (const Sequence& seq);
+
+        /** Append the current block to the bank. */
+        void flush ();
+
+    private:
+
+        BankBinaryIndexed&     _ref;
+        std::vector<u_int8_t>  _block;
+        std::vector<u_int8_t>  _comments;
+        std::vector<u_int8_t>  _quality;
+        u_int32_t              _nbSequences;
+        u_int64_t              _totalSize;
+        u_int64_t              _maxSize;
+        std::vector<u_int32_t> _runs;
+
+        void reset ()  { _block.clear();  _comments.clear();  _quality.clear();  _nbSequences = 0;  _totalSize = 0;  _maxSize = 0; }
+
+        Writer& operator= (const Writer&);
+    };
+
+    /************************************************************/
+    /** \brief Specific Iterator impl for BankBinaryIndexed class
+     *
+     * The iterator reads the blocks in the file order, unless it is given a counter shared with
+     * other iterators: in such a case, it reads the blocks it takes from this counter.
+     */
+    class Iterator : public tools::dp::Iterator<Sequence>
+    {
+    public:
+        /** Constructor.
+         * \param[in] ref : the associated iterable instance.
+         * \param[in] nextBlock : counter of blocks shared with other iterators (0 if none).
+         */
+        Iterator (BankBinaryIndexed& ref, size_t* nextBlock=0);
+
+        /** Destructor */
+        virtual ~Iterator ();
+
+        /** \copydoc tools::dp::Iterator::first */
+        void first();
+
+        /** Go to a given sequence; the next sequences are then iterated as usual. Not available
+         * with a counter shared with other iterators.
+         * \param[in] index : index of the sequence in the bank (the end of the iteration if too big) */
+        void first (u_int64_t index);
+
+        /** \copydoc tools::dp::Iterator::next */
+        void next();
+
+        /** \copydoc tools::dp::Iterator::isDone */
+        bool isDone ()  { return _isDone; }
+
+        /** \copydoc tools::dp::Iterator::item */
+        Sequence& item ()  { return *_item; }
+
+        /** Estimation of the sequences information. */
+        void estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize);
+
+    private:
+
+        /** Reference to the underlying Iterable instance. */
+        BankBinaryIndexed&    _ref;
+
+        /** Shared counter of blocks (0 for a sequential iteration). */
+        size_t* _nextBlock;
+
+        /** Tells whether the iteration is finished or not. */
+        bool _isDone;
+
+        /** Block buffer read from file. */
+        tools::misc::Data* _bufferData;
+        void setBufferData (tools::misc::Data* bufferData)  { SP_SETATTR(bufferData); }
+
+        /** Decoded sequence, when it has invalid characters. */
+        tools::misc::Data* _asciiData;
+        void setAsciiData (tools::misc::Data* asciiData)  { SP_SETATTR(asciiData); }
+
+        size_t    _block;
+        size_t    _cpt_buffer;
+        size_t    _cpt_comments;
+        size_t    _cpt_quality;
+        size_t    _blocksize_toread;
+        FILE*     _file;
+        size_t    _index;
+
+        /** Read the next block to be iterated; returns false if there is none. */
+        bool readBlock ();
+
+        /** Go to the next sequence of the current block, without decoding the current one. */
+        void skip ();
+
+        /** Read a string (comment or quality) of the current block. */
+        std::string readString (size_t& cpt);
+    };
+
+protected:
+
+    /** Location of a block in the file. */
+    struct BlockInfo
+    {
+        u_int64_t offset;
+        u_int32_t size;
+        u_int32_t nbSequences;
+    };
+
+    /** URI of the bank. */
+    std::string _filename;
+
+    FILE*       _file;
+
+    /** Stored streams. */
+    bool        _withComments;
+    bool        _withQuality;
+
+    /** Blocks index and counts, built while writing or read from the file. */
+    std::vector<BlockInfo> _blocks;
+    std::vector<u_int64_t> _blocksFirstSequence;
+    u_int64_t              _nbSequences;
+    u_int64_t              _totalSize;
+    u_int64_t              _maxSize;
+    bool                   _isIndexed;
+
+    /** Writer used by the 'insert' method. */
+    Writer*     _writer;
+
+    system::ISynchronizer* _synchro;
+
+    /** Append a block to the file (called by the writers, possibly concurrently). */
+    void writeBlock (
+        const std::vector<u_int8_t>& nucleotides, const std::vector<u_int8_t>& comments, const std::vector<u_int8_t>& quality,
+        u_int32_t nbSequences, u_int64_t totalSize, u_int64_t maxSize
+    );
+
+    /** Write the header of the file, at its beginning. */
+    void writeHeader ();
+
+    /** Create the file, if not already done. */
+    void open ();
+
+    /** Read the header and the index of the file, if not already known. */
+    void loadIndex ();
+
+    /** Command reading blocks for the 'iterate' method. */
+    template <typename Functor>
+    class IterateCommand : public tools::dp::ICommand, public system::SmartPointer
+    {
+    public:
+        IterateCommand (BankBinaryIndexed& ref, size_t* nextBlock, Functor& functor)
+            : _ref(ref), _nextBlock(nextBlock), _functor(functor)  {}
+
+        void execute ()
+        {
+            Iterator it (_ref, _nextBlock);
+            for (it.first(); !it.isDone(); it.next())  {  _functor (it.item());  }
+        }
+
+    private:
+        BankBinaryIndexed& _ref;
+        size_t*            _nextBlock;
+        Functor&           _functor;
+    };
+
+    friend class Writer;
+    friend class Iterator;
+};
+
+/********************************************************************************/
+
+/* \brief Factory for the BankBinaryIndexed class. */
+class BankBinaryIndexedFactory : public IBankFactory
+{
+public:
+
+    /** \copydoc IBankFactory::createBank */
+    IBank* createBank (const std::string& uri)
+    {
+        return BankBinaryIndexed::check(uri) ? new BankBinaryIndexed (uri) : 0;
+    }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_BANK__IMPL_BANK_BINARY_INDEXED_HPP_ */
@@ -51,6 +51,25 @@ namespace gatb {  namespace core { namespace bank { namespace impl {
 
 static const char* progressFormat1 = "Bank: fasta to binary                  ";
 
+/** Functor inserting the sequences into a binary bank; each clone has its own writer. */
+struct InsertSequenceFunctor
+{
+    BankBinaryIndexed::Writer writer;
+    u_int64_t&                nbSeq;
+    u_int64_t&                sizeSeq;
+
+    InsertSequenceFunctor (BankBinaryIndexed& bank, u_int64_t& nbSeq, u_int64_t& sizeSeq)
+        : writer(bank), nbSeq(nbSeq), sizeSeq(sizeSeq)  {}
+
+    void operator() (Sequence& seq)
+    {
+        writer.insert (seq);
+
+        __sync_fetch_and_add (&nbSeq,   1);
+        __sync_fetch_and_add (&sizeSeq, seq.getDataSize());
+    }
+};
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -199,7 +218,7 @@ IBank* BankConverterAlgorithm::createBank (
     ));
 
     /** We create a new binary bank. */
-    IBank* result = new BankBinary (outputName, _kmerSize);
+    BankBinaryIndexed* result = new BankBinaryIndexed (outputName);
 
     /** We need an iterator on the input bank. */
     Iterator<Sequence>* itBank = createIterator<Sequence> (
@@ -209,15 +228,12 @@ IBank* BankConverterAlgorithm::createBank (
     );
     LOCAL (itBank);
 
-    /** We iterate the sequences of the input bank. */
-    for (itBank->first(); !itBank->isDone(); itBank->next())
-    {
-        nbSeq ++;
-        sizeSeq += (*itBank)->getDataSize();
+    /** We iterate the sequences of the input bank; the sequences are encoded by several threads, each one
+     * writing its own blocks. */
+    getDispatcher()->iterate (itBank, InsertSequenceFunctor (*result, nbSeq, sizeSeq));
 
-        /** We insert the current sequence into the output bank. */
-        result->insert (itBank->item());
-    }
+    /** We write the index of the output bank (the writers have been flushed when the functors were deleted). */
+    result->flush ();
 
     return result;
 }
@@ -49,6 +49,9 @@ namespace impl      {
  *
  * Historically, it was used by DSK to work on a binary bank instead of a FASTA
  * bank (ie. less I/O operations because of smaller size of binary banks)
+ *
+ * The output is a BankBinaryIndexed (version 2 of the binary format), filled by the threads
+ * of the algorithm dispatcher; so the order of the sequences is not kept with several threads.
  */
 class BankConverterAlgorithm : public gatb::core::tools::misc::impl::Algorithm
 {
@@ -56,7 +59,7 @@ public:
 
     /** Constructor.
      * \param[in] bank : bank to be converted (likely in FASTA format)
-     * \param[in] kmerSize : kmer size
+     * \param[in] kmerSize : kmer size (not used anymore: the sequences are not split at invalid characters)
      * \param[in] outputUri : uri of the output binary bank. */
     BankConverterAlgorithm (IBank* bank, size_t kmerSize, const std::string& outputUri);
 
@@ -0,0 +1,430 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/bank/impl/BankKff.hpp>
+#include <gatb/tools/misc/api/StringsRepository.hpp>
+#include <gatb/system/impl/System.hpp>
+
+#include <kff-cpp-api/kff_io.hpp>
+
+#include <stdexcept>
+#include <string.h>
+#include <stdio.h>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+using namespace gatb::core::tools::misc;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace bank {  namespace impl {
+/********************************************************************************/
+
+/** Number of bytes needed for a given number of bits. */
+static u_int64_t nbBytes (u_int64_t nbBits)  {  return (nbBits + 7) / 8;  }
+
+/** Number of bits needed for the values of [0,n[ (as computed by the KFF library). */
+static u_int64_t nbBits (u_int64_t n)  {  u_int64_t b = 0;  while ((1ULL << b) < n)  { b++; }  return b;  }
+
+/** Set the global variables of the KFF library needed to read a blocks section. */
+static void setVariables (Kff_file& file, size_t k, u_int64_t m, u_int64_t max, u_int64_t dataSize, bool isMinimizer)
+{
+    file.global_vars.clear();
+    file.global_vars["k"]         = k;
+    file.global_vars["max"]       = max;
+    file.global_vars["data_size"] = dataSize;
+    if (isMinimizer)  {  file.global_vars["m"] = m;  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankKff::BankKff (const std::string& filename)
+    : _filename(filename), _kmerSize(0), _dataSize(0), _nbBlocks(0), _nbKmers(0), _maxSize(0),
+      _isIndexed(false), _synchro(0)
+{
+    _synchro = System::thread().newSynchronizer();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankKff::~BankKff ()
+{
+    delete _synchro;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankKff::insert (const Sequence& seq)
+{
+    throw Exception ("KFF bank '%s' is read only", _filename.c_str());
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the whole file is scanned once. Sections with one k-mer per block (max=1) are
+**           jumped over, the other ones are read for counting their k-mers.
+*********************************************************************/
+void BankKff::loadIndex ()
+{
+    LocalSynchronizer ls (_synchro);
+
+    if (_isIndexed)  { return; }
+
+    try
+    {
+        Kff_file file (_filename, "r");
+        file.complete_header ();
+
+        memcpy (_encoding, file.encoding, sizeof(_encoding));
+
+        vector<u_int8_t> seq, data;
+
+        while (file.tellp() < file.end_position)
+        {
+            char type = file.read_section_type();
+
+            if (type == 'v')  {  Section_GV    gv (&file);  gv.close();  continue;  }
+            if (type == 'i')  {  Section_Index si (&file);  si.close();  continue;  }
+
+            if (type != 'r' && type != 'm')  {  throw Exception ("unknown section '%c'", type);  }
+
+            SectionInfo info;
+            info.offset      = file.tellp();
+            info.isMinimizer = type == 'm';
+
+            Block_section_reader* section = Block_section_reader::construct_section (&file);
+
+            if (_kmerSize != 0 && section->k != _kmerSize)
+            {
+                size_t k = section->k;
+                delete section;
+                throw Exception ("sections with different kmer sizes (%ld and %ld)", _kmerSize, k);
+            }
+
+            _kmerSize     = section->k;
+            info.m        = info.isMinimizer ? file.global_vars["m"] : 0;
+            info.max      = section->max;
+            info.dataSize = section->data_size;
+            info.nbBlocks = section->nb_blocks;
+            info.nbKmers  = 0;
+
+            if (info.max == 1)
+            {
+                /** Blocks have a fixed size: no k-mers number, the minimizer position if any, the nucleotides and the data. */
+                u_int64_t blockSize = info.isMinimizer ?
+                    nbBytes (nbBits (_kmerSize + info.max - 1)) + (_kmerSize - info.m + 3) / 4 + info.dataSize :
+                    (_kmerSize + 3) / 4 + info.dataSize;
+
+                info.nbKmers = info.nbBlocks;
+                file.jump (info.nbBlocks * blockSize);
+            }
+            else
+            {
+                seq.resize  ((info.max + _kmerSize - 1 + 3) / 4);
+                data.resize (info.max * info.dataSize + 1);
+
+                for (u_int64_t b=0; b<info.nbBlocks; b++)
+                {
+                    u_int64_t nb = section->read_compacted_sequence (seq.data(), data.data());
+                    info.nbKmers += nb;
+                    if (nb + _kmerSize - 1 > _maxSize)  {  _maxSize = nb + _kmerSize - 1;  }
+                }
+            }
+
+            delete section;
+
+            if (info.nbBlocks == 0)  { continue; }
+
+            if (info.max == 1 && _kmerSize > _maxSize)  {  _maxSize = _kmerSize;  }
+            if (info.dataSize > _dataSize)  {  _dataSize = info.dataSize;  }
+
+            _nbBlocks += info.nbBlocks;
+            _nbKmers  += info.nbKmers;
+            _sections.push_back (info);
+        }
+    }
+    catch (Exception& e)                {  throw Exception ("Unable to read KFF file '%s' (%s)", _filename.c_str(), e.getMessage());  }
+    catch (const char* msg)             {  throw Exception ("Unable to read KFF file '%s' (%s)", _filename.c_str(), msg);  }
+    catch (std::exception& e)           {  throw Exception ("Unable to read KFF file '%s' (%s)", _filename.c_str(), e.what());  }
+
+    DEBUG (("BankKff::loadIndex  sections=%ld  blocks=%lld  kmers=%lld \n", _sections.size(), _nbBlocks, _nbKmers));
+
+    _isIndexed = true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int64_t BankKff::getSize ()
+{
+    return System::file().getSize (_filename);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the information is exact since the whole file is scanned.
+*********************************************************************/
+void BankKff::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize)
+{
+    loadIndex ();
+
+    number    = _nbBlocks;
+    totalSize = _nbKmers + _nbBlocks * (_kmerSize - 1);
+    maxSize   = _maxSize;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankKff::remove ()
+{
+    System::file().remove (_filename);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool BankKff::check (const std::string& uri)
+{
+    bool result = false;
+
+    FILE* file = fopen (uri.c_str(), "rb");
+    if (file != NULL)
+    {
+        char signature[3];
+        result = fread (signature, sizeof(signature), 1, file) == 1  &&  memcmp (signature, "KFF", 3) == 0;
+        fclose (file);
+    }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankKff::Iterator::Iterator (BankKff& ref, size_t* nextSection)
+    : _ref(ref), _nextSection(nextSection), _isDone(true), _asciiData(0),
+      _file(0), _section(0), _sectionIdx(0), _nbKmers(0), _dataSize(0), _index(0)
+{
+    setAsciiData (new Data (Data::ASCII));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankKff::Iterator::~Iterator ()
+{
+    delete _section;
+    delete _file;
+
+    setAsciiData (0);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankKff::Iterator::first()
+{
+    _ref.loadIndex ();
+
+    if (_file == 0)
+    {
+        /** We open the file at first call; each iterator has its own file handle. */
+        try                         {  _file = new Kff_file (_ref._filename, "r");  }
+        catch (std::exception& e)   {  throw Exception (STR_BANK_unable_open_file, _ref._filename.c_str());  }
+        catch (const char* msg)     {  throw Exception (STR_BANK_unable_open_file, _ref._filename.c_str());  }
+
+        /** The sections are reached from their offsets, so the header is not read anymore. */
+        _file->header_over = true;
+    }
+
+    /** We reinitialize some attributes. */
+    delete _section;
+    _section    = 0;
+    _sectionIdx = 0;
+    _index      = 0;
+    _isDone     = false;
+
+    /** We go to the first sequence. */
+    next();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool BankKff::Iterator::readSection ()
+{
+    delete _section;
+    _section = 0;
+
+    size_t s = _nextSection != 0 ? __sync_fetch_and_add (_nextSection, 1) : _sectionIdx++;
+
+    if (s >= _ref._sections.size())  { return false; }
+
+    const SectionInfo& info = _ref._sections[s];
+
+    /** The global variables of the section are known from the index, so we don't have to read
+     * the variables sections before it. */
+    setVariables (*_file, _ref._kmerSize, info.m, info.max, info.dataSize, info.isMinimizer);
+
+    _file->jump_to (info.offset);
+
+    _section  = Block_section_reader::construct_section (_file);
+    _dataSize = info.dataSize;
+
+    _seq.resize  ((info.max + _ref._kmerSize - 1 + 3) / 4);
+    _data.resize (info.max * info.dataSize + 1);
+
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankKff::Iterator::next ()
+{
+    /** We may have to open the next section. */
+    while (_section == 0 || _section->remaining_blocks == 0)
+    {
+        if (readSection() == false)  {  _isDone = true;  return;  }
+    }
+
+    _nbKmers = _section->read_compacted_sequence (_seq.data(), _data.data());
+
+    /** We decode the nucleotides; they are aligned on the right of the bytes of the block. */
+    char table[4];
+    table[_ref._encoding[0]] = 'A';
+    table[_ref._encoding[1]] = 'C';
+    table[_ref._encoding[2]] = 'G';
+    table[_ref._encoding[3]] = 'T';
+
+    size_t len     = _nbKmers + _ref._kmerSize - 1;
+    size_t padding = 4 * ((len + 3) / 4) - len;
+
+    _asciiData->resize (len);
+    char* ascii = _asciiData->getBuffer();
+
+    for (size_t i=0, p=padding; i<len; i++, p++)  {  ascii[i] = table[(_seq[p>>2] >> ((3-(p&3))*2)) & 3];  }
+
+    _item->setDataRef (_asciiData, 0, len);
+    _item->setIndex (_index++);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int64_t BankKff::Iterator::getKmerData (size_t idx) const
+{
+    u_int64_t result = 0;
+
+    const u_int8_t* data = _data.data() + idx * _dataSize;
+    for (size_t i=0; i<_dataSize; i++)  {  result = (result << 8) | data[i];  }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankKff::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize)
+{
+    _ref.estimate (number, totalSize, maxSize);
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
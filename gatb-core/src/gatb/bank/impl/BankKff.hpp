@@ -0,0 +1,303 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file BankKff.hpp
+ *  \brief Read only bank for k-mer sets in the KFF format
+ */
+
+#ifndef _GATB_CORE_BANK__IMPL_BANK_KFF_HPP_
+#define _GATB_CORE_BANK__IMPL_BANK_KFF_HPP_
+
+/********************************************************************************/
+
+#include <gatb/bank/impl/AbstractBank.hpp>
+#include <gatb/tools/designpattern/api/ICommand.hpp>
+#include <gatb/system/api/IThread.hpp>
+
+#include <vector>
+#include <string>
+
+/** Classes of the KFF library (see thirdparty/kff-cpp-api). */
+class Kff_file;
+class Block_section_reader;
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace bank      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Implementation of IBank for k-mer sets in the KFF format
+ *
+ * A KFF file (https://github.com/Kmer-File-Format/kff-reference) holds a set of k-mers with
+ * their data (typically their counts), grouped in blocks of consecutive k-mers; the blocks are
+ * stored in raw ('r') sections or in minimizer ('m') sections.
+ *
+ * Each block is provided as one sequence (ASCII encoding) holding its consecutive k-mers. The
+ * data of these k-mers (big endian integers, see getDataSize) can be retrieved from the iterator
+ * with Iterator::getKmerData; so a KFF file written by CountProcessorDumpKff can be used as the
+ * solid k-mers of a graph, without counting the k-mers again (see KffCountAlgorithm).
+ *
+ * The sections of the file are listed at the first access, so the information given by
+ * 'estimate' is exact, and a bank can be read by several threads, each thread decoding the
+ * sections it takes from a shared counter (see the 'iterate' method).
+ *
+ * All the blocks of the file must have the same k-mer size; the bank can't be written.
+ */
+class BankKff : public AbstractBank
+{
+public:
+
+    /** Returns the name of the bank format. */
+    static const char* name()  { return "kff"; }
+
+    /** Constructor.
+     * \param[in] filename : uri of the bank. */
+    BankKff (const std::string& filename);
+
+    /** Destructor. */
+    ~BankKff ();
+
+    /** \copydoc IBank::getId. */
+    std::string getId ()  { return _filename; }
+
+    /** \copydoc IBank::iterator */
+    tools::dp::Iterator<Sequence>* iterator ()  { return new Iterator (*this); }
+
+    /** \copydoc IBank::getNbItems */
+    int64_t getNbItems ()  { loadIndex();  return _nbBlocks; }
+
+    /** \copydoc IBank::insert */
+    void insert (const Sequence& item);
+
+    /** \copydoc IBank::flush */
+    void flush ()  {}
+
+    /** \copydoc IBank::getSize */
+    u_int64_t getSize ();
+
+    /** \copydoc IBank::estimate */
+    void estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize);
+
+    /** \copydoc IBank::remove. */
+    void remove ();
+
+    /** Get the size of the k-mers of the file.
+     * \return the kmer size. */
+    size_t getKmerSize ()  { loadIndex();  return _kmerSize; }
+
+    /** Get the number of k-mers of the file.
+     * \return the number of kmers. */
+    u_int64_t getNbKmers ()  { loadIndex();  return _nbKmers; }
+
+    /** Get the number of bytes of the data of each k-mer (0 if the file has no data).
+     * \return the data size. */
+    size_t getDataSize ()  { loadIndex();  return _dataSize; }
+
+    /** Check that the given uri is a KFF file. */
+    static bool check (const std::string& uri);
+
+    /** Iterate the sequences of the bank with several threads, each thread decoding the sections
+     * it takes from a shared counter. The provided functor is cloned once per thread (as in
+     * IDispatcher::iterate); the clones are deleted by the calling thread after the iteration.
+     * \param[in] dispatcher : dispatcher providing the threads
+     * \param[in] functor : functor to be called on each sequence */
+    template <typename Functor>
+    void iterate (tools::dp::IDispatcher* dispatcher, const Functor& functor)
+    {
+        iterateBlocks (dispatcher, SequenceFunctor<Functor> (functor));
+    }
+
+    /** Same as 'iterate', but the functor is called with the iterator itself, so it can get
+     * the data of the k-mers of the current sequence.
+     * \param[in] dispatcher : dispatcher providing the threads
+     * \param[in] functor : functor to be called on the iterator, for each sequence */
+    template <typename Functor>
+    void iterateBlocks (tools::dp::IDispatcher* dispatcher, const Functor& functor)
+    {
+        loadIndex ();
+
+        size_t nextSection = 0;
+
+        std::vector<Functor*>               functors;
+        std::vector<tools::dp::ICommand*>   commands;
+        for (size_t i=0; i<dispatcher->getExecutionUnitsNumber(); i++)
+        {
+            functors.push_back (new Functor (functor));
+            commands.push_back (new IterateCommand<Functor> (*this, &nextSection, *functors.back()));
+        }
+
+        dispatcher->dispatchCommands (commands, 0);
+
+        for (size_t i=0; i<functors.size(); i++)  {  delete functors[i];  }
+    }
+
+    /************************************************************/
+    /** \brief Specific Iterator impl for BankKff class
+     *
+     * The iterator reads the sections in the file order, unless it is given a counter shared with
+     * other iterators: in such a case, it reads the sections it takes from this counter.
+     */
+    class Iterator : public tools::dp::Iterator<Sequence>
+    {
+    public:
+        /** Constructor.
+         * \param[in] ref : the associated iterable instance.
+         * \param[in] nextSection : counter of sections shared with other iterators (0 if none).
+         */
+        Iterator (BankKff& ref, size_t* nextSection=0);
+
+        /** Destructor */
+        virtual ~Iterator ();
+
+        /** \copydoc tools::dp::Iterator::first */
+        void first();
+
+        /** \copydoc tools::dp::Iterator::next */
+        void next();
+
+        /** \copydoc tools::dp::Iterator::isDone */
+        bool isDone ()  { return _isDone; }
+
+        /** \copydoc tools::dp::Iterator::item */
+        Sequence& item ()  { return *_item; }
+
+        /** Estimation of the sequences information. */
+        void estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize);
+
+        /** Get the number of k-mers of the current sequence. */
+        u_int64_t getNbKmers () const  { return _nbKmers; }
+
+        /** Get the data of a k-mer of the current sequence (0 if the file has no data).
+         * \param[in] idx : index of the kmer in the current sequence.
+         * \return the data, as a big endian integer. */
+        u_int64_t getKmerData (size_t idx) const;
+
+    private:
+
+        /** Reference to the underlying Iterable instance. */
+        BankKff&    _ref;
+
+        /** Shared counter of sections (0 for a sequential iteration). */
+        size_t*     _nextSection;
+
+        /** Tells whether the iteration is finished or not. */
+        bool        _isDone;
+
+        /** Decoded sequence. */
+        tools::misc::Data* _asciiData;
+        void setAsciiData (tools::misc::Data* asciiData)  { SP_SETATTR(asciiData); }
+
+        ::Kff_file*             _file;
+        ::Block_section_reader* _section;
+        size_t                  _sectionIdx;
+        u_int64_t               _nbKmers;
+        size_t                  _dataSize;
+        std::vector<u_int8_t>   _seq;
+        std::vector<u_int8_t>   _data;
+        size_t                  _index;
+
+        /** Open the next section to be iterated; returns false if there is none. */
+        bool readSection ();
+    };
+
+protected:
+
+    /** Location and variables of a blocks section in the file. */
+    struct SectionInfo
+    {
+        u_int64_t offset;
+        u_int64_t m;
+        u_int64_t max;
+        u_int64_t dataSize;
+        u_int64_t nbBlocks;
+        u_int64_t nbKmers;
+        bool      isMinimizer;
+    };
+
+    /** URI of the bank. */
+    std::string _filename;
+
+    /** Sections and counts, read from the file. */
+    std::vector<SectionInfo> _sections;
+    u_int8_t                 _encoding[4];
+    size_t                   _kmerSize;
+    size_t                   _dataSize;
+    u_int64_t                _nbBlocks;
+    u_int64_t                _nbKmers;
+    u_int64_t                _maxSize;
+    bool                     _isIndexed;
+
+    system::ISynchronizer* _synchro;
+
+    /** List the sections of the file, if not already done. */
+    void loadIndex ();
+
+    /** Adaptor of a functor on sequences, for the 'iterate' method. */
+    template <typename Functor>
+    struct SequenceFunctor
+    {
+        SequenceFunctor (const Functor& functor) : _functor(functor)  {}
+        void operator() (Iterator& it)  {  _functor (it.item());  }
+        Functor _functor;
+    };
+
+    /** Command reading sections for the 'iterateBlocks' method. */
+    template <typename Functor>
+    class IterateCommand : public tools::dp::ICommand, public system::SmartPointer
+    {
+    public:
+        IterateCommand (BankKff& ref, size_t* nextSection, Functor& functor)
+            : _ref(ref), _nextSection(nextSection), _functor(functor)  {}
+
+        void execute ()
+        {
+            Iterator it (_ref, _nextSection);
+            for (it.first(); !it.isDone(); it.next())  {  _functor (it);  }
+        }
+
+    private:
+        BankKff&  _ref;
+        size_t*   _nextSection;
+        Functor&  _functor;
+    };
+
+    friend class Iterator;
+};
+
+/********************************************************************************/
+
+/* \brief Factory for the BankKff class. */
+class BankKffFactory : public IBankFactory
+{
+public:
+
+    /** \copydoc IBankFactory::createBank */
+    IBank* createBank (const std::string& uri)
+    {
+        return BankKff::check(uri) ? new BankKff (uri) : 0;
+    }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_BANK__IMPL_BANK_KFF_HPP_ */
@@ -22,7 +22,6 @@
 
 #include <gatb/system/impl/System.hpp>
 
-#include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
 
 using namespace std;
@@ -44,8 +43,8 @@ namespace gatb {  namespace core {  namespace bank {  namespace impl {
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-BankRandom::BankRandom (size_t nbSequences, size_t length)
-    : _nbSequences(nbSequences), _length(length)
+BankRandom::BankRandom (size_t nbSequences, size_t length, u_int64_t seed)
+    : _nbSequences(nbSequences), _length(length), _seed(seed)
 {
 }
 
@@ -88,7 +87,8 @@ BankRandom::Iterator::Iterator(const BankRandom& bank)
 
     _item->getData().setRef (_dataRef, 0, bank._length);
 
-    srand (time(NULL));
+    /** Each iterator has its own generator, so two iterators of a seeded bank give the same sequences. */
+    _random.seed (bank._seed != 0 ? bank._seed : time(NULL));
 }
 
 /*********************************************************************
@@ -137,7 +137,7 @@ void BankRandom::Iterator::next()
 
         for (size_t i=0; i<_item->getDataSize(); i++)
         {
-            buffer [i] = table[rand() % sizeof(table)/sizeof(table[0])];
+            buffer [i] = table[_random() % (sizeof(table)/sizeof(table[0]))];
         }
     }
 }
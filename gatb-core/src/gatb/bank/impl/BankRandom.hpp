@@ -32,6 +32,7 @@
 
 #include <vector>
 #include <string>
+#include <random>
 
 /********************************************************************************/
 namespace gatb      {
@@ -43,6 +44,9 @@ namespace impl      {
 /** \brief Implementation of IBank for random banks
  *
  * This class generates random genomic data and can be used for test purpose.
+ *
+ * With a non null seed, each iterator generates the same sequences, so the bank can be used for
+ * reproducible datasets (benchmarks for instance); otherwise the sequences depend on the time.
  */
 class BankRandom : public AbstractBank
 {
@@ -53,8 +57,9 @@ public:
 
     /** Constructor.
      * \param[in] nbSequences : number of sequences of the random bank
-     * \param[in] length : length of a sequence. */
-    BankRandom (size_t nbSequences, size_t length);
+     * \param[in] length : length of a sequence.
+     * \param[in] seed : seed of the random generator (0 for a seed given by the time). */
+    BankRandom (size_t nbSequences, size_t length, u_int64_t seed=0);
 
     /** Destructor. */
     ~BankRandom ();
@@ -112,6 +117,8 @@ public:
         int64_t   _rank;
         bool      _isDone;
 
+        std::mt19937_64 _random;
+
         tools::misc::Data* _dataRef;
         void setDataRef (tools::misc::Data* dataRef)  { SP_SETATTR(dataRef); }
     };
@@ -120,6 +127,7 @@ protected:
 
     size_t _nbSequences;
     size_t _length;
+    u_int64_t _seed;
 
     friend class Iterator;
 };
@@ -27,6 +27,8 @@
 
 #include <gatb/bank/impl/BankFasta.hpp>
 #include <gatb/bank/impl/BankBinary.hpp>
+#include <gatb/bank/impl/BankBinaryIndexed.hpp>
+#include <gatb/bank/impl/BankKff.hpp>
 #include <gatb/bank/impl/BankStrings.hpp>
 #include <gatb/bank/impl/BankSplitter.hpp>
 #include <gatb/bank/impl/BankRandom.hpp>
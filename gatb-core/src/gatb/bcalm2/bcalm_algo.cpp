@@ -37,6 +37,7 @@
 
 #include <gatb/kmer/impl/PartiInfo.hpp>   // for repartitor 
 #include <gatb/tools/misc/impl/Progress.hpp>
+#include <gatb/tools/misc/impl/ProgressJson.hpp>
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 
 #define get_wtime() chrono::system_clock::now()
@@ -383,6 +384,7 @@ void bcalm2(Storage *storage,
         listener = new ProgressTimer(nb_partitions, "Iterating DSK partitions");
     else
         listener = new IteratorListener ();
+    listener = ProgressJson::wrap (listener, nb_partitions, "Iterating DSK partitions");
 
     auto it_parts = new tools::dp::impl::SubjectIterator<int> (
                 new Range<int>::Iterator (0,nb_partitions-1), 
@@ -32,6 +32,7 @@
 #include <gatb/tools/misc/impl/HostInfo.hpp>
 #include <gatb/tools/misc/impl/Stringify.hpp>
 #include <gatb/tools/misc/impl/Tool.hpp>
+#include <gatb/tools/misc/impl/ProgressJson.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 #include <gatb/tools/designpattern/impl/Command.hpp>
@@ -42,6 +43,7 @@
 
 #include <gatb/kmer/impl/ConfigurationAlgorithm.hpp>
 #include <gatb/kmer/impl/SortingCountAlgorithm.hpp>
+#include <gatb/kmer/impl/KffCountAlgorithm.hpp>
 #include <gatb/kmer/impl/BloomAlgorithm.hpp>
 #include <gatb/kmer/impl/DebloomAlgorithmFactory.hpp>
 #include <gatb/kmer/impl/BloomBuilder.hpp>
@@ -231,6 +233,13 @@ void configure_visitor<Node,Edge,GraphDataVariant>::operator() (GraphData<span>&
         data.setAbundance (mphf_algo.getAbundanceMap());
         data.setNodeState (mphf_algo.getNodeStateMap());
         data.setAdjacency (mphf_algo.getAdjacencyMap());
+
+        /** The adjacency may have been precomputed and saved next to the MPHF (see option -precompute-adjacency). */
+        if ((graph.getState() & GraphTemplate<Node, Edge, GraphDataVariant>::STATE_ADJACENCY_DONE) && dskGroup.getProperty ("adjacency").empty() == false)
+        {
+            data._adjacency->useHashFrom (data._abundance);
+            data._adjacency->loadData (dskGroup, "adjacency");
+        }
     }
 }
 
@@ -395,16 +404,26 @@ void build_visitor_solid<Node,Edge,GraphDataVariant>::operator() (GraphData<span
     /************************************************************/
     DEBUG ((cout << "build_visitor : SortingCountAlgorithm BEGIN\n"));
 
-    /** We create a DSK instance and execute it. */
-    SortingCountAlgorithm<span> sortingCount (
-            bank,
-            config,
-            new Repartitor(minimizersGroup),
-            SortingCountAlgorithm<span>::getDefaultProcessorVector (config, props, solidStorage, mainStorage),
-            props
-            );
+    if (BankKff* bankKff = dynamic_cast<BankKff*> (bank))
+    {
+        /** The kmers have already been counted: we only have to dispatch them into the partitions. */
+        KffCountAlgorithm<span> kffCount (bankKff, dskGroup, minimizersGroup, config, props);
+
+        graph.executeAlgorithm (kffCount, solidStorage, props, graph._info);
+    }
+    else
+    {
+        /** We create a DSK instance and execute it. */
+        SortingCountAlgorithm<span> sortingCount (
+                bank,
+                config,
+                new Repartitor(minimizersGroup),
+                SortingCountAlgorithm<span>::getDefaultProcessorVector (config, props, solidStorage, mainStorage),
+                props
+                );
 
-    graph.executeAlgorithm (sortingCount, solidStorage, props, graph._info);
+        graph.executeAlgorithm (sortingCount, solidStorage, props, graph._info);
+    }
     graph.setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_SORTING_COUNT_DONE);
 
     Partition<Count>* solidCounts = & dskGroup.getPartition<Count> ("solid");
@@ -591,6 +610,27 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
 
     }
 
+    /************************************************************/
+    /*                         Adjacency                        */
+    /************************************************************/
+    bool precomputeAdjacency = props->get("-precompute-adjacency") != 0;
+    if (precomputeAdjacency && graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE) && !(graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_ADJACENCY_DONE)))
+    {
+        DEBUG ((cout << "build_visitor : adjacency BEGIN\n"));
+
+        graph.precomputeAdjacency (
+            props->get(STR_NB_CORES)   ? props->getInt(STR_NB_CORES) : 0,
+            props->get(STR_VERBOSE)    ? props->getInt(STR_VERBOSE) > 0 : false,
+            props->get(STR_MAX_MEMORY) ? props->getInt(STR_MAX_MEMORY) : 0
+        );
+
+        /** We save the adjacency next to the MPHF, so that loading the graph won't need to compute it again. */
+        size_t adjacencySize = data._adjacency->saveData (dskGroup, "adjacency");
+        dskGroup.setProperty ("adjacency", Stringify::format("%ld", adjacencySize));
+
+        DEBUG ((cout << "build_visitor : adjacency END\n"));
+    }
+
 
     /************************************************************/
     /*                    Post processing                       */
@@ -652,6 +692,7 @@ IOptionsParser* GraphTemplate<Node, Edge, GraphDataVariant>::getOptionsParser (b
     parser->push_back (DebloomAlgorithm<>::getOptionsParser());
     parser->push_back (BranchingAlgorithm<>::getOptionsParser());
     parser->push_front (new OptionNoParam  ("-no-mphf",       "don't construct the MPHF"));
+    parser->push_front (new OptionNoParam  ("-precompute-adjacency", "precompute the nodes adjacency (needs the MPHF) and save it with the graph"));
 
     /** We create a "general options" parser. */
     IOptionsParser* parserGeneral  = new OptionsParser ("general");
@@ -659,6 +700,10 @@ IOptionsParser* GraphTemplate<Node, Edge, GraphDataVariant>::getOptionsParser (b
     parserGeneral->push_front (new OptionOneParam (STR_VERBOSE,           "verbosity level",      false, "1"  ));
     parserGeneral->push_front (new OptionOneParam (STR_EDGE_KM_REPRESENTATION,           "edge km representation",      false, "0"  ));
     parserGeneral->push_front (new OptionNoParam (STR_ALL_ABUNDANCE_COUNTS,           "output all k-mer abundance counts instead of mean" ));
+    parserGeneral->push_front (new OptionOneParam (STR_PROGRESS_PERIOD,   "seconds between two JSON progress snapshots", false, "1"));
+    parserGeneral->push_front (new OptionOneParam (STR_PROGRESS_JSON,     "write progress snapshots as JSON lines into a file (or 'unix:<path>' socket)", false));
+    parserGeneral->push_front (new OptionNoParam  (STR_COUNTERS,          "gather hardware and system counters of each step"));
+    parserGeneral->push_front (new OptionNoParam  (STR_BIND_CORES,        "bind each thread to one core"));
     parserGeneral->push_front (new OptionOneParam (STR_NB_CORES,          "number of cores",      false, "0"  ));
     parserGeneral->push_front (new OptionNoParam  (STR_CONFIG_ONLY,       "dump config only"));
     
@@ -781,6 +826,9 @@ GraphTemplate<Node, Edge, GraphDataVariant_t>::GraphTemplate (const std::string&
       _name(System::file().getBaseName(uri))
 
 {
+    /** A memory mapped graph is recognized from its extension. */
+    if (System::file().getExtension(uri) == "gmap")  { _storageMode = STORAGE_MMAP; }
+
     /** We create a storage instance. */
     /* (this is actually loading, not creating, the storage at "uri") */
     setStorage (StorageFactory(_storageMode).create (uri, false, false));
@@ -821,6 +869,15 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (bank::IBank* bank, t
 
     size_t integerPrecision = params->getInt (STR_INTEGER_PRECISION);
 
+    /** We may bind the threads to cores. */
+    if (params->get(STR_BIND_CORES) != 0)  { Dispatcher::setThreadsBinding (true); }
+
+    /** We may gather counters (instructions, cache misses, I/O...) for each step. */
+    if (params->get(STR_COUNTERS) != 0)  { TimeInfo::setCounters (true); }
+
+    /** We may write the progress for monitoring tools, with the graph information as final report. */
+    ProgressJsonSink::Scope progressJson (params, &_info);
+
     /** We get other user parameters. */
     parse (params->getStr(STR_BLOOM_TYPE),        _bloomKind);
     parse (params->getStr(STR_DEBLOOM_TYPE),      _debloomKind);
@@ -830,6 +887,9 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (bank::IBank* bank, t
     /** We configure the data variant according to the provided kmer size. */
     setVariant (_variant, _kmerSize, integerPrecision);
 
+    /** The graph may be saved in a memory mapped file instead of the default storage. */
+    if (params->get(STR_STORAGE_TYPE) && params->getStr(STR_STORAGE_TYPE) == "mmap")  { _storageMode = STORAGE_MMAP; }
+
     /** We build the graph according to the wanted precision. */
     boost::apply_visitor (build_visitor_solid<Node, Edge, GraphDataVariant>(*this, bank,params),  *(GraphDataVariant*)_variant);
     boost::apply_visitor (build_visitor_postsolid<Node, Edge, GraphDataVariant>(*this, params),  *(GraphDataVariant*)_variant);
@@ -855,6 +915,15 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (tools::misc::IProper
 
     size_t integerPrecision = params->getInt (STR_INTEGER_PRECISION);
 
+    /** We may bind the threads to cores. */
+    if (params->get(STR_BIND_CORES) != 0)  { Dispatcher::setThreadsBinding (true); }
+
+    /** We may gather counters (instructions, cache misses, I/O...) for each step. */
+    if (params->get(STR_COUNTERS) != 0)  { TimeInfo::setCounters (true); }
+
+    /** We may write the progress for monitoring tools, with the graph information as final report. */
+    ProgressJsonSink::Scope progressJson (params, &_info);
+
     /** We get other user parameters. */
     parse (params->getStr(STR_BLOOM_TYPE),        _bloomKind);
     parse (params->getStr(STR_DEBLOOM_TYPE),      _debloomKind);
@@ -868,7 +937,8 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (tools::misc::IProper
 
     bool load_from_hdf5 = (system::impl::System::file().getExtension(input) == "h5");
     bool load_from_file = (system::impl::System::file().isFolderEndingWith(input,"_gatb"));
-    bool load_graph = (load_from_hdf5 || load_from_file);
+    bool load_from_mmap = (system::impl::System::file().getExtension(input) == "gmap");
+    bool load_graph = (load_from_hdf5 || load_from_file || load_from_mmap);
     if (load_graph)
     {
         /* it's not a bank, but rather a h5 file (kmercounted or more), let's complete it to a graph */
@@ -877,7 +947,7 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (tools::misc::IProper
         
         /** We create a storage instance. */
         /* (this is actually loading, not creating, the storage at "uri") */
-        _storageMode = load_from_hdf5 ? STORAGE_HDF5 : STORAGE_FILE;
+        _storageMode = load_from_hdf5 ? STORAGE_HDF5 : (load_from_mmap ? STORAGE_MMAP : STORAGE_FILE);
         bool append = true; // special storagehdf5 which will open the hdf5 file as read&write
         setStorage (StorageFactory(_storageMode).create (input, false, false, false, append));
     
@@ -912,6 +982,9 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (tools::misc::IProper
     }
     else
     {
+        /** The graph may be saved in a memory mapped file instead of the default storage. */
+        if (params->get(STR_STORAGE_TYPE) && params->getStr(STR_STORAGE_TYPE) == "mmap")  { _storageMode = STORAGE_MMAP; }
+
         /** We build a Bank instance for the provided reads uri. */
         bank::IBank* bank = Bank::open (params->getStr(STR_URI_INPUT));
 
@@ -3500,15 +3573,199 @@ struct allocateAdjacency_visitor : public boost::static_visitor<void>    {
 };
 
 
+/* a (k-1)-mer overlap of a solid kmer (its prefix or its suffix) in canonical form, used to join
+ * the kmers sharing this overlap. 'info' holds, from high to low bits: the MPHF index of the kmer,
+ * 1 bit set for a suffix, 1 bit set if the overlap is read as its canonical form, 2 bits for the
+ * flanking nucleotide of the kmer (the one not in the overlap).
+ */
+template<typename Type>
+struct AdjacencyRecord
+{
+    Type      key;
+    u_int64_t info;
+
+    bool operator< (const AdjacencyRecord& other) const  { return key < other.key; }
+};
+
+/* build the adjacency map from the solid kmers, without querying the bloom filter.
+ *
+ * Two kmers x and y are adjacent (x->y) if the suffix of x is the prefix of y, y being read on
+ * either strand. So the prefix and the suffix of each solid kmer are emitted in canonical form and
+ * sorted, and the kmers sharing an overlap are joined. Each edge between two nodes is found in the
+ * overlaps of both nodes, so only the bits of the forward strand of each node are set.
+ *
+ * The overlaps are dispatched by hash into buckets (sorted and joined in parallel) and, in order to
+ * bound the memory, into passes (each one reading the solid kmers again). Note that the solid kmers
+ * partitions can't be joined independently: two adjacent kmers may have different minimizers.
+ *
+ * Returns false if the solid kmers are not available.
+ */
+template<typename Node, typename Edge, typename GraphDataVariant> 
+struct buildAdjacency_visitor : public boost::static_visitor<bool>    {
+
+    size_t nbCores;  size_t maxMemory;  bool verbose;
+
+    buildAdjacency_visitor (size_t nbCores, size_t maxMemory, bool verbose) : nbCores(nbCores), maxMemory(maxMemory), verbose(verbose) {}
+
+    template<size_t span> bool operator() (const GraphData<span>& data) const
+    {
+        typedef typename Kmer<span>::Type   Type;
+        typedef typename Kmer<span>::Count  Count;
+        typedef AdjacencyRecord<Type>       Record;
+        typedef typename GraphData<span>::AdjacencyMap AdjacencyMap;
+
+        if (data._solid == 0)  { return false; }
+
+        Partition<Count>& solid    = *data._solid;
+        AdjacencyMap&     adjacency = *data._adjacency;
+        size_t            kmerSize  = data._model->getKmerSize();
+
+        Dispatcher dispatcher (nbCores);
+
+        size_t nbBuckets = std::max ((size_t)1, dispatcher.getExecutionUnitsNumber());
+        size_t nbPasses  = maxMemory > 0 ? 1 + (2 * solid.getNbItems() * sizeof(Record)) / (maxMemory*MBYTE) : 1;
+
+        Type one;   one.setVal (1);
+        Type mask = (one << (2*(kmerSize-1))) - one;
+
+        IteratorListener* progress = verbose ?
+            (IteratorListener*) new ProgressSynchro (new ProgressTimerAndSystem (nbPasses * solid.size(), "precomputing adjacency"), System::thread().newSynchronizer()) :
+            (IteratorListener*) new ProgressNone ();
+        LOCAL (progress);
+        progress->init ();
+
+        /* emits the overlaps of the current pass, for some partitions of the solid kmers */
+        struct EmitCmd : public ICommand, public system::SmartPointer
+        {
+            Partition<Count>& solid;  AdjacencyMap& adjacency;  IteratorListener* progress;
+            size_t kmerSize;  Type mask;  size_t first;  size_t step;  size_t pass;  size_t nbPasses;
+            std::vector<std::vector<Record> > buckets;
+
+            EmitCmd (Partition<Count>& solid, AdjacencyMap& adjacency, IteratorListener* progress, size_t kmerSize, const Type& mask,
+                     size_t first, size_t step, size_t pass, size_t nbPasses, size_t nbBuckets)
+                : solid(solid), adjacency(adjacency), progress(progress), kmerSize(kmerSize), mask(mask),
+                  first(first), step(step), pass(pass), nbPasses(nbPasses), buckets(nbBuckets) {}
+
+            void emit (const Type& overlap, u_int64_t info)
+            {
+                Type      rev       = revcomp (overlap, kmerSize-1);
+                bool      canonical = overlap <= rev;
+                const Type& key     = canonical ? overlap : rev;
+                u_int64_t h         = hash1 (key, 0);
+
+                if (h % nbPasses != pass)  { return; }
+
+                Record record;
+                record.key  = key;
+                record.info = info | ((u_int64_t)canonical << 2);
+                buckets[(h / nbPasses) % buckets.size()].push_back (record);
+            }
+
+            void execute ()
+            {
+                for (size_t p=first; p<solid.size(); p+=step)
+                {
+                    Iterator<Count>* it = solid[p].iterator();  LOCAL (it);
+                    for (it->first(); !it->isDone(); it->next())
+                    {
+                        const Type& kmer  = it->item().value;
+                        u_int64_t   index = adjacency.getCode (kmer);
+
+                        emit (kmer >> 2,    (index << 4) |            (kmer                     & 3).getVal());
+                        emit (kmer  & mask, (index << 4) | (1 << 3) | ((kmer >> (2*(kmerSize-1))) & 3).getVal());
+                    }
+                    progress->inc (1);
+                }
+            }
+        };
+
+        /* sorts one bucket of the current pass and joins the kmers sharing an overlap */
+        struct JoinCmd : public ICommand, public system::SmartPointer
+        {
+            std::vector<ICommand*>& emitCmds;  AdjacencyMap& adjacency;  size_t kmerSize;  size_t bucket;
+
+            JoinCmd (std::vector<ICommand*>& emitCmds, AdjacencyMap& adjacency, size_t kmerSize, size_t bucket)
+                : emitCmds(emitCmds), adjacency(adjacency), kmerSize(kmerSize), bucket(bucket) {}
+
+            void execute ()
+            {
+                std::vector<Record> records;
+                for (size_t i=0; i<emitCmds.size(); i++)
+                {
+                    std::vector<Record>& current = ((EmitCmd*)emitCmds[i])->buckets[bucket];
+                    records.insert (records.end(), current.begin(), current.end());
+                    std::vector<Record>().swap (current);
+                }
+
+                std::sort (records.begin(), records.end());
+
+                for (size_t begin=0, end=0; begin<records.size(); begin=end)
+                {
+                    /* nucleotides flanking the overlap, indexed by [suffix][canonical], as read from the kmer
+                     * or from its reverse complement (nucleotides are coded A=0 C=1 T=2 G=3, so complement is ^2) */
+                    u_int8_t flank[2][2] = { {0,0}, {0,0} };
+                    u_int8_t flankRev[2][2] = { {0,0}, {0,0} };
+
+                    for (end=begin; end<records.size() && records[end].key == records[begin].key; end++)
+                    {
+                        u_int64_t info = records[end].info;
+                        flank    [(info>>3)&1] [(info>>2)&1] |= 1 << ( info    & 3);
+                        flankRev [(info>>3)&1] [(info>>2)&1] |= 1 << ((info^2) & 3);
+                    }
+
+                    /* a palindromic overlap is read as its canonical form on both strands */
+                    bool palindrome = records[begin].key == revcomp (records[begin].key, kmerSize-1);
+
+                    for (size_t i=begin; i<end; i++)
+                    {
+                        u_int64_t info   = records[i].info;
+                        size_t    same   = (info>>2) & 1;
+                        size_t    other  = palindrome ? same : 1-same;
+                        u_int8_t  bits;
+
+                        /* a suffix gets successors from the prefixes read on the same strand and from the
+                         * suffixes read on the other strand; conversely for a prefix and its predecessors */
+                        if (info & (1<<3))  {  bits = flank[0][same] | flankRev[1][other];          }
+                        else                {  bits = (flank[1][same] | flankRev[0][other]) << 4;   }
+
+                        __sync_fetch_and_or (&adjacency.at (info >> 4), bits);
+                    }
+                }
+            }
+        };
+
+        for (size_t pass=0; pass<nbPasses; pass++)
+        {
+            std::vector<ICommand*> emitCmds;
+            for (size_t i=0; i<nbBuckets; i++)
+            {
+                ICommand* cmd = new EmitCmd (solid, adjacency, progress, kmerSize, mask, i, nbBuckets, pass, nbPasses, nbBuckets);
+                cmd->use();
+                emitCmds.push_back (cmd);
+            }
+            dispatcher.dispatchCommands (emitCmds, 0);
+
+            std::vector<ICommand*> joinCmds;
+            for (size_t b=0; b<nbBuckets; b++)  {  joinCmds.push_back (new JoinCmd (emitCmds, adjacency, kmerSize, b));  }
+            dispatcher.dispatchCommands (joinCmds, 0);
+
+            for (size_t i=0; i<emitCmds.size(); i++)  {  emitCmds[i]->forget();  }
+        }
+
+        progress->finish ();
+
+        return true;
+    }
+};
+
+
 /* precompute the graph adjacency information using the MPHF
  * this should be much faster than querying the bloom filter
  * also, maybe one day, it will replace it
  */
 template<typename Node, typename Edge, typename GraphDataVariant> 
-void GraphTemplate<Node, Edge, GraphDataVariant>::precomputeAdjacency(unsigned int nbCores, bool verbose) 
+void GraphTemplate<Node, Edge, GraphDataVariant>::precomputeAdjacency(unsigned int nbCores, bool verbose, size_t maxMemory) 
 {
-    ProgressGraphIteratorTemplate<Node, ProgressTimerAndSystem> itNode (iterator(), "precomputing adjacency", verbose);
-    
     bool hasMPHF = getState() & GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE;
     if (!hasMPHF)
     {
@@ -3527,27 +3784,35 @@ void GraphTemplate<Node, Edge, GraphDataVariant>::precomputeAdjacency(unsigned i
     nt2bit[NUCL_T] = 4;
     nt2bit[NUCL_G] = 8;
 
-    dispatcher.iterate (itNode, [&] (Node& node)        {
+    /* the adjacency is derived from the solid kmers when they are available, otherwise the bloom filter is queried */
+    bool fromSolid = boost::apply_visitor (buildAdjacency_visitor<Node, Edge, GraphDataVariant>(nbCores, maxMemory, verbose),  *(GraphDataVariant*)_variant);
 
-            unsigned char &value = boost::apply_visitor (getAdjacency_visitor<Node, Edge, GraphDataVariant>(node),  *(GraphDataVariant*)_variant);
-            value = 0;
+    if (!fromSolid)
+    {
+        ProgressGraphIteratorTemplate<Node, ProgressTimerAndSystem> itNode (iterator(), "precomputing adjacency", verbose);
 
-            // in both directions
-            for (Direction dir=DIR_OUTCOMING; dir<DIR_END; dir = (Direction)((int)dir + 1) )
-            {
-                GraphVector<Edge> neighbors = this->neighborsEdge(node, dir);
-                for (unsigned int i = 0; i < neighbors.size(); i++)
+        dispatcher.iterate (itNode, [&] (Node& node)        {
+
+                unsigned char &value = boost::apply_visitor (getAdjacency_visitor<Node, Edge, GraphDataVariant>(node),  *(GraphDataVariant*)_variant);
+                value = 0;
+
+                // in both directions
+                for (Direction dir=DIR_OUTCOMING; dir<DIR_END; dir = (Direction)((int)dir + 1) )
                 {
-                    u_int8_t bit = nt2bit[neighbors[i].nt];
-                    value |= bit << (dir == DIR_INCOMING ? 4 : 0);
-                    //std::cout << "setting bit " << (int)bit << " shifted " << ((int)bit << (dir == DIR_INCOMING ? 4 : 0)) << " for nt " << (int)(neighbors[i].nt) << std::endl;
-                }
+                    GraphVector<Edge> neighbors = this->neighborsEdge(node, dir);
+                    for (unsigned int i = 0; i < neighbors.size(); i++)
+                    {
+                        u_int8_t bit = nt2bit[neighbors[i].nt];
+                        value |= bit << (dir == DIR_INCOMING ? 4 : 0);
+                        //std::cout << "setting bit " << (int)bit << " shifted " << ((int)bit << (dir == DIR_INCOMING ? 4 : 0)) << " for nt " << (int)(neighbors[i].nt) << std::endl;
+                    }
 
 
-                //std::cout << "node " << this->toString(node) << " has " << neighbors.size() << " neighbors in direction " << (dir == DIR_INCOMING ? "incoming" : "outcoming") << " value is now " << (int)value <<  std::endl;
-            }
-            
-    }); // end of parallel node iterate
+                    //std::cout << "node " << this->toString(node) << " has " << neighbors.size() << " neighbors in direction " << (dir == DIR_INCOMING ? "incoming" : "outcoming") << " value is now " << (int)value <<  std::endl;
+                }
+                
+        }); // end of parallel node iterate
+    }
 
     setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_ADJACENCY_DONE);
     
@@ -971,8 +971,10 @@ public:
     Edge reverse (const Edge& edge) const;
 
 
-    /** cache adjacency information from the Bloom filter to an array, 8 bits per node, for faster traversal queries*/
-    void precomputeAdjacency(unsigned int nbCores = 1, bool verbose = true);
+    /** cache adjacency information to an array, 8 bits per node, for faster traversal queries.
+     * The adjacency is derived from the solid kmers if available (maxMemory MBytes bounds the memory
+     * used for that, 0 for no bound), otherwise from the Bloom filter. */
+    void precomputeAdjacency(unsigned int nbCores = 1, bool verbose = true, size_t maxMemory = 0);
     unsigned int nt2bit[256]; 
     bool debugCompareNeighborhoods(Node& node, Direction dir, std::string prefix) const; // debug
 
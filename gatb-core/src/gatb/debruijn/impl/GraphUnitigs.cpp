@@ -846,6 +846,11 @@ GraphUnitigsTemplate<span>::GraphUnitigsTemplate (tools::misc::IProperties* para
             BaseGraph::_storageMode = tools::storage::impl::STORAGE_FILE; // moving away frmo HDF5 because 1) memory leaks and 2) storing unitigs in a fasta file instead, more clean this way. nothing else needs to be stored
             std::cout << "setting storage type to file" << std::endl;
         }
+        else if (storage_type == "mmap")
+        {
+            BaseGraph::_storageMode = tools::storage::impl::STORAGE_MMAP;
+            std::cout << "setting storage type to mmap" << std::endl;
+        }
         else
         {std::cout << "Error: unknown storage type specified: " << storage_type << std::endl; exit(1); }
     }
@@ -883,7 +888,8 @@ GraphUnitigsTemplate<span>::GraphUnitigsTemplate (tools::misc::IProperties* para
 
     bool load_from_hdf5 = (system::impl::System::file().getExtension(input) == "h5");
     bool load_from_file = (system::impl::System::file().isFolderEndingWith(input,"_gatb"));
-    bool load_graph = (load_from_hdf5 || load_from_file);
+    bool load_from_mmap = (system::impl::System::file().getExtension(input) == "gmap");
+    bool load_graph = (load_from_hdf5 || load_from_file || load_from_mmap);
 
     string unitigs_filename, prefix;
 
@@ -914,7 +920,7 @@ GraphUnitigsTemplate<span>::GraphUnitigsTemplate (tools::misc::IProperties* para
         
         /** We create a storage instance. */
         /* (this is actually loading, not creating, the storage at "uri") */
-        BaseGraph::_storageMode = load_from_hdf5 ? STORAGE_HDF5 : STORAGE_FILE;
+        BaseGraph::_storageMode = load_from_hdf5 ? STORAGE_HDF5 : (load_from_mmap ? STORAGE_MMAP : STORAGE_FILE);
 
         bool append = true; // in principle we wouldn't need to modify the .h5 file when building unitigs, but at some very rare locations in the code, we do (like nb_unitigs)
         BaseGraph::setStorage (StorageFactory(BaseGraph::_storageMode).create (input, false, false, false, append));
@@ -1656,6 +1662,31 @@ unitigSequence (const NodeGU& node, bool& isolatedLeft, bool& isolatedRight) con
 template<size_t span>
 void GraphUnitigsTemplate<span>::
 simplePathLongest_avance(const NodeGU& node, Direction dir, int& seqLength, int& endDegree, bool markDuringTraversal, float& coverage, string* seq, std::vector<NodeGU> *nodesList) 
+{
+    PackedSequence packed;
+
+    simplePathLongest_avance_packed(node, dir, seqLength, endDegree, markDuringTraversal, coverage, seq != nullptr ? &packed : nullptr, nodesList);
+
+    if (seq != nullptr)
+    {
+        if (dir == DIR_OUTCOMING)
+            *seq += packed.toString();
+        else
+        {
+            packed.reverseComplement();
+            *seq = packed.toString() + *seq;
+        }
+    }
+}
+
+/* the traversed unitigs are appended to a 2-bit sequence, without decoding them:
+ * - for DIR_OUTCOMING, the sequence is extended to the right, as in the ASCII version
+ * - for DIR_INCOMING, the ASCII version prepends each unitig; here, the reverse complement of each unitig is appended instead,
+ *   so the sequence is the reverse complement of the traversed sequence
+ */
+template<size_t span>
+void GraphUnitigsTemplate<span>::
+simplePathLongest_avance_packed(const NodeGU& node, Direction dir, int& seqLength, int& endDegree, bool markDuringTraversal, float& coverage, PackedSequence* seq, std::vector<NodeGU> *nodesList) 
 {
     bool debug = false;
     if (debug)
@@ -1673,15 +1704,9 @@ simplePathLongest_avance(const NodeGU& node, Direction dir, int& seqLength, int&
 
         if (seq != nullptr)
         {
-            string new_seq = internal_get_unitig_sequence(node.unitig);
-
-            if (!same_orientation)
-                new_seq = revcomp(new_seq);
-
-            if (dir == DIR_OUTCOMING)
-                *seq += new_seq.substr(kmerSize-1);
-            else
-                *seq = new_seq.substr(0,new_seq.size()-(kmerSize-1)) + *seq;
+            // all the unitig except the overlap part, in the orientation of the traversal (reverse complemented for DIR_INCOMING, see above)
+            bool rc = (dir == DIR_OUTCOMING) != same_orientation;
+            internal_append_unitig_sequence(*seq, node.unitig, rc ? 0 : kmerSize-1, unitigLength-(kmerSize-1), rc);
         }
 
         // length is all the kmers of that unitig, except first one
@@ -1811,14 +1836,8 @@ simplePathLongest_avance(const NodeGU& node, Direction dir, int& seqLength, int&
         // append the sequence (except the overlap part, of length k-1.
         if (seq != nullptr)
         {
-            string new_seq = internal_get_unitig_sequence(cur_node.unitig);
-            if (!same_orientation)
-                new_seq = revcomp(new_seq);
-
-            if (dir == DIR_OUTCOMING)
-                *seq += new_seq.substr(kmerSize-1);
-            else
-                *seq = new_seq.substr(0,new_seq.size()-(kmerSize-1)) + *seq;
+            bool rc = (dir == DIR_OUTCOMING) != same_orientation;
+            internal_append_unitig_sequence(*seq, cur_node.unitig, rc ? 0 : kmerSize-1, unitigLength-(kmerSize-1), rc);
         }
 
         seqLength += unitigLength - (kmerSize-1);
@@ -1836,10 +1855,10 @@ template<size_t span>
 std::string GraphUnitigsTemplate<span>::
 simplePathBothDirections(const NodeGU& node, bool& isolatedLeft, bool& isolatedRight, bool markDuringTraversal, float &coverage) 
 {
-    string seq = internal_get_unitig_sequence(node.unitig);
+    int unitigLength = internal_get_unitig_length(node.unitig);
     
     int kmerSize = BaseGraph::_kmerSize;
-    float midTotalCoverage = unitigMeanAbundance(node) * (seq.size() - kmerSize + 1);
+    float midTotalCoverage = unitigMeanAbundance(node) * (unitigLength - kmerSize + 1);
 
     NodeGU left(node.unitig, UNITIG_BEGIN);
     NodeGU right(node.unitig, UNITIG_END);
@@ -1849,18 +1868,22 @@ simplePathBothDirections(const NodeGU& node, bool& isolatedLeft, bool& isolatedR
     if (markDuringTraversal)
         unitigMark(left);
 
-    string seqRight = "", seqLeft = "";
+    PackedSequence seqRight, seqLeft;
     int endDegreeLeft, endDegreeRight;
     float rightTotalCoverage = 0, leftTotalCoverage = 0;
     int lenSeqRight = 0, lenSeqLeft = 0;
-    simplePathLongest_avance (right, DIR_OUTCOMING, lenSeqRight, endDegreeRight, markDuringTraversal, rightTotalCoverage, &seqRight);
-    simplePathLongest_avance (left, DIR_INCOMING, lenSeqLeft, endDegreeLeft, markDuringTraversal, leftTotalCoverage, &seqLeft);
+    simplePathLongest_avance_packed (right, DIR_OUTCOMING, lenSeqRight, endDegreeRight, markDuringTraversal, rightTotalCoverage, &seqRight, nullptr);
+    simplePathLongest_avance_packed (left, DIR_INCOMING, lenSeqLeft, endDegreeLeft, markDuringTraversal, leftTotalCoverage, &seqLeft, nullptr);
 
     isolatedLeft  = (endDegreeLeft == 0);
     isolatedRight = (endDegreeRight == 0);
 
-    // glue everything together
-    seq = seqLeft + seq + seqRight;
+    // glue everything together (seqLeft holds the reverse complement of the left part), and decode the contig only now
+    seqLeft.reverseComplement();
+    internal_append_unitig_sequence(seqLeft, node.unitig, 0, unitigLength, false);
+    seqLeft.append(seqRight);
+
+    string seq = seqLeft.toString();
     coverage = (rightTotalCoverage + leftTotalCoverage + midTotalCoverage) / (seq.size() - kmerSize + 1);
     return seq;
 }
@@ -2109,6 +2132,19 @@ std::string GraphUnitigsTemplate<span>::internal_get_unitig_sequence(unsigned in
     return res;
 }
 
+/* appends the nucleotides [begin, begin+len) of a unitig (or their reverse complement) to a 2-bit sequence, without decoding them */
+template<size_t span>
+void GraphUnitigsTemplate<span>::internal_append_unitig_sequence(PackedSequence& seq, unsigned int id, unsigned int begin, unsigned int len, bool revcomp) const
+{
+    uint64_t nbBytes = (unitigs_sizes[id]+3)/4;
+    const char* data;
+    if (pack_unitigs)
+       data = packed_unitigs.data() + (id == 0 ? 0 : packed_unitigs_sizes.prefix_sum(id));
+    else
+       data = unitigs[id].data();
+    seq.append((const u_int8_t*)data, nbBytes, begin, len, revcomp);
+}
+
 template<size_t span>
 unsigned int GraphUnitigsTemplate<span>::internal_get_unitig_length(unsigned int id) const
 {
@@ -27,6 +27,7 @@
 #include <gatb/debruijn/impl/Graph.hpp>
 #include <gatb/debruijn/impl/UnitigsConstructionAlgorithm.hpp>
 #include <gatb/debruijn/impl/ExtremityInfo.hpp>
+#include <gatb/debruijn/impl/PackedSequence.hpp>
 
 #include <gatb/debruijn/impl/dag_vector.hpp> // TODO move it to 3rd party
 
@@ -405,6 +406,10 @@ public: // was private: before, but had many compilation errors during the chang
       
     // support for 2-bit compression of unitigs
     std::string internal_get_unitig_sequence(unsigned int unitig_id) const;
+    void internal_append_unitig_sequence(PackedSequence& seq, unsigned int unitig_id, unsigned int begin, unsigned int len, bool revcomp) const;
+
+    // simplePathLongest_avance, with the sequence built 2-bit packed (for DIR_INCOMING, it is the reverse complement of the traversed sequence)
+    void simplePathLongest_avance_packed(const NodeGU& node, Direction dir, int& seqLength, int& endDegree, bool markDuringTraversal, float& coverage, PackedSequence* seq, std::vector<NodeGU> *unitigNodes);
     unsigned int internal_get_unitig_length(unsigned int unitig_id) const;
     std::string internal_compress_unitig(std::string seq) const;
 
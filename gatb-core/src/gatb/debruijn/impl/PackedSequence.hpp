@@ -0,0 +1,178 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file PackedSequence.hpp
+ *  \brief Nucleotide sequence built from 2-bit packed slices
+ */
+
+#ifndef _GATB_CORE_DEBRUIJN_IMPL_PACKED_SEQUENCE_HPP_
+#define _GATB_CORE_DEBRUIJN_IMPL_PACKED_SEQUENCE_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <string.h>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace debruijn  {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Nucleotide sequence stored with 2 bits per nucleotide
+ *
+ * The sequence is built by appending slices of 2-bit packed sequences (the unitigs of GraphUnitigs),
+ * possibly reverse complemented; the nucleotides are moved by words of 28 nucleotides, so the ASCII
+ * sequence is decoded only once, by toString.
+ *
+ * The packing is the one of GraphUnitigs: 4 nucleotides per byte, the first one in the low bits,
+ * with the encoding A=0, C=1, T=2, G=3 (so the complement of a nucleotide is nt^2).
+ *
+ * NOTE: packed bytes are read by 64 bits words, which assumes a little endian architecture.
+ */
+class PackedSequence
+{
+public:
+
+    /** Constructor. */
+    PackedSequence () : _size(0)  {}
+
+    /** Get the number of nucleotides of the sequence.
+     * \return the sequence size. */
+    size_t size () const  { return _size; }
+
+    /** Remove all the nucleotides. */
+    void clear ()  { _words.clear();  _size = 0; }
+
+    /** Append a slice of a 2-bit packed sequence.
+     * \param[in] data : the packed sequence
+     * \param[in] nbBytes : number of bytes of data that can be read
+     * \param[in] begin : index of the first nucleotide of the slice
+     * \param[in] len : number of nucleotides of the slice
+     * \param[in] revcomp : if true, the reverse complement of the slice is appended */
+    void append (const u_int8_t* data, size_t nbBytes, size_t begin, size_t len, bool revcomp)
+    {
+        if (!revcomp)
+        {
+            for (size_t i=0; i<len; )
+            {
+                size_t n = std::min ((size_t)CHUNK, len-i);
+                push (load (data, nbBytes, begin+i) & mask(n), n);
+                i += n;
+            }
+        }
+        else
+        {
+            for (size_t i=len; i>0; )
+            {
+                size_t n = std::min ((size_t)CHUNK, i);
+                u_int64_t w = load (data, nbBytes, begin+i-n) & mask(n);
+                push ((reverse(w) >> (64-2*n)) ^ (COMPLEMENT & mask(n)), n);
+                i -= n;
+            }
+        }
+    }
+
+    /** Append another packed sequence.
+     * \param[in] other : the sequence to be appended */
+    void append (const PackedSequence& other)
+    {
+        for (size_t i=0; i<other._words.size(); i++)  {  push (other._words[i], std::min ((size_t)32, other._size - 32*i));  }
+    }
+
+    /** Replace the sequence by its reverse complement. */
+    void reverseComplement ()
+    {
+        PackedSequence result;
+        result._words.reserve (_words.size());
+        result.append ((const u_int8_t*) _words.data(), _words.size()*sizeof(u_int64_t), 0, _size, true);
+        std::swap (_words, result._words);
+    }
+
+    /** Decode the sequence.
+     * \return the ASCII sequence. */
+    std::string toString () const
+    {
+        static const char table[] = { 'A', 'C', 'T', 'G' };
+
+        std::string result (_size, 'x');
+        for (size_t i=0; i<_size; i+=32)
+        {
+            u_int64_t w = _words[i/32];
+            size_t    n = std::min ((size_t)32, _size-i);
+            for (size_t j=0; j<n; j++, w>>=2)  {  result[i+j] = table[w & 3];  }
+        }
+        return result;
+    }
+
+private:
+
+    /** Number of nucleotides moved at once: a 64 bits word read at any nucleotide of a byte holds at least 29 of them. */
+    static const size_t CHUNK = 28;
+
+    static const u_int64_t COMPLEMENT = 0xAAAAAAAAAAAAAAAAULL;
+
+    std::vector<u_int64_t> _words;
+    size_t                 _size;
+
+    static u_int64_t mask (size_t n)  {  return n>=32 ? ~(u_int64_t)0 : (((u_int64_t)1 << (2*n)) - 1);  }
+
+    /** Get the nucleotides of a packed sequence starting at a given one (in the low bits of the result). */
+    static u_int64_t load (const u_int8_t* data, size_t nbBytes, size_t pos)
+    {
+        size_t    b = pos/4;
+        u_int64_t w = 0;
+        if (b+sizeof(w) <= nbBytes)  {  memcpy (&w, data+b, sizeof(w));  }
+        else if (b < nbBytes)        {  memcpy (&w, data+b, nbBytes-b);  }
+        return w >> (2*(pos%4));
+    }
+
+    /** Reverse the order of the 32 nucleotides of a word. */
+    static u_int64_t reverse (u_int64_t w)
+    {
+        w = ((w >> 2) & 0x3333333333333333ULL) | ((w & 0x3333333333333333ULL) << 2);
+        w = ((w >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((w & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        return __builtin_bswap64 (w);
+    }
+
+    /** Append n (at most 32) nucleotides given in the low bits of a word (the other bits being 0). */
+    void push (u_int64_t w, size_t n)
+    {
+        size_t offset = 2*(_size % 32);
+
+        if (offset == 0)  {  _words.push_back (w);  }
+        else
+        {
+            _words.back() |= w << offset;
+            if (offset + 2*n > 64)  {  _words.push_back (w >> (64-offset));  }
+        }
+        _size += n;
+    }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_DEBRUIJN_IMPL_PACKED_SEQUENCE_HPP_ */
@@ -51,6 +51,7 @@
 #include <gatb/tools/misc/impl/Algorithm.hpp>
 #include <gatb/tools/misc/impl/Histogram.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
+#include <gatb/tools/misc/impl/ProgressJson.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
 #include <gatb/tools/misc/impl/TimeInfo.hpp>
 #include <gatb/tools/misc/impl/Tool.hpp>
@@ -41,6 +41,9 @@
 
 #include <gatb/tools/math/NativeInt8.hpp>
 
+#include <vector>
+#include <algorithm>
+
 /********************************************************************************/
 namespace gatb      {
 namespace core      {
@@ -82,6 +85,9 @@ public:
      * \param[in] nbCores : number of cores to be used for the iteration of items to be inserted
      * \param[in] min_abundance : if >0, only kmers having abundance greater than that threshold are inserted into the Bloom filter.
      *                            otherwise all items are inserted.
+     * \param[in] byBlocks : if true and if the Bloom filter kind works by blocks (cache and neighbor kinds), the kmers
+     *                       are dispatched by block to the threads, which fill their own part of the bit set without
+     *                       atomic operations (see buildByBlocks). The filter is the same in both cases.
      */
     BloomBuilder (
         u_int64_t   bloomSize,
@@ -89,9 +95,10 @@ public:
         size_t      ksize,
         tools::misc::BloomKind bloomKind = tools::misc::BLOOM_DEFAULT,
         size_t      nbCores = 0,
-		int		    min_abundance =0
+		int		    min_abundance =0,
+        bool        byBlocks = true
     )
-        : _bloomSize (bloomSize), _nbHash (nbHash), _nbCores(nbCores), _ksize(ksize), _min_abundance(min_abundance), _bloomKind(bloomKind)
+        : _bloomSize (bloomSize), _nbHash (nbHash), _nbCores(nbCores), _ksize(ksize), _min_abundance(min_abundance), _byBlocks(byBlocks), _bloomKind(bloomKind)
     {
     }
 
@@ -113,8 +120,20 @@ public:
         tools::collections::impl::IBloom<Type>* bloom =
             tools::collections::impl::BloomFactory::singleton().createBloom<Type> (_bloomKind, _bloomSize, _nbHash, _ksize);
 
+        tools::dp::impl::Dispatcher dispatcher (_nbCores);
+
         /** We launch the bloom fill. */
-        tools::dp::impl::Dispatcher(_nbCores).iterate (itKmers,  BuildKmerBloom (*bloom,_min_abundance));
+        tools::collections::impl::BloomCacheCoherent<Type>* blocksBloom =
+            _byBlocks ? dynamic_cast<tools::collections::impl::BloomCacheCoherent<Type>*> (bloom) : 0;
+
+        if (blocksBloom != 0 && dispatcher.getExecutionUnitsNumber() > 1 && blocksBloom->getNbBlocks() >= 4)
+        {
+            buildByBlocks (itKmers, *blocksBloom, dispatcher);
+        }
+        else
+        {
+            dispatcher.iterate (itKmers,  BuildKmerBloom (*bloom,_min_abundance));
+        }
 
         /** We gather some statistics. */
         if (stats != 0)
@@ -167,6 +186,7 @@ private:
     size_t    _nbCores;
     size_t    _ksize;
 	int _min_abundance;
+    bool      _byBlocks;
 	
     tools::misc::BloomKind _bloomKind;
 
@@ -179,6 +199,108 @@ private:
         tools::collections::impl::IBloom<Type>& _bloom;
 		int _min_abundance;
     };
+
+    /** Fill a Bloom filter working by blocks. Inserting kmers from all threads into the whole bit set needs
+     * atomic operations on random cache lines, which is slow on many cores. Instead, the blocks are split into
+     * ranges and the kmers are dispatched into the range of their block; each range is then filled by one thread
+     * with plain stores. Since the bits of a kmer lie in its block or in the next one, the ranges overlap by one
+     * block: even ranges are filled first, then odd ranges.
+     * The kmers are processed by batches, in order to bound the memory used for dispatching them. */
+    void buildByBlocks (
+        tools::dp::Iterator<Count>* itKmers,
+        tools::collections::impl::BloomCacheCoherent<Type>& bloom,
+        tools::dp::IDispatcher& dispatcher
+    )
+    {
+        static const size_t BATCH_SIZE = 1<<20;
+
+        size_t    nbThreads      = dispatcher.getExecutionUnitsNumber();
+        u_int64_t nbBlocks       = bloom.getNbBlocks();
+        size_t    nbRanges       = (size_t) std::min ((u_int64_t)4*nbThreads, nbBlocks/2);
+        u_int64_t blocksPerRange = (nbBlocks + nbRanges - 1) / nbRanges;
+
+        std::vector<Type> batch;
+        batch.reserve (BATCH_SIZE);
+
+        /** Kmers of the current batch, per staging thread and per range. */
+        std::vector < std::vector < std::vector<Type> > > staging (nbThreads, std::vector < std::vector<Type> > (nbRanges));
+
+        for (itKmers->first(); !itKmers->isDone(); )
+        {
+            batch.clear();
+            for ( ; !itKmers->isDone() && batch.size() < BATCH_SIZE; itKmers->next())
+            {
+                if ((int)itKmers->item().abundance >= _min_abundance)  {  batch.push_back (itKmers->item().value);  }
+            }
+
+            std::vector<tools::dp::ICommand*> cmds;
+            for (size_t t=0; t<nbThreads; t++)
+            {
+                cmds.push_back (new StageCmd (bloom, batch, t, nbThreads, blocksPerRange, staging[t]));
+            }
+            dispatcher.dispatchCommands (cmds, 0);
+
+            for (size_t parity=0; parity<2; parity++)
+            {
+                cmds.clear();
+                for (size_t r=parity; r<nbRanges; r+=2)  {  cmds.push_back (new FillCmd (bloom, staging, r));  }
+                dispatcher.dispatchCommands (cmds, 0);
+            }
+        }
+    }
+
+    /********************************************************************************/
+    class StageCmd : public tools::dp::ICommand, public system::SmartPointer
+    {
+    public:
+        StageCmd (
+            tools::collections::impl::BloomCacheCoherent<Type>& bloom, const std::vector<Type>& batch,
+            size_t tid, size_t nbThreads, u_int64_t blocksPerRange, std::vector < std::vector<Type> >& ranges
+        )
+            : _bloom(bloom), _batch(batch), _tid(tid), _nbThreads(nbThreads), _blocksPerRange(blocksPerRange), _ranges(ranges)  {}
+
+        void execute ()
+        {
+            size_t begin = (_batch.size() *  _tid   ) / _nbThreads;
+            size_t end   = (_batch.size() * (_tid+1)) / _nbThreads;
+
+            for (size_t i=begin; i<end; i++)  {  _ranges [_bloom.getBlock (_batch[i]) / _blocksPerRange].push_back (_batch[i]);  }
+        }
+
+    private:
+        tools::collections::impl::BloomCacheCoherent<Type>& _bloom;
+        const std::vector<Type>& _batch;
+        size_t    _tid;
+        size_t    _nbThreads;
+        u_int64_t _blocksPerRange;
+        std::vector < std::vector<Type> >& _ranges;
+    };
+
+    /********************************************************************************/
+    class FillCmd : public tools::dp::ICommand, public system::SmartPointer
+    {
+    public:
+        FillCmd (
+            tools::collections::impl::BloomCacheCoherent<Type>& bloom,
+            std::vector < std::vector < std::vector<Type> > >& staging, size_t range
+        )
+            : _bloom(bloom), _staging(staging), _range(range)  {}
+
+        void execute ()
+        {
+            for (size_t t=0; t<_staging.size(); t++)
+            {
+                std::vector<Type>& items = _staging[t][_range];
+                for (size_t i=0; i<items.size(); i++)  {  _bloom.insertUnsynchronized (items[i]);  }
+                items.clear();
+            }
+        }
+
+    private:
+        tools::collections::impl::BloomCacheCoherent<Type>& _bloom;
+        std::vector < std::vector < std::vector<Type> > >& _staging;
+        size_t _range;
+    };
 };
 
 /********************************************************************************/
@@ -86,6 +86,14 @@ Properties Configuration::getProperties() const
     result.add (1, "nb_partitions_in_parallel",  "%d",  _nb_partitions_in_parallel);
     result.add (1, "nb_cached_items_per_core_per_part",  "%d",  _nb_cached_items_per_core_per_part);
 
+    if (_sketchSeqNb > 0)
+    {
+        result.add (1, "sketch_sequence_number",      "%ld", _sketchSeqNb);
+        result.add (1, "sketch_distinct_kmers_number","%ld", _sketchDistinctKmersNb);
+        result.add (1, "sketch_kxmers_ratio",         "%.3f", _sketchKxmersRatio);
+        result.add (1, "sketch_partitions_skew",      "%.3f", _sketchSkew);
+    }
+
     result.add (1, "nb_banks",  "%d",  _nb_banks);
 
     return result;
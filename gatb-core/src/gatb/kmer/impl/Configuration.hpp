@@ -45,9 +45,11 @@ public:
       _solidityKind(tools::misc::KMER_SOLIDITY_SUM),
       _max_disk_space(0), _max_memory(0),
       _nbCores(0), _nb_partitions_in_parallel(0), _abundanceUserNb(0), _storage_type(tools::storage::impl::STORAGE_HDF5) ,
+      _sketchSeqNb(0),
       _isComputed(false), _nbCores_per_partition(0),
       _estimateSeqNb(0), _estimateSeqTotalSize(0), _estimateSeqMaxSize(0),
-      _available_space(0), _volume(0), _kmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0) {}
+      _available_space(0), _volume(0), _kmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0),
+      _sketchDistinctKmersNb(0), _sketchKxmersRatio(0), _sketchSkew(0) {}
 
     /****************************************/
     /**             PROVIDED                */
@@ -74,6 +76,9 @@ public:
 	std::vector<bool> _solidVec;
 	size_t _solidVecUserNb;
 
+    /** Number of sequences sampled for sizing passes and partitions (0 means no sampling). */
+    u_int64_t   _sketchSeqNb;
+
     /****************************************/
     /**             COMPUTED                */
     /****************************************/
@@ -99,6 +104,12 @@ public:
     
     u_int32_t   _nb_cached_items_per_core_per_part;
 
+    /** Figures measured on a sample of the bank (see ConfigurationAlgorithm). They are only used
+     * for computing the configuration and are not saved with it. */
+    u_int64_t   _sketchDistinctKmersNb;
+    float       _sketchKxmersRatio;
+    float       _sketchSkew;
+
 
     /****************************************/
     /**               MISC                  */
@@ -23,6 +23,11 @@
 #include <gatb/tools/misc/api/StringsRepository.hpp>
 #include <gatb/tools/misc/impl/Tokenizer.hpp>
 #include <gatb/kmer/impl/LinearCounter.hpp>
+#include <gatb/kmer/impl/Sequence2SuperKmer.hpp>
+#include <gatb/kmer/impl/PartiInfo.hpp>
+#include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/math/HyperLogLog.hpp>
 
 #include <cmath>
 
@@ -45,9 +50,14 @@ using namespace gatb::core::kmer::impl;
 using namespace gatb::core::tools::collections;
 using namespace gatb::core::tools::collections::impl;
 
+using namespace gatb::core::tools::dp;
+using namespace gatb::core::tools::dp::impl;
+
 using namespace gatb::core::tools::misc;
 using namespace gatb::core::tools::misc::impl;
 
+using namespace gatb::core::tools::math;
+
 /********************************************************************************/
 
 #define DEBUG(a)  //printf a
@@ -177,6 +187,79 @@ private:
 };
 
 
+/********************************************************************************/
+/* This functor class splits the sequences of a sample of the bank into superkmers and
+ * collects the figures used for sizing passes and partitions:
+ *   - the number of distinct kmers (HyperLogLog)
+ *   - the number of kxmers per minimizer bin, computed the same way as SampleRepart in
+ *     RepartitionAlgorithm (ie. what is actually stored in the partitions).
+ */
+struct SketchInfo
+{
+    SketchInfo (size_t nbMinims) : binLoads(nbMinims, 0), nbSeqs(0), nbKmers(0), nbKxmers(0) {}
+
+    HyperLogLog            hll;
+    std::vector<u_int64_t> binLoads;
+    u_int64_t              nbSeqs;
+    u_int64_t              nbKmers;
+    u_int64_t              nbKxmers;
+};
+
+template<size_t span>
+class SampleSketch : public Sequence2SuperKmer<span>
+{
+public:
+
+    /** Shortcut. */
+    typedef typename Sequence2SuperKmer<span>::Model       Model;
+    typedef typename Kmer<span>::SuperKmer                 SuperKmer;
+
+    /** */
+    void operator() (Sequence& sequence)
+    {
+        Sequence2SuperKmer<span>::operator() (sequence);
+
+        if (++_info.nbSeqs >= _nbSeqsToSee)  {  *_cancelIterator = true;  }
+    }
+
+    /** */
+    void processSuperkmer (SuperKmer& superKmer)
+    {
+        if (superKmer.isValid() == false || superKmer.size() == 0)  { return; }
+
+        bool   prev_which = superKmer[0].which();
+        size_t kx_size    = 0;
+        size_t nbKxmers   = 1;
+
+        _info.hll.add (hash1 (superKmer[0].value(), 0));
+
+        for (size_t ii=1 ; ii < superKmer.size(); ii++)
+        {
+            _info.hll.add (hash1 (superKmer[ii].value(), 0));
+
+            if (superKmer[ii].which() != prev_which || kx_size >= _kx)  {  nbKxmers++;  kx_size = 0;  }
+            else                                                       {  kx_size++;               }
+
+            prev_which = superKmer[ii].which() ;
+        }
+
+        _info.binLoads[superKmer.minimizer] += nbKxmers;
+        _info.nbKmers  += superKmer.size();
+        _info.nbKxmers += nbKxmers;
+    }
+
+    /** Constructor. */
+    SampleSketch (Model& model, SketchInfo& info, bool* cancelIterator, u_int64_t nbSeqsToSee, BankStats& bankStats)
+        : Sequence2SuperKmer<span> (model, 1, 0, 1, NULL, bankStats),
+          _kx(4), _info(info), _cancelIterator(cancelIterator), _nbSeqsToSee(nbSeqsToSee)  {}
+
+private:
+    size_t      _kx;
+    SketchInfo& _info;
+    bool*       _cancelIterator;
+    u_int64_t   _nbSeqsToSee;
+};
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -202,6 +285,7 @@ ConfigurationAlgorithm<span>::ConfigurationAlgorithm (bank::IBank* bank, IProper
     _config._max_disk_space     = input->getInt (STR_MAX_DISK);
     _config._max_memory         = input->getInt (STR_MAX_MEMORY);
     _config._nbCores            = input->get(STR_NB_CORES) ? input->getInt(STR_NB_CORES) : 0;
+    _config._sketchSeqNb        = input->get(STR_CONFIG_SAMPLE) ? input->getInt(STR_CONFIG_SAMPLE) : 0;
 
     _config._abundance = getSolidityThresholds(input);
 	
@@ -322,7 +406,14 @@ void ConfigurationAlgorithm<span>::execute ()
 
     if (_config._volume == 0)   { _config._volume = 1; }    // tiny files fix
 
-    u_int64_t volume_minim = _config._volume * 0.5 *1.2  ; //0.5 for using kxmers   1.2 if bad repartition of minimizers ( todo sampling to assert ram usage)
+    /** We look at a sample of the bank for knowing how many kxmers are actually stored per kmer
+     * and how unbalanced the minimizers bins are; without sample, we use 0.5 for using kxmers and
+     * 1.2 if bad repartition of minimizers. */
+    if (_config._sketchSeqNb > 0)  {  sampleBank();  }
+
+    double kxmers_ratio = _config._sketchSeqNb > 0 ? _config._sketchKxmersRatio : 0.5;
+
+    u_int64_t volume_minim = _config._volume * kxmers_ratio;
 
     if (volume_minim == 0)   { volume_minim = 1; }    // tiny files fix
     // volume_minim is used a bit later
@@ -334,7 +425,8 @@ void ConfigurationAlgorithm<span>::execute ()
     if (_config._max_memory == 0)  {  _config._max_memory = System::info().getMemoryProject(); }
     if (_config._max_memory == 0)  {  _config._max_memory = 5000; }
 
-    /* make sure to not use more mem than system, when max_memory has default value (useful for docker images) */
+    /* make sure to not use more mem than system, when max_memory has default value (useful for docker images).
+     * Note that the system memory is bounded by the memory limit of the cgroup of the process, if any. */
     if (_config._max_memory == 5000)  {
         unsigned long system_mem = System::info().getMemoryPhysicalTotal() / MBYTE;
         if (_config._max_memory > (system_mem * 2) / 3)
@@ -407,6 +499,17 @@ void ConfigurationAlgorithm<span>::execute ()
         // _nb_partitions  = ( (volume_per_pass*_nbCores) / _max_memory ) + 1;
         _config._nb_partitions  = ( ( volume_per_pass* _config._nb_partitions_in_parallel) / _config._max_memory ) + 1;
 
+        /** The skew depends on the number of partitions, so we iterate a few times until it is stable. */
+        for (size_t nbIter=0; nbIter<4; nbIter++)
+        {
+            _config._sketchSkew = getPartitionsSkew (_config._nb_partitions);
+
+            u_int32_t nb_partitions = ( (u_int64_t)(volume_per_pass * _config._sketchSkew * _config._nb_partitions_in_parallel) / _config._max_memory ) + 1;
+
+            if (nb_partitions == _config._nb_partitions)  { break; }
+            _config._nb_partitions = nb_partitions;
+        }
+
         //printf("nb passes  %i  (nb part %i / %zu)\n",_nb_passes,_nb_partitions,max_open_files);
         //_nb_partitions = max_open_files; break;
 
@@ -466,6 +569,82 @@ void ConfigurationAlgorithm<span>::execute ()
     getInfo()->add (1, _config.getProperties());
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : sample the first sequences of each bank and keep the
+**           sketch figures in the configuration
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+void ConfigurationAlgorithm<span>::sampleBank ()
+{
+    TIME_INFO (getTimeInfo(), "sample");
+
+    typedef typename Sequence2SuperKmer<span>::Model Model;
+
+    Model model (_config._kmerSize, _config._minim_size);
+
+    SketchInfo info ((u_int64_t)1 << (2*_config._minim_size));
+    BankStats  bstatsDummy;
+
+    Iterator<Sequence>* it = _bank->iterator();  LOCAL (it);
+
+    /** In case of multi bank counting, we get a sample from each bank. */
+    std::vector<Iterator<Sequence>*> itBanks = it->getComposition();
+
+    u_int64_t nbSeqsPerBank = std::max ((u_int64_t)1, _config._sketchSeqNb / itBanks.size());
+
+    SerialDispatcher serialDispatcher;
+
+    for (size_t i=0; i<itBanks.size(); i++)
+    {
+        CancellableIterator<Sequence>* cancellable_it = new CancellableIterator<Sequence> (*itBanks[i]);
+        LOCAL (cancellable_it);
+
+        serialDispatcher.iterate (cancellable_it, SampleSketch<span> (
+            model, info, &(cancellable_it->_cancel), info.nbSeqs + nbSeqsPerBank, bstatsDummy
+        ));
+
+        itBanks[i]->finalize();
+    }
+
+    _config._sketchSeqNb = info.nbSeqs;
+
+    if (info.nbKmers == 0)  {  _config._sketchSeqNb = 0;  return;  }
+
+    /** The distinct kmers number is extrapolated linearly from the sample, which is an upper bound. */
+    u_int64_t nbDistinct = info.hll.estimate();
+    _config._sketchDistinctKmersNb = info.nbSeqs >= _config._estimateSeqNb ?
+        nbDistinct :
+        std::min ((u_int64_t)_config._kmersNb, (u_int64_t) ((double)nbDistinct * _config._kmersNb / info.nbKmers));
+
+    _config._sketchKxmersRatio = (double)info.nbKxmers / (double)info.nbKmers;
+
+    _sketchBinLoads.swap (info.binLoads);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : without sample, we keep the historical 1.2 factor
+*********************************************************************/
+template<size_t span>
+double ConfigurationAlgorithm<span>::getPartitionsSkew (size_t nbPartitions)
+{
+    static const double maxSkew = 3.0;
+
+    if (_sketchBinLoads.empty())  { return 1.2; }
+
+    /** The skew of a small sample over many partitions is overestimated, hence the cap. */
+    return std::min (maxSkew, Repartitor::estimateSkew (_sketchBinLoads, nbPartitions));
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
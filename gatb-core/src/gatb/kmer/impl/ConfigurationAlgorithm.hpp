@@ -60,11 +60,20 @@ private:
 
 	static std::vector<bool> getSolidityCustomVector (tools::misc::IProperties* params);
 
+    /** Fill the sketch figures of the configuration from a sample of the bank. */
+    void sampleBank ();
+
+    /** Skew of the partitions for the given number of partitions. */
+    double getPartitionsSkew (size_t nbPartitions);
+
     /** Shortcut. */
     typedef typename Kmer<span>::Type Type;
 
     Configuration _config;
 
+    /** Kxmers number per minimizer in the sample of the bank. */
+    std::vector<u_int64_t> _sketchBinLoads;
+
     bank::IBank* _bank;
     void setBank (bank::IBank* bank) { SP_SETATTR(bank); }
 
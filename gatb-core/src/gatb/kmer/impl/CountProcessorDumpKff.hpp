@@ -26,10 +26,12 @@
 #include <gatb/kmer/impl/CountProcessorAbstract.hpp>
 #include <gatb/tools/storage/impl/Storage.hpp>
 #include <gatb/tools/misc/impl/Stringify.hpp>
+#include <gatb/tools/misc/api/Range.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
 #include <kff-cpp-api/kff_io.hpp>
-#include <kff-cpp-api/merge.hpp>
-#include <dirent.h>
-#include <errno.h>
+
+#include <algorithm>
+#include <string.h>
 
 /********************************************************************************/
 namespace gatb      {
@@ -38,11 +40,21 @@ namespace kmer      {
 namespace impl      {
 /********************************************************************************/
 
-/** The CountProcessorDumpKff 
+/** The CountProcessorDumpKff implementation dumps the solid kmers and their counts
+ * in a KFF file (see https://github.com/Kmer-File-Format).
+ *
+ * A clone instance writes the kmers of one partition in its own temporary KFF file:
+ * the kmers of the partition are grouped by minimizer (the one used for the partitioning,
+ * taken in the strand where it occurs), and each group is written as a minimizer section,
+ * so the minimizer is stored once per group instead of once per kmer. The counts are
+ * stored on the smallest number of bytes that holds the maximum count of the partition.
  *
- * see CountProcessorDump for a real doc
+ * The temporary files have no metadata and no index, so their sections are self-contained
+ * and the final file is built by copying them (in parallel) one after the other between
+ * a KFF header and a KFF footer, without decoding them.
  *
- * */
+ * see CountProcessorDump for the general use of a count processor.
+ */
 template<size_t span=KMER_DEFAULT_SPAN>
 class CountProcessorDumpKff : public CountProcessorAbstract<span>
 {
@@ -52,33 +64,47 @@ public:
     typedef typename Kmer<span>::Count Count;
     typedef typename Kmer<span>::Type Type;
     typedef typename kmer::impl::Kmer<span>::ModelCanonical ModelCanonical;
-
-    /** Constructor */
+    typedef typename kmer::impl::Kmer<span>::template ModelMinimizer<ModelCanonical> ModelMini;
+
+    /** Constructor
+     * \param[in] prefix : the temporary files are put in the 'prefix' directory, the final file is 'prefix.merged.kff'
+     * \param[in] group : group of the dsk storage
+     * \param[in] kmerSize : size of the kmers
+     * \param[in] minimizerSize : size of the minimizers used for grouping the kmers
+     * \param[in] nbCores : number of cores used for building the final file (0 means all cores)
+     * \param[in] synchronizer : synchronizer shared by the clones
+     * \param[in] modelMini : minimizer model shared by the clones (0 for the prototype, which creates it)
+     * \param[in] nbPartsPerPass : number of partitions per pass */
     CountProcessorDumpKff (
-            std::string                         prefix,
+        std::string                             prefix,
         tools::storage::impl::Group&            group,
         const size_t                            kmerSize,
-        system::ISynchronizer*                  synchronizer = 0,
-        tools::storage::impl::Partition<Count>* solidCounts  = 0,
+        const size_t                            minimizerSize,
+        size_t                                  nbCores        = 0,
+        system::ISynchronizer*                  synchronizer   = 0,
+        ModelMini*                              modelMini      = 0,
         size_t                                  nbPartsPerPass = 0
     )
-        : _prefix(prefix), _group(group), _kmerSize(kmerSize), _nbPartsPerPass(nbPartsPerPass), _synchronizer(0), _model(kmerSize)
+        : _prefix(prefix), _outfile(0), _group(group), _kmerSize(kmerSize), _minimizerSize(minimizerSize),
+          _nbCores(nbCores), _nbPartsPerPass(nbPartsPerPass), _synchronizer(0),
+          _modelMini(modelMini), _isModelOwner(modelMini==0)
     {
         setSynchronizer (synchronizer);
-        // create kff temp dir
-        if(!System::file().doesExist(_prefix)){
-            int ok = System::file().mkdir(_prefix, 0755);
-            if(ok != 0){
-                //throw Exception ("Error: can't create kff directory");
-            }
-        }
 
+        if (_isModelOwner)  {  _modelMini = new ModelMini (_kmerSize, _minimizerSize);  }
 
+        /** We create the directory of the temporary kff files. */
+        if (!system::impl::System::file().doesExist(_prefix))
+        {
+            system::impl::System::file().mkdir (_prefix, 0755);
+        }
     }
 
     /** Destructor */
     virtual ~CountProcessorDumpKff ()
     {
+        setSynchronizer (0);
+        if (_isModelOwner)  {  delete _modelMini;  }
     }
 
     /********************************************************************/
@@ -90,16 +116,13 @@ public:
     {
         /** We remember the number of partitions for one pass. */
         _nbPartsPerPass = config._nb_partitions;
-
-        /** We compute the number of partitions. */
-        //size_t nbTotalPartitions = config._nb_partitions * config._nb_passes;
     }
 
     /** \copydoc ICountProcessor<span>::clones */
     CountProcessorAbstract<span>* clone ()
     {
-        /** Note : we share the synchronizer for all the clones. */
-        return new CountProcessorDumpKff (_prefix, _group, _kmerSize, _synchronizer, 0, _nbPartsPerPass);
+        /** Note : we share the synchronizer and the minimizer model for all the clones. */
+        return new CountProcessorDumpKff (_prefix, _group, _kmerSize, _minimizerSize, _nbCores, _synchronizer, _modelMini, _nbPartsPerPass);
     }
 
     /** \copydoc ICountProcessor<span>::finishClones */
@@ -114,44 +137,22 @@ public:
                 {
                     this->_namesOccur[it->first] += it->second;
                 }
-	    }
-	}
-
-	// get list of KFF files
-	std::vector<std::string> list_kff_files;
-	if (auto dir = opendir((_prefix + "/").c_str())) {
-		while (auto f = readdir(dir)) {
-			if (f->d_name[0] == '.' && (f->d_name[1] == '.' || f->d_name[1] == '\0'))
-				continue; // Skip "." and ".."
-			list_kff_files.push_back(std::string(_prefix + "/" + f->d_name));
-		}
-		closedir(dir);
-	}
-
-	// this seems like a good place to do KFF merge
-        kff_merge(list_kff_files,_prefix + ".merged.kff");
-
-        // cleanup
-        for (auto kff_file : list_kff_files)
-	{
-		remove(kff_file.c_str());
-	}
-
-	// print list of KFF files (in case directory removal didn't work)
-	if (auto dir = opendir((_prefix + "/").c_str())) {
-		while (auto f = readdir(dir)) {
-			if (f->d_name[0] == '.' && (f->d_name[1] == '.' || f->d_name[1] == '\0'))
-				continue; // Skip "." and ".."
-			std::cout << "file couldn't be deleted:" << std::string(_prefix + "/" + f->d_name) << std::endl;
-		}
-		closedir(dir);
-	}
-
-	int rmdir_res = rmdir((_prefix + "/").c_str());
-        if (rmdir_res != 0)
-            std::cout << "failed to remove folder (" << _prefix << "): "<< strerror(errno) << std::endl;
+
+                _parts.insert (_parts.end(), clone->_parts.begin(), clone->_parts.end());
+            }
+        }
     }
 
+    /** \copydoc ICountProcessor<span>::end */
+    void end ()
+    {
+        /** The partitions are put in the final file in the order of the passes and partitions. */
+        std::sort (_parts.begin(), _parts.end());
+
+        merge (_prefix + ".merged.kff");
+
+        system::impl::System::file().rmdir (_prefix);
+    }
 
     /********************************************************************/
     /*   METHODS CALLED ON ONE CLONED INSTANCE (in a separate thread).  */
@@ -160,95 +161,116 @@ public:
     /** \copydoc ICountProcessor<span>::beginPart */
     void beginPart (size_t passId, size_t partId, size_t cacheSize, const char* name)
     {
-        /** We get the actual partition idx in function of the current partition AND pass identifiers. */
-        //size_t actualPartId = partId + (passId * _nbPartsPerPass);
-
         /** We update some stats (want to know how many "hash" or "vector" partitions we use). */
         _namesOccur[name] ++;
 
-        _outfile = new Kff_file(_prefix + "/" +std::to_string(passId) + "-" + std::to_string(partId) + ".kff", "w");
-       
-        uint8_t encoding[] = {0, 1, 3, 2};
-        _outfile->write_encoding(encoding);
-           
-        /** We save (as metadata) some information. */
-        Section_GV sgv(_outfile);
-        sgv.write_var("k", _kmerSize);
-        sgv.write_var("max", 1); // 1 kmer per sequence
-        sgv.write_var("data_size", 4); // DSK counts are stored as uint32_t
-        sgv.close();
+        _parts.push_back (std::make_pair (passId, partId));
+
+        _outfile = new Kff_file (getPartName (passId, partId), "w");
 
-        //std::cout <<"new part " << passId << " " << partId << " " << name <<std::endl;
-        sr = new Section_Raw(_outfile);
+        /** GATB nucleotides codes, ie. A=0, C=1, T=2, G=3 */
+        uint8_t encoding[] = {0, 1, 3, 2};
+        _outfile->write_encoding  (encoding);
+        _outfile->set_uniqueness  (true);
+        _outfile->set_canonicity  (true);
+        _outfile->set_indexation  (false);
+        _outfile->write_metadata  (0, 0);
+
+        _items.clear();
+        _maxCount = 0;
     }
 
     /** \copydoc ICountProcessor<span>::endPart */
     void endPart (size_t passId, size_t partId)
     {
-        /** We flush the current collection for the partition just processed. */
-        sr->close();
-        delete _outfile;
-    }
+        /** We group the kmers by minimizer. */
+        std::sort (_items.begin(), _items.end());
+
+        /** The counts are stored on the smallest number of bytes holding the maximum count. */
+        size_t dataSize = 1;
+        while (dataSize < sizeof(CountNumber) && ((u_int64_t)_maxCount >> (8*dataSize)) != 0)  { dataSize++; }
+
+        /** Note that all the variables of a global variables section are needed, since
+         * each one of them resets the variables of the previous sections. */
+        Section_GV sgv (_outfile);
+        sgv.write_var ("k",         _kmerSize);
+        sgv.write_var ("m",         _minimizerSize);
+        sgv.write_var ("max",       1);  // 1 kmer per block
+        sgv.write_var ("data_size", dataSize);
+        sgv.close();
+
+        size_t   seqSize = _kmerSize - _minimizerSize;
+        uint8_t  minimizer[32];
+        uint8_t  seq[(2*span+7)/8];
+        uint8_t  data[sizeof(CountNumber)];
 
-   
-	// from kff-cpp-api 
-		/* Transform a char * sequence into a uint8_t 2-bits/nucl
-		* Encoding ACTG
-		* Size must be <= 4
-		*/
-		uint8_t uint8_packing(std::string sequence) {
-			size_t size = sequence.length();
-			assert(size <= 4);
-
-			uint8_t val = 0;
-			for (size_t i=0 ; i<size ; i++) {
-				val <<= 2;
-				val += (sequence[i] >> 1) & 0b11;
-			}
-
-			return val;
-		}
-
-		/* Encode the sequence into an array of uint8_t packed sequence slices.
-		* The encoded sequences are organised in big endian order.
-		*/
-		void encode_sequence(std::string sequence, uint8_t * encoded) {
-			size_t size = sequence.length();
-			// Encode the truncated first 8 bits sequence
-			size_t remnant = size % 4;
-			if (remnant > 0) {
-				encoded[0] = uint8_packing(sequence.substr(0, remnant));
-				encoded += 1;
-			}
-
-			// Encode all the 8 bits packed
-			size_t nb_uint_needed = size / 4;
-			for (size_t i=0 ; i<nb_uint_needed ; i++) {
-				encoded[i] = uint8_packing(sequence.substr(remnant + 4*i, 4));
-				// encoded[i] = uint8_packing(sequence + remnant + (i<<2), 4);
-			}
-		}
-
-
-        // some questions about endianness here
-        void u8from32 (uint8_t b[4], uint32_t u32)
+        for (size_t i=0; i<_items.size(); )
         {
-            b[3] = (uint8_t)u32;
-            b[2] = (uint8_t)(u32>>=8);
-            b[1] = (uint8_t)(u32>>=8);
-            b[0] = (uint8_t)(u32>>=8);
+            Section_Minimizer sm (_outfile);
+            Type mini;  mini.setVal (_items[i].minimizer);
+            pack (mini, _minimizerSize, minimizer);
+            sm.write_minimizer (minimizer);
+
+            size_t j = i;
+            for ( ; j<_items.size() && _items[j].minimizer == _items[i].minimizer; j++)
+            {
+                const Item& item = _items[j];
+
+                /** We remove the minimizer from the kmer. */
+                size_t suffixSize = seqSize - item.position;
+                Type   un;  un.setVal(1);
+                Type   suffix = item.kmer & ((un << (2*suffixSize)) - un);
+                Type   prefix = item.kmer >> (2*(suffixSize + _minimizerSize));
+
+                pack ((prefix << (2*suffixSize)) | suffix, seqSize, seq);
+
+                for (size_t b=0; b<dataSize; b++)  {  data[b] = (uint8_t) (item.count >> (8*(dataSize-1-b)));  }
+
+                sm.write_compacted_sequence_without_mini (seq, seqSize, item.position, data);
+            }
+            sm.close();
+
+            i = j;
         }
 
+        _outfile->close();
+        delete _outfile;
+        _outfile = 0;
+
+        std::vector<Item>().swap (_items);
+    }
+
     /** \copydoc ICountProcessor<span>::process */
     bool process (size_t partId, const Type& kmer, const CountVector& count, CountNumber sum)
     {
-        std::string sequence = _model.toString(kmer);
-		uint8_t encoded[1024];
-     	uint8_t counts[4];
-        encode_sequence(sequence.c_str(), encoded);
-		u8from32(counts, sum);
-        //std::cout << std::to_string((int)counts[0]) << "-" << std::to_string((int)counts[1]) << "-"<< std::to_string((int)counts[2])  <<"-"<< std::to_string((int)counts[3]) <<";"<<std::endl;
-        sr->write_compacted_sequence(encoded, _kmerSize, counts);
+        /** We look for the minimizer in the strand where it occurs (as a forward mmer). */
+        int position = std::max (_modelMini->getMinimizerPosition (kmer), 0);
+
+        size_t shift = 2*(_kmerSize - _minimizerSize - position);
+        Type   un;  un.setVal(1);
+        Type   mmer  = (kmer >> shift) & ((un << (2*_minimizerSize)) - un);
+        Type   rmmer = revcomp (mmer, _minimizerSize);
+
+        Item item;
+        item.count = sum;
+
+        if (!(rmmer < mmer))
+        {
+            item.minimizer = mmer.getVal();
+            item.kmer      = kmer;
+            item.position  = position;
+        }
+        else
+        {
+            item.minimizer = rmmer.getVal();
+            item.kmer      = revcomp (kmer, _kmerSize);
+            item.position  = _kmerSize - _minimizerSize - position;
+        }
+
+        _items.push_back (item);
+
+        if (sum > _maxCount)  { _maxCount = sum; }
+
         return true;
     }
 
@@ -270,27 +292,140 @@ public:
 
 private:
 
-    std::string _prefix;
-    Kff_file *_outfile;
-    Section_Raw *sr;
+    /** Header of the temporary files: signature, version, encoding, uniqueness, canonicity and empty metadata. */
+    static const size_t HEADER_SIZE = 12;
+
+    /** Trailer of the KFF files: the signature. */
+    static const size_t TRAILER_SIZE = 3;
 
+    /** Footer of the final file: a global variables section holding only 'footer_size'. */
+    static const size_t FOOTER_SIZE = 1 + 8 + 12 + 8;
+
+    /** A kmer of the current partition, oriented so that its minimizer occurs at 'position'. */
+    struct Item
+    {
+        u_int64_t   minimizer;
+        Type        kmer;
+        size_t      position;
+        CountNumber count;
+
+        bool operator< (const Item& other) const  {  return minimizer < other.minimizer;  }
+    };
+
+    std::string _prefix;
+    Kff_file*   _outfile;
 
     tools::storage::impl::Group& _group;
 
     size_t _kmerSize;
+    size_t _minimizerSize;
+    size_t _nbCores;
 
     size_t _nbPartsPerPass;
 
     system::ISynchronizer* _synchronizer;
     void setSynchronizer (system::ISynchronizer* synchronizer)  { SP_SETATTR(synchronizer); }
 
-    ModelCanonical _model;
+    ModelMini* _modelMini;
+    bool       _isModelOwner;
+
+    std::vector<Item> _items;
+    CountNumber       _maxCount;
+
+    /** (pass,partition) pairs whose temporary file has been written. */
+    std::vector<std::pair<size_t,size_t> > _parts;
 
     std::map<std::string,size_t> _namesOccur;
+
+    /** Get the name of the temporary file of a partition. */
+    std::string getPartName (size_t passId, size_t partId) const
+    {
+        std::stringstream ss;  ss << _prefix << "/" << passId << "-" << partId << ".kff";
+        return ss.str();
+    }
+
+    /** Encode nucleotides in KFF format, ie. 2 bits per nucleotide, big endian, the padding being
+     * at the beginning of the first byte. This is the byte representation of the GATB value. */
+    static void pack (Type value, size_t nbNucl, uint8_t* out)
+    {
+        for (size_t i=(nbNucl+3)/4; i>0; i--)
+        {
+            out[i-1] = (uint8_t) (value.getVal() & 0xFF);
+            value = value >> 8;
+        }
+    }
+
+    /** Build the final file by copying the sections of the temporary files at their position in the
+     * final file (known from the files sizes); the copies are done in parallel. */
+    void merge (const std::string& filename)
+    {
+        if (_parts.empty())
+        {
+            /** No partition: we just write an empty KFF file. */
+            Kff_file outfile (filename, "w");
+            outfile.close();
+            return;
+        }
+
+        /** We compute the offsets of the temporary files sections in the final file. */
+        std::vector<u_int64_t> offsets (_parts.size()+1, HEADER_SIZE);
+        for (size_t i=0; i<_parts.size(); i++)
+        {
+            u_int64_t size = system::impl::System::file().getSize (getPartName (_parts[i].first, _parts[i].second));
+            offsets[i+1] = offsets[i] + size - HEADER_SIZE - TRAILER_SIZE;
+        }
+
+        /** The header of the final file is the one of the temporary files. */
+        char header[HEADER_SIZE];
+        system::IFile* first = system::impl::System::file().newFile (getPartName (_parts[0].first, _parts[0].second), "rb");
+        size_t nbRead = first->fread (header, 1, HEADER_SIZE);
+        delete first;
+        if (nbRead != HEADER_SIZE)  { throw system::Exception ("Unable to read KFF header of '%s'", _prefix.c_str()); }
+
+        system::IFile* outfile = system::impl::System::file().newFile (filename, "wb");
+        if (!outfile->isOpen())  { delete outfile;  throw system::Exception ("Unable to create KFF file '%s'", filename.c_str()); }
+
+        /** The final file ends with a footer, ie. a global variables section giving its own size, and the signature. */
+        const char footerName[] = "footer_size";
+        u_int8_t   footer[FOOTER_SIZE+TRAILER_SIZE] = { 'v' };
+        for (size_t i=0; i<8; i++)  {  footer[1+i] = (u_int8_t) ((u_int64_t)1 >> (56-8*i));  }
+        memcpy (footer+9, footerName, sizeof(footerName));
+        for (size_t i=0; i<8; i++)  {  footer[9+sizeof(footerName)+i] = (u_int8_t) ((u_int64_t)FOOTER_SIZE >> (56-8*i));  }
+        memcpy (footer+FOOTER_SIZE, "KFF", TRAILER_SIZE);
+
+        bool ok = outfile->pwrite (header, HEADER_SIZE, 0) == HEADER_SIZE
+               && outfile->pwrite (footer, sizeof(footer), offsets.back()) == sizeof(footer);
+
+        tools::dp::impl::Dispatcher dispatcher (_nbCores);
+
+        dispatcher.iterate (new tools::misc::Range<int>::Iterator (0, _parts.size()-1), [&] (int i)
+        {
+            std::string partName = getPartName (_parts[i].first, _parts[i].second);
+
+            system::IFile*    infile = system::impl::System::file().newFile (partName, "rb");
+            std::vector<char> buffer (1 << 20);
+            u_int64_t         offset = offsets[i];
+
+            infile->seeko (HEADER_SIZE, SEEK_SET);
+            while (offset < offsets[i+1])
+            {
+                size_t len = std::min ((u_int64_t)buffer.size(), offsets[i+1] - offset);
+                if (infile->fread (buffer.data(), 1, len) != len || outfile->pwrite (buffer.data(), len, offset) != len)  {  ok = false;  break;  }
+                offset += len;
+            }
+
+            delete infile;
+            system::impl::System::file().remove (partName);
+        }, 1);
+
+        delete outfile;
+
+        if (!ok)  { throw system::Exception ("Unable to write KFF file '%s'", filename.c_str()); }
+    }
 };
 
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
 
-#endif /* _COUNT_PROCESSOR_DUMP_HPP_ */
+#endif /* _COUNT_PROCESSOR_DUMP_KFF_HPP_ */
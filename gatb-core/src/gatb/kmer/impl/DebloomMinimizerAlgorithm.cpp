@@ -111,7 +111,7 @@ struct FunctorKmersExtensionMinimizer
         size_t               _nbPass;
         size_t               _nbPartsPerPass;
         int                  _currentThreadIndex;
-		vector<PartitionCache<Type>*>& _partCacheVec;
+		vector<PartitionCacheSortedRuns<Type>*>& _partCacheVec;
 
         FunctorNeighbors (
             IBloom<Type>*       bloom,
@@ -119,7 +119,7 @@ struct FunctorKmersExtensionMinimizer
             vector<Type>&       solids,
             Partition<Type>*    extentParts,
             Repartitor&         repart,
-			vector<PartitionCache<Type>*>& partCacheVec
+			vector<PartitionCacheSortedRuns<Type>*>& partCacheVec
         )
             : bloom(bloom), _modelMini(modelMini), _solids(solids),
 			  _repart(repart), _currentThreadIndex(-1),
@@ -151,7 +151,7 @@ struct FunctorKmersExtensionMinimizer
 
                 /** We retrieve the partition of interest. Note that we have a lazy accessor for the thread index
                  * within the ThreadGroup, because this value wouldn't be known during the constructor of the functor. */
-                PartitionCache<Type>* partition = _partCacheVec[getThreadIndex()];
+                PartitionCacheSortedRuns<Type>* partition = _partCacheVec[getThreadIndex()];
 
                 /** We add the neighbor to the correct debloom partition. */
                 (*partition)[mm].insert (neighbor);
@@ -187,7 +187,7 @@ struct FunctorKmersExtensionMinimizer
         Partition<Type>*    extentParts,
         vector<Type>&       solids,
         Repartitor&         repart,
-		vector<PartitionCache<Type>*>& partCacheVec
+		vector<PartitionCacheSortedRuns<Type>*>& partCacheVec
     )
         : functorNeighbors(bloom,modelMini, solids, extentParts, repart, partCacheVec),  model(model),  bloom(bloom)
     {
@@ -238,41 +238,41 @@ struct FinalizeCmd : public ICommand, public SmartPointer
         Iterator<Type>*  itCFP   = cfp.iterator();   LOCAL(itCFP);
         for (itCFP->first(); !itCFP->isDone(); itCFP->next())  { vecCFP[k++] = itCFP->item(); }
 
-        /** We sort this cfp vector. */
-        std::sort (vecCFP.begin(), vecCFP.end());
+        /** The cfp vector is made of sorted runs (see PartitionCacheSortedRuns), so we don't sort
+         * it: we merge its runs while iterating it. */
+        SortedRunsIterator<Type> itVecCFP (vecCFP);
 
         /** We need two iterators on the two sets (supposed to be ordered). */
-        typename vector<Type>::iterator itVecCFP;
         Iterator<Count>* itKmers = solids.iterator();   LOCAL(itKmers);
 
         /** We initialize the two iterators. */
-        itVecCFP = vecCFP.begin();
+        itVecCFP.first();
         itKmers->first();
 
         /** We compute the difference between the cfp and the solid kmers.
          *  (see http://www.cplusplus.com/reference/algorithm/set_difference)
          */
-        while (itVecCFP != vecCFP.end() && !itKmers->isDone())
+        while (!itVecCFP.isDone() && !itKmers->isDone())
         {
-            if (*itVecCFP < itKmers->item().value)
+            if (itVecCFP.item() < itKmers->item().value)
             {
-                result.insert (*itVecCFP);
+                result.insert (itVecCFP.item());
 
-                Type tmp = *itVecCFP;  while (++itVecCFP != vecCFP.end() && *(itVecCFP)==tmp) { }
+                Type tmp = itVecCFP.item();  do { itVecCFP.next(); } while (!itVecCFP.isDone() && itVecCFP.item()==tmp);
             }
-            else if (itKmers->item().value < *itVecCFP)
+            else if (itKmers->item().value < itVecCFP.item())
             {
                 itKmers->next();
             }
             else
             {
-                Type tmp = *itVecCFP;  while (++itVecCFP != vecCFP.end()  && *(itVecCFP)==tmp) { }
+                Type tmp = itVecCFP.item();  do { itVecCFP.next(); } while (!itVecCFP.isDone() && itVecCFP.item()==tmp);
                 itKmers->next();
             }
         }
 
         /** We complete the remaining potential cFP items. */
-        for ( ;  itVecCFP != vecCFP.end(); ++itVecCFP)  {  result.insert (*itVecCFP);  }
+        for ( ;  !itVecCFP.isDone(); itVecCFP.next())  {  result.insert (itVecCFP.item());  }
     }
 };
 
@@ -333,10 +333,10 @@ void DebloomMinimizerAlgorithm<span>::execute_aux (
     	/** We create a vector of PartitionCache available for the process of all solid kmers partition.
     	 *  We have one item per thread.
     	 */
-    	vector<PartitionCache<Type>*> partCacheVec (this->getDispatcher()->getExecutionUnitsNumber());
+    	vector<PartitionCacheSortedRuns<Type>*> partCacheVec (this->getDispatcher()->getExecutionUnitsNumber());
     	for (size_t i=0; i<this->getDispatcher()->getExecutionUnitsNumber(); i++)
     	{
-    		partCacheVec[i] = new PartitionCache<Type> (*debloomParts,1<<12,0);
+    		partCacheVec[i] = new PartitionCacheSortedRuns<Type> (*debloomParts,1<<12,0);
     	}
 
         TIME_INFO (this->getTimeInfo(), "fill_debloom_file");
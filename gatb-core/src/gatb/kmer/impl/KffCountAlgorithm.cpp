@@ -0,0 +1,276 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/kmer/impl/KffCountAlgorithm.hpp>
+#include <gatb/kmer/impl/PartiInfo.hpp>
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
+#include <gatb/tools/collections/impl/BagCache.hpp>
+#include <gatb/tools/misc/impl/Progress.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
+#include <gatb/tools/misc/api/StringsRepository.hpp>
+
+#include <algorithm>
+#include <limits>
+
+// We use the required packages
+using namespace std;
+
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+using namespace gatb::core::bank;
+using namespace gatb::core::bank::impl;
+
+using namespace gatb::core::tools::dp;
+using namespace gatb::core::tools::dp::impl;
+
+using namespace gatb::core::tools::misc;
+using namespace gatb::core::tools::misc::impl;
+
+using namespace gatb::core::tools::collections;
+using namespace gatb::core::tools::collections::impl;
+
+using namespace gatb::core::tools::storage::impl;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb  {  namespace core  {   namespace kmer  {   namespace impl {
+/********************************************************************************/
+
+static const char* progressFormatKff1 = "DSK: read kmers from KFF file          ";
+static const char* progressFormatKff2 = "DSK: sort kmers partitions             ";
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+KffCountAlgorithm<span>::KffCountAlgorithm (
+    BankKff*             bank,
+    Group&               group,
+    Group&               minimizersGroup,
+    const Configuration& config,
+    IProperties*         options
+)
+    :  Algorithm("dsk", config._nbCores, options), _bank(bank), _group(group), _minimizersGroup(minimizersGroup),
+       _config(config), _solidCounts(0)
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+KffCountAlgorithm<span>::~KffCountAlgorithm ()
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : Functor dispatching the kmers of the KFF blocks into the partitions
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : one copy per thread; the copies share the synchronizers of the partition cache.
+*********************************************************************/
+template<typename ModelMini, typename Count>
+struct FunctorFillPartitions
+{
+    ModelMini&              _model;
+    Repartitor&             _repart;
+    size_t                  _nbPasses;
+    size_t                  _nbPartsPerPass;
+    bool                    _withData;
+    PartitionCache<Count>   _partition;
+    IteratorListener*       _progress;
+    u_int64_t               _nbKmers;
+
+    FunctorFillPartitions (ModelMini& model, Repartitor& repart, size_t nbPartsPerPass, bool withData,
+                           Partition<Count>& partition, IteratorListener* progress)
+        : _model(model), _repart(repart), _nbPasses(repart.getNbPasses()), _nbPartsPerPass(nbPartsPerPass),
+          _withData(withData), _partition(partition, 1<<12, 0), _progress(progress), _nbKmers(0)
+    {
+    }
+
+    FunctorFillPartitions (const FunctorFillPartitions& f)
+        : _model(f._model), _repart(f._repart), _nbPasses(f._nbPasses), _nbPartsPerPass(f._nbPartsPerPass),
+          _withData(f._withData), _partition(f._partition), _progress(f._progress), _nbKmers(0)
+    {
+    }
+
+    ~FunctorFillPartitions ()  {  _progress->inc (_nbKmers);  }
+
+    void operator() (BankKff::Iterator& it)
+    {
+        static const u_int64_t maxAbundance = std::numeric_limits<CountNumber>::max();
+
+        _model.iterate (it.item().getData(), [&] (const typename ModelMini::Kmer& kmer, size_t idx)
+        {
+            /** We get the partition of the kmer as in SortingCountAlgorithm: from the repartition
+             * of the minimizers, shifted according to the pass of the minimizer. */
+            u_int64_t mini = kmer.minimizer().value().getVal();
+            size_t    p    = _repart (mini) + (mini % _nbPasses) * _nbPartsPerPass;
+
+            CountNumber abundance = _withData ? std::min (it.getKmerData (idx), maxAbundance) : 1;
+
+            _partition[p].insert (Count (kmer.value(), abundance));
+        });
+
+        _nbKmers += it.getNbKmers();
+        if (_nbKmers > 500000)  {  _progress->inc (_nbKmers);  _nbKmers = 0;  }
+    }
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+void KffCountAlgorithm<span>::execute ()
+{
+    size_t kmerSize = _bank->getKmerSize();
+
+    if (kmerSize != _config._kmerSize)
+    {
+        throw Exception ("Kmer size of the KFF file '%s' is %ld, not %ld", _bank->getId().c_str(), kmerSize, _config._kmerSize);
+    }
+
+    /** We retrieve the minimizers distribution computed by RepartitorAlgorithm. */
+    Repartitor repart;
+    repart.load (_minimizersGroup);
+
+    ModelMini model (kmerSize, _config._minim_size,
+        typename Kmer<span>::ComparatorMinimizerFrequencyOrLex(), repart.getMinimizerFrequencies()
+    );
+
+    size_t nbPartsPerPass = _config._nb_partitions;
+    size_t nbPartitions   = _config._nb_partitions * _config._nb_passes;
+
+    /** We create the partition of the solid kmers, as CountProcessorDump does. */
+    _solidCounts = & _group.getPartition<Count> ("solid", nbPartitions);
+    _group.addProperty ("kmer_size", Stringify::format("%ld", kmerSize));
+
+    /** We use a temporary partition for the unsorted kmers. */
+    string tmpStorageName = (getInput()->get(STR_URI_OUTPUT_TMP) ? getInput()->getStr(STR_URI_OUTPUT_TMP) : System::file().getTemporaryDirectory())
+        + "/" + System::file().getTemporaryFilename("kff_partitions");
+    Storage* tmpStorage = StorageFactory(STORAGE_FILE).create (tmpStorageName, true, false);
+    LOCAL (tmpStorage);
+    Partition<Count>& tmpPartitions = (*tmpStorage)().getPartition<Count> ("parts", nbPartitions);
+
+    /*************************************************/
+    /** We dispatch the kmers into the partitions.   */
+    /*************************************************/
+    {
+        TIME_INFO (getTimeInfo(), "fill_partitions");
+
+        /** The progress bar is modified by several threads at the same time. */
+        IteratorListener* progress = new ProgressSynchro (
+            createIteratorListener (_bank->getNbKmers(), progressFormatKff1),
+            System::thread().newSynchronizer()
+        );
+        LOCAL (progress);
+        progress->init ();
+
+        _bank->iterateBlocks (getDispatcher(), FunctorFillPartitions<ModelMini,Count> (
+            model, repart, nbPartsPerPass, _bank->getDataSize() > 0, tmpPartitions, progress
+        ));
+
+        tmpPartitions.flush();
+
+        progress->finish ();
+    }
+
+    /*************************************************/
+    /** We sort the partitions.                      */
+    /*************************************************/
+    {
+        TIME_INFO (getTimeInfo(), "sort_partitions");
+
+        /** The solid kmers are written by several threads at the same time. */
+        ISynchronizer* synchro = System::thread().newSynchronizer();
+        LOCAL (synchro);
+
+        Iterator<int>* itParts = createIterator<int> (new Range<int>::Iterator (0,nbPartitions-1), nbPartitions, progressFormatKff2);
+        LOCAL (itParts);
+
+        Partition<Count>& solidCounts = *_solidCounts;
+
+        getDispatcher()->iterate (itParts, [&] (int p)
+        {
+            vector<Count> kmers (tmpPartitions[p].getNbItems());
+
+            size_t k=0;
+            Iterator<Count>* itKmers = tmpPartitions[p].iterator();   LOCAL (itKmers);
+            for (itKmers->first(); !itKmers->isDone(); itKmers->next())  {  kmers[k++] = itKmers->item();  }
+
+            std::sort (kmers.begin(), kmers.end(), [] (const Count& a, const Count& b)  {  return a.value < b.value;  });
+
+            /** A kmer may be several times in the file (no uniqueness, or no canonicity), so we merge
+             * its occurrences. */
+            BagCache<Count> bag (& solidCounts[p], 1<<12, synchro);
+
+            for (size_t i=0; i<kmers.size(); )
+            {
+                Count     kmer = kmers[i];
+                u_int64_t sum  = 0;
+                for ( ; i<kmers.size() && kmers[i].value == kmer.value; i++)  {  sum += kmers[i].abundance;  }
+
+                kmer.abundance = std::min (sum, (u_int64_t) std::numeric_limits<CountNumber>::max());
+                bag.insert (kmer);
+            }
+
+            bag.flush ();
+        });
+
+        solidCounts.flush();
+    }
+
+    /** We can remove the temporary partition. */
+    tmpStorage->remove();
+
+    /** We gather some statistics. */
+    getInfo()->add (1, "bank");
+    getInfo()->add (2, "bank_uri",          "%s",   _bank->getId().c_str());
+    getInfo()->add (2, "bank_size",         "%lld", _bank->getSize());
+    getInfo()->add (2, "bank_nb_kmers",     "%lld", _bank->getNbKmers());
+    getInfo()->add (1, "partitions");
+    getInfo()->add (2, "nb_partitions",     "%ld",  _solidCounts->size());
+    getInfo()->add (2, "nb_items",          "%ld",  _solidCounts->getNbItems());
+    getInfo()->add (1, getTimeInfo().getProperties("time"));
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,107 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file KffCountAlgorithm.hpp
+ *  \brief Solid kmers read from a KFF file, instead of being counted from reads
+ */
+
+#ifndef _KFF_COUNT_ALGORITHM_HPP_
+#define _KFF_COUNT_ALGORITHM_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/misc/impl/Algorithm.hpp>
+#include <gatb/bank/impl/BankKff.hpp>
+#include <gatb/kmer/impl/Model.hpp>
+#include <gatb/kmer/impl/Configuration.hpp>
+#include <gatb/tools/storage/impl/Storage.hpp>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Solid kmers loaded from a KFF file
+ *
+ * This algorithm is a replacement of SortingCountAlgorithm when the kmers have already been
+ * counted (for instance with the '-kff' option of dbgh5, or with another counter): the kmers of
+ * a BankKff and their counts are written into the 'solid' partition of the 'dsk' group, as
+ * CountProcessorDump would do, so the other steps of the graph creation (Bloom, debloom, MPHF,
+ * BCALM) can be run from it.
+ *
+ * All the kmers of the file are kept: no solidity threshold is applied. The counts are the
+ * data of the kmers in the file (saturated to the max CountNumber value), or 1 if the file has
+ * no data.
+ *
+ * As in SortingCountAlgorithm, a kmer goes in the partition of its minimizer, as given by the
+ * Repartitor computed by RepartitorAlgorithm; the kmers of each partition are sorted.
+ *
+ * The file is read by several threads, each one reading its own sections of the file.
+ */
+template<size_t span=KMER_DEFAULT_SPAN>
+class KffCountAlgorithm : public gatb::core::tools::misc::impl::Algorithm
+{
+public:
+
+    /** Shortcuts. */
+    typedef typename kmer::impl::Kmer<span>::Type                                           Type;
+    typedef typename kmer::impl::Kmer<span>::Count                                          Count;
+    typedef typename kmer::impl::Kmer<span>::template ModelMinimizer<typename kmer::impl::Kmer<span>::ModelCanonical> ModelMini;
+
+    /** Constructor.
+     * \param[in] bank : the KFF file holding the kmers
+     * \param[in] group : group where the 'solid' partition is created (usually 'dsk')
+     * \param[in] minimizersGroup : group holding the minimizers repartition
+     * \param[in] config : configuration (kmer and minimizer sizes, passes and partitions numbers)
+     * \param[in] options : extra options */
+    KffCountAlgorithm (
+        bank::impl::BankKff*            bank,
+        tools::storage::impl::Group&    group,
+        tools::storage::impl::Group&    minimizersGroup,
+        const Configuration&            config,
+        tools::misc::IProperties*       options = 0
+    );
+
+    /** Destructor. */
+    ~KffCountAlgorithm ();
+
+    /** \copydoc tools::misc::impl::Algorithm::execute */
+    void execute ();
+
+    /** Get the partition of the solid kmers.
+     * \return the partition. */
+    tools::storage::impl::Partition<Count>* getSolidCounts ()  { return _solidCounts; }
+
+private:
+
+    bank::impl::BankKff*            _bank;
+    tools::storage::impl::Group&    _group;
+    tools::storage::impl::Group&    _minimizersGroup;
+    Configuration                   _config;
+
+    tools::storage::impl::Partition<Count>* _solidCounts;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _KFF_COUNT_ALGORITHM_HPP_ */
@@ -21,6 +21,7 @@
 #include <gatb/system/impl/System.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
 #include <gatb/tools/misc/impl/TimeInfo.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
 
 #include <iostream>
 #include <limits>
@@ -110,8 +111,17 @@ MPHFAlgorithm<span,Abundance_t,NodeState_t>::MPHFAlgorithm (
             _abundanceMap->load (_group, _name);
         }
 
-        /** We populate the abundance hash table. */
-        populate ();
+        /** We load the abundance values if they have been saved with the hash function (otherwise we
+         * have to populate the abundance hash table from the solid kmers). */
+        if (_group.getProperty (getValuesName()).empty() == false)
+        {
+            TIME_INFO (getTimeInfo(), "load_values");
+            _abundanceMap->loadData (_group, getValuesName());
+        }
+        else
+        {
+            populate ();
+        }
 
         /** init a clean node state map */
         initNodeStates ();
@@ -178,6 +188,12 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::execute ()
 
         /** We populate the hash table. */
         populate ();
+
+        /** We save the abundance values too, so that loading the map won't need to populate it again. */
+        {   TIME_INFO (getTimeInfo(), "save_values");
+            size_t valuesSize = _abundanceMap->saveData (_group, getValuesName());
+            _group.setProperty (getValuesName(), Stringify::format ("%ld", valuesSize));
+        }
         
         /** init a clean node state map */
         initNodeStates ();
@@ -132,6 +132,10 @@ public:
     NodeStateMap* getNodeStateMap () const  { return _nodeStateMap; }
     NodeStateMap* getAdjacencyMap () const  { return _adjacencyMap; }
 
+    /** Get the name of the collection holding the abundance values of the map, next to the MPHF.
+     * \return the collection name. */
+    std::string getValuesName () const  { return _name + "_abundance"; }
+
 private:
 
     tools::storage::impl::Group& _group;
@@ -80,8 +80,8 @@ namespace impl      {
  *      - 'Model' : provides many services for managing kmers
  *      - 'Count' : roughly speaking, this a kmer value with an associated abundance
  *
- * This structure must be used only with for 4 values (32,64,96,128 for instance, see Model.cpp), otherwise
- * a compilation error occurs (more values could be added in the future).
+ * This structure must be used only with the values of KSIZE_LIST (32,64,96,128 by default, see
+ * src/CMakeLists.txt), otherwise a link error occurs; any number of values can be provided at configuration.
  *
  * A default value of 32 is defined for the template parameter, so writing 'Kmer<>::Model'
  * represents a model that supports kmers of size up to 31 (included).
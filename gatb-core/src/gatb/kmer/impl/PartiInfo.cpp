@@ -19,6 +19,7 @@
 
 #include <gatb/kmer/impl/PartiInfo.hpp>
 #include <algorithm>
+#include <functional>
 
 // We use the required packages
 using namespace std;
@@ -105,6 +106,68 @@ void Repartitor::computeDistrib (const PartiInfo<5>& extern_pInfo)
     }
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : same greedy assignment as computeDistrib (largest bin into
+**           the emptiest partition), only the partitions loads are kept
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+double Repartitor::estimateSkew (const std::vector<u_int64_t>& binLoads, size_t nbPartitions)
+{
+    if (nbPartitions <= 1)  { return 1.0; }
+
+    std::vector<u_int64_t> bins;
+    u_int64_t total = 0;
+    for (size_t ii=0; ii<binLoads.size(); ii++)
+    {
+        if (binLoads[ii] > 0)  {  bins.push_back (binLoads[ii]);  total += binLoads[ii];  }
+    }
+    if (total == 0)  { return 1.0; }
+
+    std::sort (bins.begin(), bins.end(), std::greater<u_int64_t>());
+
+    /** min-heap of the partitions loads */
+    std::priority_queue<u_int64_t, std::vector<u_int64_t>, std::greater<u_int64_t> > pq;
+    for (size_t jj=0; jj<nbPartitions; jj++)  {  pq.push (0);  }
+
+    u_int64_t maxLoad = 0;
+    for (size_t ii=0; ii<bins.size(); ii++)
+    {
+        u_int64_t load = pq.top() + bins[ii];  pq.pop();
+        pq.push (load);
+        maxLoad = std::max (maxLoad, load);
+    }
+
+    return (double)maxLoad * nbPartitions / (double)total;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+double Repartitor::getSkew (const PartiInfo<5>& extern_pInfo) const
+{
+    std::vector<u_int64_t> partLoads (_nbpart, 0);
+    u_int64_t total = 0;
+
+    for (u_int64_t ii=0; ii<_repart_table.size(); ii++)
+    {
+        partLoads[_repart_table[ii]] += extern_pInfo.getNbKxmer_per_minim(ii);
+        total                        += extern_pInfo.getNbKxmer_per_minim(ii);
+    }
+
+    if (total == 0)  { return 1.0; }
+
+    return (double) *std::max_element (partLoads.begin(), partLoads.end()) * _nbpart / (double)total;
+}
+
 // simple version of the code above in the case where we use frequency-based minimizers, and we just want to group minimizers according to their ordering
 void Repartitor::justGroupNaive (const PartiInfo<5>& extern_pInfo, std::vector <std::pair<int,int> > &counts)
 {
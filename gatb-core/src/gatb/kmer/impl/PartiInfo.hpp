@@ -317,6 +317,20 @@ public:
     void justGroup      (const PartiInfo<5>& pInfo,  std::vector <std::pair<int,int> > &counts);
     void justGroupLexi  (const PartiInfo<5>& extern_pInfo);
 
+    /** Estimate the imbalance of the partitions that computeDistrib would build from the given
+     * minimizers bins loads, ie. the ratio between the largest partition and the mean partition.
+     * Used for sizing the partitions before the repartition table is built.
+     * \param[in] binLoads : load (number of kxmers for instance) of each minimizer bin
+     * \param[in] nbPartitions : number of partitions
+     * \return the max/mean ratio of the partitions loads (1 means perfect balance) */
+    static double estimateSkew (const std::vector<u_int64_t>& binLoads, size_t nbPartitions);
+
+    /** Get the imbalance of the partitions of the current repartition table, ie. the ratio
+     * between the largest partition and the mean partition (in kxmers of the given sample).
+     * \param[in] pInfo : information about the distribution of the minimizers.
+     * \return the max/mean ratio of the partitions loads */
+    double getSkew (const PartiInfo<5>& pInfo) const;
+
     /** Returns the hash value for the given minimizer value.
      * \param[in] minimizerValue : minimizer value as an integer.
      * \return hash value for the given minimizer. */
@@ -417,13 +417,14 @@ void PartitionsByHashCommand<span>:: execute ()
 
 		
 		unsigned int nb_bytes_read;
-		while(this->_superKstorage->readBlock(&_buffer, &_buffer_size, &nb_bytes_read, _fileId))
+		const unsigned char * _block;
+		while(this->_superKstorage->readBlock(&_block, &_buffer, &_buffer_size, &nb_bytes_read, _fileId))
 		{
-			unsigned char * ptr = _buffer;
+			const unsigned char * ptr = _block;
 			u_int8_t nbK; //number of kmers in the superkmer
 			u_int8_t newbyte=0;
 			
-			while(ptr < (_buffer+nb_bytes_read)) //decode whole block
+			while(ptr < (_block+nb_bytes_read)) //decode whole block
 			{
 				//decode a superkmer
 				nbK = *ptr; ptr++;
@@ -944,15 +945,16 @@ public:
 	void execute ()
 	{
 		unsigned int nb_bytes_read;
-		while(_superKstorage->readBlock(&_buffer, &_buffer_size, &nb_bytes_read, _fileId))
+		const unsigned char * block;
+		while(_superKstorage->readBlock(&block, &_buffer, &_buffer_size, &nb_bytes_read, _fileId))
 		{
-			//decode block and iterate through its superkmers
-			unsigned char * ptr = _buffer;
+			//decode block and iterate through its superkmers (read in place if the file is memory mapped)
+			const unsigned char * ptr = block;
 			u_int8_t nbK; //number of kmers in the superkmer
 			int nbsuperkmer_read =0;
 			u_int8_t newbyte=0;
 			
-			while(ptr < (_buffer+nb_bytes_read)) //decode whole block
+			while(ptr < (block+nb_bytes_read)) //decode whole block
 			{
 				//decode a superkmer
 				nbK = *ptr; ptr++;
@@ -1392,9 +1394,11 @@ class SortCommand : public gatb::core::tools::dp::ICommand, public system::Smart
 public:
     typedef typename Kmer<span>::Type  Type;
 
-    /** Constructor. */
-    SortCommand (Type** kmervec, bank::BankIdType** bankIdMatrix, int begin, int end, uint64_t* radix_sizes)
-        : _deb(begin), _fin(end), _radix_kmers(kmervec), _bankIdMatrix(bankIdMatrix), _radix_sizes(radix_sizes) {}
+    /** Constructor.
+     * \param[in] buckets : indexes of the radix buckets to be sorted, shared by the threads
+     * \param[in] next : index of the next bucket to be sorted, shared by the threads */
+    SortCommand (Type** kmervec, bank::BankIdType** bankIdMatrix, uint64_t* radix_sizes, const vector<int>& buckets, size_t* next)
+        : _buckets(buckets), _next(next), _radix_kmers(kmervec), _bankIdMatrix(bankIdMatrix), _radix_sizes(radix_sizes) {}
 
     /** */
     void execute ()
@@ -1402,8 +1406,11 @@ public:
         vector<size_t> idx;
         vector<Tmp>    tmp;
 
-        for (int ii=_deb; ii <=_fin; ii++)
+        /** Each thread takes the next bucket as soon as it is idle. */
+        for (size_t b; (b = __sync_fetch_and_add (_next, 1)) < _buckets.size(); )
         {
+            int ii = _buckets[b];
+
             if (_radix_sizes[ii] > 0)
             {
                 /** Shortcuts. */
@@ -1455,8 +1462,8 @@ private :
         bool operator() (size_t a, size_t b)  { return _kmers[a] < _kmers[b]; }
     };
 
-    int        _deb;
-    int        _fin;
+    const vector<int>& _buckets;
+    size_t*    _next;
     Type**     _radix_kmers;
     bank::BankIdType** _bankIdMatrix;
     uint64_t*  _radix_sizes;
@@ -1464,43 +1471,58 @@ private :
 
 /*********************************************************************
 ** METHOD  :
-** PURPOSE :
+** PURPOSE : Sort the radix buckets (of all the kxmer sizes) of a partition with several threads
 ** INPUT   :
 ** OUTPUT  :
 ** RETURN  :
-** REMARKS :
+** REMARKS : The buckets are taken largest first by the threads as soon as they are idle. The
+**           radix distribution is often skewed (eg. poly-A), so splitting the radix range evenly
+**           between the threads left most of them idle while one sorted the biggest buckets.
 *********************************************************************/
 template<size_t span>
-void PartitionsByVectorCommand<span>::executeSort ()
+void sortRadixBuckets (
+    IDispatcher* dispatcher, size_t nbCores, typename Kmer<span>::Type** radix_kmers, bank::BankIdType** bankIdMatrix,
+    uint64_t* radix_sizes, size_t nbBuckets
+)
 {
-    TIME_INFO (this->_timeInfo, "2.sort");
+    vector<int> buckets;
+    for (size_t b=0; b<nbBuckets; b++)  {  if (radix_sizes[b] > 1)  { buckets.push_back (b); }  }
 
-    vector<ICommand*> cmds;
+    struct Cmp
+    {
+        uint64_t* _sizes;
+        Cmp (uint64_t* sizes) : _sizes(sizes) {}
+        bool operator() (int a, int b) const { return _sizes[a] > _sizes[b]; }
+    };
+    std::sort (buckets.begin(), buckets.end(), Cmp(radix_sizes));
 
-    int nwork = 256 / this->_nbCores;
+    if (buckets.empty())  { return; }
 
-    for (size_t xx=0; xx < (KX+1); xx++)
+    size_t next = 0;
+
+    vector<ICommand*> cmds;
+    for (size_t tid=0; tid < std::min (nbCores, buckets.size()); tid++)
     {
-        cmds.clear();
+        cmds.push_back (new SortCommand<span> (radix_kmers, bankIdMatrix, radix_sizes, buckets, &next));
+    }
 
-        //fill cmd work vector
-        for (size_t tid=0; tid < this->_nbCores; tid++)
-        {
-            int deb = 0 + tid * nwork;
-            int fin = (tid+1) * nwork -1; // thread will do inclusive range [begin -- end ]
-            if(tid == this->_nbCores-1)  { fin = 255; }
-
-            // mettre dans le  SortCommand le master radix_kmers et range a traiter
-            cmds.push_back (new SortCommand<span> (
-                _radix_kmers+ IX(xx,0),
-                (_bankIdMatrix ? _bankIdMatrix+ IX(xx,0) : 0),
-                deb, fin,
-                _radix_sizes + IX(xx,0)
-            ));
-        }
+    dispatcher->dispatchCommands (cmds, 0);
+}
 
-        _dispatcher->dispatchCommands (cmds, 0);
-    }
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+void PartitionsByVectorCommand<span>::executeSort ()
+{
+    TIME_INFO (this->_timeInfo, "2.sort");
+
+    sortRadixBuckets<span> (_dispatcher, this->_nbCores, _radix_kmers, _bankIdMatrix, _radix_sizes, 256*(KX+1));
 }
 
 /*********************************************************************
@@ -2001,32 +2023,7 @@ void PartitionsByVectorCommand_multibank<span>::executeSort ()
 {
 	TIME_INFO (this->_timeInfo, "2.sort");
 	
-	vector<ICommand*> cmds;
-	
-	int nwork = 256 / this->_nbCores;
-	
-	for (size_t xx=0; xx < (KX+1); xx++)
-	{
-		cmds.clear();
-		
-		//fill cmd work vector
-		for (size_t tid=0; tid < this->_nbCores; tid++)
-		{
-			int deb = 0 + tid * nwork;
-			int fin = (tid+1) * nwork -1; // thread will do inclusive range [begin -- end ]
-			if(tid == this->_nbCores-1)  { fin = 255; }
-			
-			// mettre dans le  SortCommand le master radix_kmers et range a traiter
-			cmds.push_back (new SortCommand<span> (
-			_radix_kmers+ IX(xx,0),
-			(_bankIdMatrix ? _bankIdMatrix+ IX(xx,0) : 0),
-			deb, fin,
-			_radix_sizes + IX(xx,0)
-												   ));
-		}
-		
-		_dispatcher->dispatchCommands (cmds, 0);
-	}
+	sortRadixBuckets<span> (_dispatcher, this->_nbCores, _radix_kmers, _bankIdMatrix, _radix_sizes, 256*(KX+1));
 }
 
 template<size_t span>
@@ -88,6 +88,10 @@ static const char* progressFormat0 = "DSK: Collecting stats on %s ";
 
 /********************************************************************************/
 
+/* This functor class counts the mmers of the sequences. Each instance (ie. each thread of
+ * the dispatcher) counts in its own table, which is added to the shared counts when the
+ * instance is destroyed, ie. at the end of the iteration.
+ */
 template<size_t span>
 class MmersFrequency
 {
@@ -95,61 +99,53 @@ public:
     /** Shortcut. */
     typedef typename RepartitorAlgorithm<span>::ModelCanonical ModelCanonical;
     typedef typename ModelCanonical::Kmer                       KmerTypeCanonical;
-    typedef typename RepartitorAlgorithm<span>::ModelDirect    ModelDirect;
-    typedef typename ModelDirect::Kmer                       KmerTypeDirect;
 
     void operator() (Sequence& sequence)
     {
-        /** We first check whether we got mmers from the sequence or not. */
-        if (_minimodel.build (sequence.getData(), _mmers) == false)  { return; }
-
-        /** We loop over the mmers of the sequence. */
-        for (size_t i=0; i<_mmers.size(); i++)
-        {
-            if (_mmers[i].isValid() == false)
-                continue;
-
-            /** increment m-mer count */
-            _m_mer_counts[_mmers[i].value().getVal()] ++;
-        }
+        if (_localCounts.empty())  {  _localCounts.resize (_m_mer_counts.size(), 0);  }
 
-        if (_nbProcessedMmers > 500000)   {  _progress.inc (_nbProcessedMmers);  _nbProcessedMmers = 0;  }
-
-        // see if we need to stop. 
-        // mimics SampleRepart below. but actually, as TruncatedIterator would have worked too, since all seqs are at least larger than a mmer. oh well. using CancellableIterator anyway.
-        _nbSeqsSeenSoFar ++;
-        if (_nbSeqsSeenSoFar > _nbSeqsToSee)
+        /** We loop over the mmers of the sequence and increment their counts. */
+        _minimodel.iterate (sequence.getData(), [&] (const KmerTypeCanonical& mmer, size_t idx)
         {
-            *_cancelIterator = true;
-        }
+            if (mmer.isValid())  {  _localCounts[mmer.value().getVal()] ++;  }
+        });
 
+        _nbSeqs ++;
     }
 
     /** Constructor. */
-    MmersFrequency (int mmerSize,  IteratorListener* progress,  uint32_t* m_mer_counts, size_t nbSeqsToSee /* for when to stop estimation*/, bool* cancelIterator)
-    :
-        _minimodel(mmerSize), _progress (progress,System::thread().newSynchronizer()),
-      _m_mer_counts(m_mer_counts),  _nbProcessedMmers(0), _nbSeqsToSee(nbSeqsToSee), _nbSeqsSeenSoFar(0), _cancelIterator(cancelIterator)
+    MmersFrequency (int mmerSize, vector<u_int64_t>& m_mer_counts, u_int64_t& nbSeqsSeen, ISynchronizer* synchro)
+        : _minimodel(mmerSize), _m_mer_counts(m_mer_counts), _nbSeqsSeen(nbSeqsSeen), _nbSeqs(0), _synchro(synchro)  {}
+
+    /** Destructor. */
+    ~MmersFrequency ()
     {
-        u_int64_t nbminim = (uint64_t)pow(4.0,mmerSize);
+        if (_nbSeqs == 0)  { return; }
 
-        for (u_int64_t i = 0; i < nbminim; i++)  {   _m_mer_counts[i] = 0;  }
+        LocalSynchronizer ls (_synchro);
+
+        for (size_t i=0; i<_localCounts.size(); i++)  {  _m_mer_counts[i] += _localCounts[i];  }
+        _nbSeqsSeen += _nbSeqs;
     }
 
 protected:
 
-    ModelCanonical           _minimodel;
-    //ModelDirect                _minimodel;
-    vector<KmerTypeCanonical>  _mmers;
-    //vector<KmerTypeDirect>  _mmers;
-    ProgressSynchro         _progress;
-    uint32_t*               _m_mer_counts;
-    size_t                  _nbProcessedMmers;
-    size_t        _nbSeqsToSee;
-    size_t        _nbSeqsSeenSoFar;
-    bool *            _cancelIterator;
+    ModelCanonical      _minimodel;
+    vector<u_int32_t>   _localCounts;
+    vector<u_int64_t>&  _m_mer_counts;
+    u_int64_t&          _nbSeqsSeen;
+    u_int64_t           _nbSeqs;
+    ISynchronizer*      _synchro;
 };
 
+/* Mean displacement of the mmers between two rankings, relative to the number of mmers. */
+static double getRankingDistance (const vector<u_int32_t>& ranks1, const vector<u_int32_t>& ranks2)
+{
+    double sum = 0;
+    for (size_t i=0; i<ranks1.size(); i++)  {  sum += ranks1[i] > ranks2[i] ? ranks1[i]-ranks2[i] : ranks2[i]-ranks1[i];  }
+    return sum / ((double)ranks1.size() * (double)ranks1.size());
+}
+
 /********************************************************************************/
 /* This functor class takes a Sequence as input, splits it into super kmers and
  * get information about the distribution of minimizers.
@@ -318,43 +314,83 @@ void RepartitorAlgorithm<span>::computeFrequencies (Repartitor& repartitor)
 
     _bank->estimate (estimateSeqNb, estimateSeqTotalSize, estimateSeqMaxSize);
 
+    /** We never look at more sequences than min(5%, 50M). */
     u_int64_t nbseq_sample = std::min ( u_int64_t (estimateSeqNb * 0.05) ,u_int64_t( 50000000ULL) ) ;
-    // TODO would be better to just stop estimating minimizer frequency when it becomes stable. not after a fixed number of reads
 
     if (nbseq_sample == 0)
         nbseq_sample = 1;
 
+    /** But we read the sample by rounds, taking a share of each round from each file of the bank,
+     * and we stop as soon as the ranking of the mmers is stable between two rounds. */
+    static const double rankingDistanceMax = 0.001;
+
+    u_int64_t nbseq_round = std::max (nbseq_sample / 50, (u_int64_t)100000);
+
     u_int64_t rg = ((u_int64_t)1 << (2*_config._minim_size));
     //cout << "\nAllocating " << ((rg*sizeof(uint32_t))/1024) << " KB for " << _minim_size <<"-mers frequency counting (" << rg << " elements total)" << endl;
-    uint32_t *m_mer_counts = new uint32_t[rg];
+    vector<u_int64_t> m_mer_counts (rg, 0);
 
-    Model model (_config._kmerSize, _config._minim_size);
+    vector<u_int32_t> ranks (rg), previous_ranks;
+    vector<pair<u_int64_t,u_int32_t> > order (rg);
 
     Iterator<Sequence>* bank_it = _bank->iterator();
     LOCAL(bank_it);
-    CancellableIterator<Sequence>* cancellable_it = new CancellableIterator<Sequence> (*bank_it);
-    LOCAL(cancellable_it);
-
-    /** We create a sequence iterator and give it a progress message */
-    Iterator<Sequence>* it_all_reads = createIterator<Sequence> (
-            cancellable_it,
-            _bank->getNbItems(),
-             "Approximating frequencies of minimizers"
-            );
-    LOCAL (it_all_reads);
-
-    /** We compute an estimation of minimizers frequencies from a part of the bank. */
-    
-    SerialDispatcher serialDispatcher;
-    serialDispatcher.iterate (it_all_reads,  MmersFrequency<span> (
-        _config._minim_size, 0 /*_progress*/, m_mer_counts, 
-        nbseq_sample,
-        &(cancellable_it->_cancel))// will be set to true when iteration needs to be stopped
-    );
-
-    // single threaded, for debugging
-    /*MmersFrequency<span> mmersfrequency(model, _progress, bstatsDummy, m_mer_counts);
-    it_sample->iterate(mmersfrequency);*/
+
+    std::vector<Iterator<Sequence>*> itBanks = bank_it->getComposition();
+    for (size_t i=0; i<itBanks.size(); i++)  {  itBanks[i]->first();  }
+
+    ISynchronizer* synchro = System::thread().newSynchronizer();
+    LOCAL (synchro);
+
+    u_int64_t nbseq_seen = 0;
+    size_t    nbRounds   = 0;
+    double    distance   = 1.0;
+
+    while (nbseq_seen < nbseq_sample)
+    {
+        u_int64_t nbseq_before = nbseq_seen;
+        u_int64_t nbseq_file   = std::max ((u_int64_t)1, std::min (nbseq_round, nbseq_sample - nbseq_seen) / itBanks.size());
+
+        for (size_t i=0; i<itBanks.size(); i++)
+        {
+            if (itBanks[i]->isDone())  { continue; }
+
+            /** We go on from the current position of the file. */
+            TruncateIterator<Sequence>* it = new TruncateIterator<Sequence> (*itBanks[i], nbseq_file, false);
+            LOCAL (it);
+
+            getDispatcher()->iterate (it, MmersFrequency<span> (_config._minim_size, m_mer_counts, nbseq_seen, synchro));
+        }
+
+        /** All the files have been read. */
+        if (nbseq_seen == nbseq_before)  { break; }
+
+        nbRounds ++;
+
+        /** We rank the mmers by frequency and compare with the previous round. */
+        for (u_int64_t i=0; i<rg; i++)  {  order[i] = make_pair (m_mer_counts[i], i);  }
+        sort (order.begin(), order.end());
+        for (u_int64_t i=0; i<rg; i++)  {  ranks[order[i].second] = i;  }
+
+        if (previous_ranks.empty() == false)
+        {
+            distance = getRankingDistance (ranks, previous_ranks);
+
+            DEBUG (("RepartitorAlgorithm<span>::computeFrequencies  round %ld  nbseq %ld  distance %f\n", nbRounds, nbseq_seen, distance));
+
+            if (distance < rankingDistanceMax)  { break; }
+        }
+
+        previous_ranks.swap (ranks);
+        ranks.resize (rg);
+    }
+
+    for (size_t i=0; i<itBanks.size(); i++)  {  itBanks[i]->finalize();  }
+
+    getInfo()->add (1, "frequencies");
+    getInfo()->add (2, "nb_sequences",     "%ld", nbseq_seen);
+    getInfo()->add (2, "nb_rounds",        "%ld", nbRounds);
+    if (nbRounds > 1)  {  getInfo()->add (2, "ranking_distance", "%f",  distance);  }
 
     /* sort frequencies */
     for (u_int64_t i(0); i < rg; i++)
@@ -362,7 +398,6 @@ void RepartitorAlgorithm<span>::computeFrequencies (Repartitor& repartitor)
         if (m_mer_counts[i] > 0)
             _counts.push_back(make_pair(m_mer_counts[i],i));
     }
-    delete[] m_mer_counts;
 
     sort (_counts.begin(), _counts.end());
 
@@ -487,6 +522,10 @@ void RepartitorAlgorithm<span>::computeRepartition (Repartitor& repartitor)
         }
     }
 
+    /** We keep the imbalance of the partitions, to be compared to the one used by the configuration. */
+    getInfo()->add (1, "partitions_skew",         "%.3f", repartitor.getSkew (sample_info));
+    if (_config._sketchSeqNb > 0)  {  getInfo()->add (1, "partitions_skew_planned", "%.3f", _config._sketchSkew);  }
+
     /** We save the distribution (may be useful for debloom for instance). */
     repartitor.save (getGroup());
 }
@@ -32,6 +32,8 @@
 #include <gatb/bank/impl/Bank.hpp>
 #include <gatb/tools/collections/impl/IterableHelpers.hpp>
 #include <cmath>
+#include <algorithm>
+#include <functional>
 
 #define DEBUG(a)  //printf a
 
@@ -66,7 +68,7 @@ using namespace gatb::core::kmer::impl;
 //#define PROTO_COMP
 
 #ifdef PROTO_COMP
-    #define PartitionCacheType  PartitionCacheSorted
+    #define PartitionCacheType  PartitionCacheSortedRuns
     #define STORAGE_TYPE  STORAGE_COMPRESSED_FILE
 #else
     #define PartitionCacheType  PartitionCache
@@ -95,7 +97,7 @@ template<size_t span>
 SortingCountAlgorithm<span>::SortingCountAlgorithm (IProperties* params)
   : Algorithm("dsk", -1, params),
     _bank(0), _repartitor(0),
-    _progress (0), _tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0)
+    _progress (0), _tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0), _readsCache(0)
 {
 }
 
@@ -111,7 +113,7 @@ template<size_t span>
 SortingCountAlgorithm<span>::SortingCountAlgorithm (IBank* bank, IProperties* params)
   : Algorithm("dsk", -1, params),
     _bank(0), _repartitor(0),
-    _progress (0),_tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0)
+    _progress (0),_tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0), _readsCache(0)
 {
     setBank (bank);
 }
@@ -135,7 +137,7 @@ SortingCountAlgorithm<span>::SortingCountAlgorithm (
 )
   : Algorithm("dsk", config._nbCores, params),
     _config(config), _bank(0), _repartitor(0),
-    _progress (0),_tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0)
+    _progress (0),_tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0), _readsCache(0)
 {
     setBank       (bank);
     setRepartitor (repartitor);
@@ -160,6 +162,7 @@ SortingCountAlgorithm<span>::~SortingCountAlgorithm ()
  //   setPartitionsStorage    (0);
  //   setPartitions           (0);
     setStorage              (0);
+    setReadsCache           (0);
 
     for (size_t i=0; i<_processors.size(); i++)  { _processors[i]->forget(); }
 }
@@ -220,7 +223,7 @@ IOptionsParser* SortingCountAlgorithm<span>::getOptionsParser (bool mandatory)
     parser->push_back (new OptionOneParam (STR_URI_OUTPUT_DIR,    "output directory",                               false, "."));
     parser->push_back (new OptionOneParam (STR_URI_OUTPUT_TMP,    "output directory for temporary files",           false, "."));
     parser->push_back (new OptionOneParam (STR_COMPRESS_LEVEL,    "h5 compression level (0:none, 9:best)",          false, "0"));
-    parser->push_back (new OptionOneParam (STR_STORAGE_TYPE,      "storage type of kmer counts ('hdf5' or 'file')", false, "hdf5"  ));
+    parser->push_back (new OptionOneParam (STR_STORAGE_TYPE,      "storage type of kmer counts ('hdf5', 'file' or 'mmap')", false, "hdf5"  ));
 	parser->push_back (new OptionOneParam (STR_HISTO2D,"compute the 2D histogram (with first file = genome, remaining files = reads)",false,"0"));
 	parser->push_back (new OptionOneParam (STR_HISTO,"output the kmer abundance histogram",false,"0"));
 	parser->push_back (new OptionNoParam  (STR_KFF,"also output kmers in kff format",false));
@@ -230,6 +233,9 @@ IOptionsParser* SortingCountAlgorithm<span>::getOptionsParser (bool mandatory)
     devParser->push_back (new OptionOneParam (STR_MINIMIZER_TYPE,    "minimizer type (0=lexi, 1=freq)",                false, "0"));
     devParser->push_back (new OptionOneParam (STR_MINIMIZER_SIZE,    "size of a minimizer",                            false, "10"));
     devParser->push_back (new OptionOneParam (STR_REPARTITION_TYPE,  "minimizer repartition (0=unordered, 1=ordered)", false, "0"));
+    devParser->push_back (new OptionOneParam (STR_CONFIG_SAMPLE,     "nb reads sampled for planning passes/partitions (0=no sampling)", false, "100000"));
+    devParser->push_back (new OptionNoParam  (STR_PIPELINE_PASSES,   "fill the partitions of a pass while counting the previous one (needs the temporary disk space of two passes)", false));
+    devParser->push_back (new OptionNoParam  (STR_CACHE_READS,       "with several passes, cache the reads in 2-bit format during the first pass and read the cache in the next passes (needs a temporary disk space of about a quarter of the nucleotides)", false));
     parser->push_back (devParser);
 
     return parser;
@@ -394,7 +400,9 @@ ICountProcessor<span>* SortingCountAlgorithm<span>::getDefaultProcessor (
         params->get(STR_KFF) ? new CountProcessorDumpKff<span> (
             kff_prefix,
             dskStorage->getGroup("dsk"),
-            params->getInt(STR_KMER_SIZE)
+            params->getInt(STR_KMER_SIZE),
+            params->get(STR_MINIMIZER_SIZE) ? params->getInt(STR_MINIMIZER_SIZE) : 10,
+            params->get(STR_NB_CORES) ? params->getInt(STR_NB_CORES) : 0
         ) : NULL,
         NULL
     );
@@ -554,6 +562,8 @@ void SortingCountAlgorithm<span>::configure ()
         {
             if (storage_type == "file")
                 _storage_type = tools::storage::impl::STORAGE_FILE;
+            else if (storage_type == "mmap")
+                _storage_type = tools::storage::impl::STORAGE_MMAP;
             else
             {std::cout << "Error: unknown storage type specified: " << storage_type << std::endl; exit(1); }
         }
@@ -674,8 +684,22 @@ void SortingCountAlgorithm<span>::execute ()
     /*************************************************************/
     /*                         MAIN LOOP                         */
     /*************************************************************/
+    /** With several passes, the reads may be cached during the first pass, so the next passes don't parse
+     * the input again; this is possible only with the superkmers partitions. */
+    if (getInput()->get(STR_CACHE_READS) != 0  &&  _config._nb_passes > 1  &&  _config._solidityKind == KMER_SOLIDITY_SUM)
+    {
+        setReadsCache (new BankBinaryIndexed (
+            getInput()->getStr(STR_URI_OUTPUT_TMP) + "/" + System::file().getTemporaryFilename("reads_cache")
+        ));
+    }
+
+    /** The passes may be pipelined, which is possible only with the superkmers partitions. */
+    bool pipelined = getInput()->get(STR_PIPELINE_PASSES) != 0  &&  _config._nb_passes > 1  &&  _config._solidityKind == KMER_SOLIDITY_SUM;
+
+    if (pipelined)  {  executePipelined (itSeq, pInfo);  }
+
     /** We loop N times the bank. For each pass, we will consider a subset of the whole kmers set of the bank. */
-    for (size_t current_pass=0; current_pass < _config._nb_passes; current_pass++)
+    else for (size_t current_pass=0; current_pass < _config._nb_passes; current_pass++)
     {
         DEBUG (("SortingCountAlgorithm<span>::execute  pass [%ld,%d] \n", current_pass+1, _config._nb_passes));
 
@@ -719,6 +743,15 @@ void SortingCountAlgorithm<span>::execute ()
 		delete _superKstorage; //delete files and containing dir
 		_superKstorage =0;
 	}
+
+    /** We remove the reads cache. */
+    u_int64_t readsCacheSize = 0;
+    if (_readsCache != 0)
+    {
+        readsCacheSize = _readsCache->getSize();
+        _readsCache->remove ();
+        setReadsCache (0);
+    }
 	
     /*************************************************************/
     /*                         STATISTICS                        */
@@ -763,6 +796,7 @@ void SortingCountAlgorithm<span>::execute ()
 		getInfo()->add (3, "tmp_file_smallest_(MB)","%lld",smallesttmp/1024LL/1024LL);
 		getInfo()->add (3, "tmp_file_mean_(MB)","%.1f",meantmp/1024LL/1024LL);
 	}
+    if (readsCacheSize > 0)  {  getInfo()->add (3, "reads_cache_(MB)","%.1f",readsCacheSize/1024.0/1024.0);  }
     /** We dump information about count processors. */
     if (_processors.size()==1)  {  getInfo()->add (2, _processors[0]->getProperties()); }
     else
@@ -780,6 +814,141 @@ void SortingCountAlgorithm<span>::execute ()
     getInfo()->add (1, getTimeInfo().getProperties("time"));
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : Loop over the passes, filling the partitions of pass N+1 while counting the partitions of pass N
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : Without pipelining, the counting threads are idle while the sequences are read and split,
+**           and the input is idle while the partitions are counted. Here the two stages overlap:
+**             - the filling stage gets a quarter of the cores (at least one), since it is mostly
+**               bound by the input; the counting stage keeps its configuration.
+**             - the superkmers caches of the filling threads are taken from the memory of the counting.
+**             - the superkmers files of two passes exist at the same time on disk.
+*********************************************************************/
+template<size_t span>
+void SortingCountAlgorithm<span>::executePipelined (Iterator<Sequence>* itSeq, PartiInfo<5>& pInfo)
+{
+    size_t    nbCoresFill = std::max ((size_t)1, _config._nbCores / 4);
+    u_int64_t memoryFill  = (u_int64_t)_config._nb_cached_items_per_core_per_part * _config._nb_partitions * nbCoresFill * sizeof(Type) / MBYTE + 1;
+
+    /** We share the memory budget between the two stages (the counting keeping at least half of it). */
+    u_int64_t maxMemory = _config._max_memory;
+    _config._max_memory = std::max (maxMemory > memoryFill ? maxMemory - memoryFill : 0, maxMemory / 2);
+
+    IDispatcher* fillDispatcher = new Dispatcher (nbCoresFill);
+    LOCAL (fillDispatcher);
+
+    /** A stage of a pass, which remembers when it ran. */
+    struct StageCmd : public ICommand, public system::SmartPointer
+    {
+        SortingCountAlgorithm& algo;  Iterator<Sequence>* itSeq;  PartiInfo<5>& pInfo;  size_t pass;
+        SuperKmerBinFiles** superKstorage;  IDispatcher* dispatcher;
+        ITime::Value t0, t1;
+
+        /** Counting stage if no storage is given, filling stage otherwise. */
+        StageCmd (SortingCountAlgorithm& algo, Iterator<Sequence>* itSeq, PartiInfo<5>& pInfo, size_t pass,
+                  SuperKmerBinFiles** superKstorage=0, IDispatcher* dispatcher=0)
+            : algo(algo), itSeq(itSeq), pInfo(pInfo), pass(pass), superKstorage(superKstorage), dispatcher(dispatcher), t0(0), t1(0)  {}
+
+        void execute ()
+        {
+            t0 = System::time().getTimeStamp();
+            if (superKstorage != 0)  {  pInfo.clear();  algo.fillSuperKmers (pass, itSeq, pInfo, *superKstorage, dispatcher);  }
+            else                     {  algo.fillSolidKmers (pass, pInfo);  }
+            t1 = System::time().getTimeStamp();
+        }
+
+        ITime::Value getDuration () const { return t1 - t0; }
+    };
+
+    /** Partitions information of the pass being counted and of the pass being filled. */
+    PartiInfo<5>  pInfoNext (_config._nb_partitions, _config._minim_size);
+    PartiInfo<5>* infos[2] = { &pInfo, &pInfoNext };
+
+    SuperKmerBinFiles* superKstorageNext = 0;
+
+    ITime::Value timeFill = 0, timeCount = 0, timeOverlap = 0;
+    ITime::Value t0 = System::time().getTimeStamp();
+
+    /** The first pass can't be overlapped, so it is filled with all the cores. */
+    {
+        TIME_INFO (getTimeInfo(), "fill_partitions");
+
+        _nbKmersPerPartitionPerBank.clear();
+        _progress->setMessage (Stringify::format(progressFormat1, 1, _config._nb_passes));
+        _progress->init();
+
+        pInfo.clear();
+        fillSuperKmers (0, itSeq, pInfo, _superKstorage, getDispatcher());
+        timeFill += System::time().getTimeStamp() - t0;
+    }
+
+    for (size_t pass=0; pass < _config._nb_passes; pass++)
+    {
+        DEBUG (("SortingCountAlgorithm<span>::executePipelined  pass [%ld,%d] \n", pass+1, _config._nb_passes));
+
+        PartiInfo<5>& pInfoCurrent   = *infos[pass%2];
+        PartiInfo<5>& pInfoFollowing = *infos[(pass+1)%2];
+
+        vector<ICommand*> cmds;
+
+        StageCmd* count = new StageCmd (*this, itSeq, pInfoCurrent, pass);
+        count->use();
+        cmds.push_back (count);
+
+        StageCmd* fill = 0;
+        if (pass+1 < _config._nb_passes)
+        {
+            fill = new StageCmd (*this, itSeq, pInfoFollowing, pass+1, &superKstorageNext, fillDispatcher);
+            fill->use();
+            cmds.push_back (fill);
+        }
+
+        /** We run the counting of the current pass and the filling of the next one. */
+        Dispatcher(cmds.size()).dispatchCommands (cmds, 0);
+
+        timeCount += count->getDuration();
+        if (fill != 0)
+        {
+            timeFill    += fill->getDuration();
+            ITime::Value begin = std::max (count->t0, fill->t0);
+            ITime::Value end   = std::min (count->t1, fill->t1);
+            if (end > begin)  { timeOverlap += end - begin; }
+        }
+
+        count->forget();
+        if (fill != 0)  { fill->forget(); }
+
+        /** The partitions of the current pass are not needed anymore. */
+        if (fill != 0)
+        {
+            delete _superKstorage;
+            _superKstorage    = superKstorageNext;
+            superKstorageNext = 0;
+        }
+    }
+
+    /** The caller expects the partitions information of the last pass. */
+    if (infos[(_config._nb_passes-1)%2] != &pInfo)  {  pInfo.clear();  pInfo.add_sync (pInfoNext);  }
+
+    _config._max_memory = maxMemory;
+
+    ITime::Value timeWall = System::time().getTimeStamp() - t0;
+
+    /** We gather the stages statistics, showing how much they overlapped. */
+    getInfo()->add (1, "pipeline");
+    getInfo()->add (2, "nb_cores_fill",        "%ld",   nbCoresFill);
+    getInfo()->add (2, "memory_fill",          "%lld",  memoryFill);
+    getInfo()->add (2, "time_wall",            "%.3f",  timeWall    / 1000.0);
+    getInfo()->add (2, "time_fill",            "%.3f",  timeFill    / 1000.0);
+    getInfo()->add (2, "time_count",           "%.3f",  timeCount   / 1000.0);
+    getInfo()->add (2, "time_overlap",         "%.3f",  timeOverlap / 1000.0);
+    getInfo()->add (2, "utilization_fill",     "%.1f",  timeWall > 0 ? 100.0 * timeFill  / timeWall : 0.0);
+    getInfo()->add (2, "utilization_count",    "%.1f",  timeWall > 0 ? 100.0 * timeCount / timeWall : 0.0);
+}
+
 /********************************************************************************/
 /* This functor class takes a Sequence as input, splits it into super kmers and
  * serialize them into partitions.
@@ -1199,6 +1368,29 @@ private:
 		Type getHeavyWeight (const Type& kmer) const  {  return (kmer & this->_mask_radix) >> ((this->_kmersize - 4)*2);  }
 	};
 	
+/* This functor fills the partitions as FillPartitions<span,true> and writes the sequences into the
+ * reads cache; each clone of the functor has its own cache writer. */
+template<size_t span>
+class FillPartitionsCache : public FillPartitions<span, true>
+{
+public:
+
+    /** Constructor. */
+    FillPartitionsCache (const FillPartitions<span, true>& fill, BankBinaryIndexed& readsCache)
+        : FillPartitions<span, true> (fill), _writer (readsCache)  {}
+
+    /** */
+    void operator() (Sequence& sequence)
+    {
+        _writer.insert (sequence);
+        FillPartitions<span, true>::operator() (sequence);
+    }
+
+private:
+
+    BankBinaryIndexed::Writer _writer;
+};
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -1228,60 +1420,24 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 			setPartitions        (0); // close the partitions first, otherwise new files are opened before  closing parti from previous pass
 			setPartitions        ( & (*_tmpPartitionsStorage)().getPartition<Type> ("parts", _config._nb_partitions));
 			
-		}
-		else
-		{
-			/** We build the temporary storage name from the output storage name. */
-			_tmpStorageName_superK = getInput()->getStr(STR_URI_OUTPUT_TMP) + "/" + System::file().getTemporaryFilename("superK_partitions");
-			
-			
-			if(_superKstorage!=0)
-			{
-				delete _superKstorage;
-				_superKstorage =0;
-			}
-			
-			_superKstorage = new SuperKmerBinFiles(_tmpStorageName_superK,"superKparts", _config._nb_partitions) ;
-			
 		}
 		/** We update the message of the progress bar. */
 		_progress->setMessage (Stringify::format(progressFormat1, pass+1, _config._nb_passes));
 		
-		/** We create a kmer model; using the frequency order if we're in that mode */
-		uint32_t* freq_order = NULL;
-		
-		/** We may have to retrieve the minimizers frequencies computed in the RepartitorAlgorithm. */
-		if (_config._minimizerType == 1)  {  freq_order = _repartitor->getMinimizerFrequencies ();  }
-		
-		Model model( _config._kmerSize, _config._minim_size, typename kmer::impl::Kmer<span>::ComparatorMinimizerFrequencyOrLex(), freq_order);
-		
 		/** We have to reinit the progress instance since it may have been used by SampleRepart before. */
 		_progress->init();
 		
 		if (_config._solidityKind == KMER_SOLIDITY_SUM) {
-			/** We launch the iteration of the sequences iterator with the created
-			 * functors. */
-
-			size_t groupSize = 1000;
-			bool deleteSynchro = true;
+			fillSuperKmers (pass, itSeq, pInfo, _superKstorage, getDispatcher());
+		} else {
+			/** We create a kmer model; using the frequency order if we're in that mode */
+			uint32_t* freq_order = NULL;
 
-			/** We fill the partitions. Each thread will read synchronously and will
-			 * call FillPartitions in a synchronous way (in order to have global
-			 * BanksStats correctly computed). */
-			getDispatcher()->iterate(
-				itSeq,
-				FillPartitions<span, true>(
-				    model, _config._nb_passes, pass, _config._nb_partitions,
-				    _config._nb_cached_items_per_core_per_part, _progress, _bankStats,
-				    _tmpPartitions, *_repartitor, pInfo, _superKstorage),
-				groupSize, deleteSynchro);
+			/** We may have to retrieve the minimizers frequencies computed in the RepartitorAlgorithm. */
+			if (_config._minimizerType == 1)  {  freq_order = _repartitor->getMinimizerFrequencies ();  }
 
-			// GR: close the input bank here with call to finalize
-			itSeq->finalize();
+			Model model( _config._kmerSize, _config._minim_size, typename kmer::impl::Kmer<span>::ComparatorMinimizerFrequencyOrLex(), freq_order);
 
-			_superKstorage->flushFiles();
-			_superKstorage->closeFiles();
-		} else {
 			/** We may have several input banks instead of a single one. */
 			std::vector<Iterator<Sequence>*> itBanks =  itSeq->getComposition();
 
@@ -1352,21 +1508,126 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 ** REMARKS :
 *********************************************************************/
 template<size_t span>
-std::vector<size_t> SortingCountAlgorithm<span>::getNbCoresList (PartiInfo<5>& pInfo)
+void SortingCountAlgorithm<span>::fillSuperKmers (
+    size_t pass, Iterator<Sequence>* itSeq, PartiInfo<5>& pInfo, SuperKmerBinFiles*& superKstorage, IDispatcher* dispatcher
+)
 {
-    std::vector<size_t> result;
+    /** We build the temporary storage name from the output storage name. Note that the storages of
+     * two passes may exist at the same time (see executePipelined). */
+    string tmpStorageName = getInput()->getStr(STR_URI_OUTPUT_TMP) + "/" + System::file().getTemporaryFilename (
+        Stringify::format ("superK_partitions_%d", pass)
+    );
+
+    if (superKstorage != 0)
+    {
+        delete superKstorage;
+        superKstorage = 0;
+    }
+
+    superKstorage = new SuperKmerBinFiles (tmpStorageName, "superKparts", _config._nb_partitions);
 
-    for (size_t p=0; p<_config._nb_partitions; )
+    /** We create a kmer model; using the frequency order if we're in that mode */
+    uint32_t* freq_order = NULL;
+
+    /** We may have to retrieve the minimizers frequencies computed in the RepartitorAlgorithm. */
+    if (_config._minimizerType == 1)  {  freq_order = _repartitor->getMinimizerFrequencies ();  }
+
+    Model model( _config._kmerSize, _config._minim_size, typename kmer::impl::Kmer<span>::ComparatorMinimizerFrequencyOrLex(), freq_order);
+
+    size_t groupSize = 1000;
+    bool deleteSynchro = true;
+
+    /** The prototype functor is deleted before the superkmers files are flushed. */
     {
-        u_int64_t ram_total = 0;
-        size_t i=0;
-        for (i=0; i< _config._nb_partitions_in_parallel && p<_config._nb_partitions
-            && (ram_total ==0  || ((ram_total+(pInfo.getNbSuperKmer(p)*getSizeofPerItem()))  <= _config._max_memory*MBYTE)) ; i++, p++)
+        FillPartitions<span, true> fill (
+            model, _config._nb_passes, pass, _config._nb_partitions,
+            _config._nb_cached_items_per_core_per_part, _progress, _bankStats,
+            _tmpPartitions, *_repartitor, pInfo, superKstorage
+        );
+
+        if (_readsCache != 0 && pass > 0)
         {
-            ram_total += pInfo.getNbSuperKmer(p)*getSizeofPerItem();
+            /** The next passes read the reads cache, each thread decoding its own blocks. */
+            _readsCache->iterate (dispatcher, fill);
         }
+        else
+        {
+            /** We fill the partitions. Each thread will read synchronously and will
+             * call FillPartitions in a synchronous way (in order to have global
+             * BanksStats correctly computed). */
+            if (_readsCache != 0)  {  dispatcher->iterate (itSeq, FillPartitionsCache<span> (fill, *_readsCache), groupSize, deleteSynchro);  }
+            else                   {  dispatcher->iterate (itSeq, fill, groupSize, deleteSynchro);  }
 
-        result.push_back (i);
+            // GR: close the input bank here with call to finalize
+            itSeq->finalize();
+
+            /** The writers of the reads cache have been flushed when the functors were deleted. */
+            if (_readsCache != 0)  {  _readsCache->flush();  }
+        }
+    }
+
+    superKstorage->flushFiles();
+    superKstorage->closeFiles();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+std::vector<typename SortingCountAlgorithm<span>::PartitionsGroup> SortingCountAlgorithm<span>::getPartitionsSchedule (PartiInfo<5>& pInfo)
+{
+    std::vector<PartitionsGroup> result;
+    std::vector<u_int64_t>       ram_total;
+
+    u_int64_t ram_max = _config._max_memory*MBYTE;
+
+    /** We sort the partitions by decreasing memory size (the index breaks ties, so the schedule is deterministic). */
+    std::vector<std::pair<u_int64_t,size_t> > sizes;
+    for (size_t p=0; p<_config._nb_partitions; p++)
+    {
+        sizes.push_back (std::make_pair (pInfo.getNbSuperKmer(p)*getSizeofPerItem(), p));
+    }
+    std::sort (sizes.begin(), sizes.end(), std::greater<std::pair<u_int64_t,size_t> >());
+
+    /** First fit decreasing: each partition goes into the first group having room for it. A partition
+     * bigger than the budget gets its own group. */
+    for (size_t i=0; i<sizes.size(); i++)
+    {
+        size_t g=0;
+        for ( ; g<result.size(); g++)
+        {
+            if (result[g].partitions.size() < _config._nb_partitions_in_parallel && ram_total[g] + sizes[i].first <= ram_max)  { break; }
+        }
+
+        if (g == result.size())  {  result.push_back (PartitionsGroup());  ram_total.push_back (0);  }
+
+        result[g].partitions.push_back (sizes[i].second);
+        ram_total[g] += sizes[i].first;
+    }
+
+    /** Each partition of a group gets one core; the remaining cores are shared according to the partitions
+     * size, the rounding leftovers going to the biggest ones (ie. the first ones of the group). */
+    for (size_t g=0; g<result.size(); g++)
+    {
+        std::vector<size_t>& parts = result[g].partitions;
+        std::vector<size_t>& cores = result[g].nbCores;
+
+        size_t extra = _config._nbCores > parts.size() ? _config._nbCores - parts.size() : 0;
+        size_t given = 0;
+
+        for (size_t j=0; j<parts.size(); j++)
+        {
+            u_int64_t ram = pInfo.getNbSuperKmer(parts[j])*getSizeofPerItem();
+            size_t    nb  = ram_total[g]>0 ? (size_t) ((double)extra * ram / ram_total[g]) : 0;
+            cores.push_back (1 + nb);
+            given += nb;
+        }
+        for (size_t j=0; given<extra; j=(j+1)%parts.size(), given++)  {  cores[j]++;  }
     }
 
     return result;
@@ -1414,24 +1675,23 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
     _progress->setMessage (Stringify::format (progressFormat2, pass+1, _config._nb_passes));
 
 
-    /** We retrieve the list of cores number for dispatching N partitions in N threads.
-     *  We need to know these numbers for allocating the N maps according to the maximum allowed memory.
+    /** We retrieve the groups of partitions to be counted simultaneously, biggest partitions first.
+     *  We need to know these groups for allocating the N maps according to the maximum allowed memory.
      */
-    vector<size_t> coreList = getNbCoresList(pInfo); //uses _nb_partitions_in_parallel
+    vector<PartitionsGroup> schedule = getPartitionsSchedule(pInfo); //uses _nb_partitions_in_parallel
 
     /** We need a memory allocator. We give the cores number in order to compute an extra memory
      * allocation for alignment constraints. */
     MemAllocator pool (_config._nbCores);
 
-    size_t p = 0;
-    for (size_t i=0; i<coreList.size(); i++)
+    for (size_t i=0; i<schedule.size(); i++)
     {
         vector<ICommand*> cmds;
 
         /** We use a vector to hold all the current CountProcessor clones. */
         vector<CountProcessor*> clones;
 
-        size_t currentNbCores = coreList[i];
+        size_t currentNbCores = schedule[i].partitions.size();
         assert (currentNbCores > 0);
 
         /** We correct the number of memory per map according to the max allowed memory.
@@ -1453,8 +1713,11 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
         ));
 
         /** We build a list of 'currentNbCores' commands to be dispatched each one in one thread. */
-        for (size_t j=0; j<currentNbCores; j++, p++)
+        for (size_t j=0; j<currentNbCores; j++)
         {
+            size_t p       = schedule[i].partitions[j];
+            size_t nbCores = schedule[i].nbCores[j];
+
             ISynchronizer* synchro = System::thread().newSynchronizer();
             LOCAL (synchro);
 
@@ -1479,16 +1742,15 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
             ICommand* cmd = 0;
 
             //still use hash if by vector would be too large even with single part at a time
-			//I thought it was not possible to have memoryPartition > _max_memory  && currentNbCores>1 , but inf fact it is possible when
-			// some partitions are of size 0 (see getNbCoresList)
-			if ( ((memoryPartition > mem && currentNbCores==1) || ( memoryPartition > (_config._max_memory*MBYTE) ) )  && !forceVector)
+			// (such a partition is alone in its group, see getPartitionsSchedule)
+			if ( memoryPartition > (_config._max_memory*MBYTE)  && !forceVector)
             {
                 if (pool.getCapacity() != 0)  {  pool.reserve(0);  }
 
 
 					cmd = new PartitionsByHashCommand<span>   (
 															   processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, mem,_superKstorage
+															   pInfo, pass, p, nbCores, _config._kmerSize, pool, mem,_superKstorage
 															   );
             }
             else
@@ -1564,14 +1826,14 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
 				{
 					cmd = new PartitionsByVectorCommand<span> (
 															   processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, nbItemsPerBankPerPart,_superKstorage
+															   pInfo, pass, p, nbCores, _config._kmerSize, pool, nbItemsPerBankPerPart,_superKstorage
 															   );
 				}
 				else
 				{
 					cmd = new PartitionsByVectorCommand_multibank<span> (
 															   (*_tmpPartitions)[p], processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, nbItemsPerBankPerPart
+															   pInfo, pass, p, nbCores, _config._kmerSize, pool, nbItemsPerBankPerPart
 															   );
 				}
 
@@ -1583,6 +1845,12 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
 
         DEBUG (("\n"));
 
+        /** The superkmers partitions of the next group are read ahead by the OS while the current ones are sorted. */
+        if (_config._solidityKind == KMER_SOLIDITY_SUM && i+1 < schedule.size())
+        {
+            for (size_t j=0; j<schedule[i+1].partitions.size(); j++)  {  _superKstorage->prefetchFile (schedule[i+1].partitions[j]);  }
+        }
+
         /** We launch the commands through a dispatcher. */
         getDispatcher()->dispatchCommands (cmds, 0);
 
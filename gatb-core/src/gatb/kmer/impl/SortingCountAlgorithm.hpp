@@ -30,6 +30,7 @@
 
 #include <gatb/tools/misc/impl/Algorithm.hpp>
 #include <gatb/bank/api/IBank.hpp>
+#include <gatb/bank/impl/BankBinaryIndexed.hpp>
 #include <gatb/kmer/api/ICountProcessor.hpp>
 #include <gatb/kmer/impl/Model.hpp>
 #include <gatb/kmer/impl/BankKmers.hpp>
@@ -202,6 +203,24 @@ private:
      */
     void fillPartitions (size_t pass, gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>* itSeq, PartiInfo<5>& pInfo);
 
+    /** Fill the superkmers partition files (for a given pass) from a sequence iterator.
+     * \param[in] pass  : current pass
+     * \param[in] itSeq : sequences iterator whose sequence are cut into superkmers to be split.
+     * \param[in] pInfo : partitions information to be filled
+     * \param[in] superKstorage : storage of the superkmers, replaced by the one of the current pass
+     * \param[in] dispatcher : dispatcher of the filling threads
+     * With a reads cache (see STR_CACHE_READS), the first pass fills the cache and the next ones read it instead of itSeq.
+     */
+    void fillSuperKmers (size_t pass, gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>* itSeq, PartiInfo<5>& pInfo,
+        tools::storage::impl::SuperKmerBinFiles*& superKstorage, gatb::core::tools::dp::IDispatcher* dispatcher);
+
+    /** Loop over the passes, the partitions of a pass being filled while the partitions of the
+     * previous pass are counted (see STR_PIPELINE_PASSES).
+     * \param[in] itSeq : sequences iterator
+     * \param[in] pInfo : partitions information, of the last pass at the end
+     */
+    void executePipelined (gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>* itSeq, PartiInfo<5>& pInfo);
+
     /** Fill the solid kmers bag from the partition files (one partition after another one).
      * \param[in] solidKmers : bag to put the solid kmers into.
      */
@@ -212,8 +231,20 @@ private:
      */
     void fillSolidKmers_aux (ICountProcessor<span>* processor, size_t pass, PartiInfo<5>& pInfo);
 
-    /** */
-    std::vector <size_t> getNbCoresList (PartiInfo<5>& pInfo);
+    /** Group of partitions counted simultaneously, with the number of cores given to each one. */
+    struct PartitionsGroup
+    {
+        std::vector<size_t> partitions;
+        std::vector<size_t> nbCores;
+    };
+
+    /** Compute the order in which the partitions are counted. The partitions are taken largest
+     * first and packed into groups fitting the memory budget; the cores are shared between the
+     * partitions of a group according to their size, so a big partition alone in its group
+     * is sorted with all the cores.
+     * \param[in] pInfo : information about the partitions of the current pass
+     * \return the groups of partitions to be counted one after another. */
+    std::vector <PartitionsGroup> getPartitionsSchedule (PartiInfo<5>& pInfo);
 
     /** Handle on the configuration information. */
     kmer::impl::Configuration _config;
@@ -259,7 +290,10 @@ private:
 	
 	//superkmer efficient storage
 	tools::storage::impl::SuperKmerBinFiles* _superKstorage;
-	std::string _tmpStorageName_superK;
+
+    /** Cache of the reads, filled during the first pass and read by the next ones (0 if not used). */
+    gatb::core::bank::impl::BankBinaryIndexed* _readsCache;
+    void setReadsCache (gatb::core::bank::impl::BankBinaryIndexed* readsCache)  { SP_SETATTR(readsCache); }
 };
 
 /********************************************************************************/
@@ -108,6 +108,14 @@ public:
      * \return number of  items successfully written */
     virtual size_t fwrite (const void* ptr, size_t size, size_t nmemb) = 0;
 
+    /** Writes a buffer at a given position of the file, without moving the cursor (similar to 'pwrite'
+     * function). Several threads may write concurrently at disjoint positions.
+     * \param[in] ptr : the buffer to be written
+     * \param[in] size : size of the buffer (in bytes)
+     * \param[in] offset : position in the file where to write the buffer
+     * \return number of bytes successfully written */
+    virtual size_t pwrite (const void* ptr, size_t size, u_int64_t offset) = 0;
+
     /** Flush the file.
      */
     virtual void flush () = 0;
@@ -121,6 +129,24 @@ public:
      * \return the URI of the file */
     virtual const std::string& getPath () const = 0;
 
+    /** Map the whole file into memory. The mapping is private: the mapped content may be modified
+     * in memory (pages are copied on write), the file itself is never modified. The mapping is kept
+     * until 'unmap' is called or the file is deleted; calling 'map' several times returns the same mapping.
+     * \param[in] sequential : tells the OS that the content will be accessed sequentially
+     * \return the address of the mapped content, 0 if the file can't be mapped (empty file for instance) */
+    virtual u_int8_t* map (bool sequential=true) = 0;
+
+    /** Get the size of the mapped content.
+     * \return the mapped bytes number, 0 if the file is not mapped */
+    virtual u_int64_t getMapSize () const = 0;
+
+    /** Tell the OS that the whole (mapped) content will be needed soon, so it can be read ahead
+     * asynchronously. Does nothing if the file is not mapped. */
+    virtual void willNeed () = 0;
+
+    /** Unmap the file (see 'map'). */
+    virtual void unmap () = 0;
+
     /** Destructor. */
     virtual ~IFile () {}
 };
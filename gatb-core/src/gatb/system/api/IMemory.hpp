@@ -51,6 +51,9 @@ const u_int64_t  MBYTE = (1ULL << 20);
 /** Constant of 2^30 for GByte */
 const u_int64_t  GBYTE = (1ULL << 30);
 
+/** Size of the huge pages requested by IMemoryAllocator::callocHuge */
+const u_int64_t  HUGE_PAGE_SIZE = 2*MBYTE;
+
 /********************************************************************************/
 
 /** \brief Interface providing methods for dynamic allocation.
@@ -81,6 +84,21 @@ public:
     /** See free documentation. */
     virtual void  free    (void *ptr) = 0;
 
+    /** Allocate a block whose address is a multiple of the given alignment. The block
+     * has to be released with free and can't be reallocated.
+     * \param[in] size : size of the block
+     * \param[in] alignment : alignment of the block, a power of 2
+     * \return the allocated block. */
+    virtual void* memalign (BlockSize_t size, BlockSize_t alignment) = 0;
+
+    /** Allocate a zeroed block, backed by huge pages when the system allows it (otherwise
+     * regular pages are used). The block is page aligned, has to be released with free and
+     * can't be reallocated. This is meant for big arrays randomly accessed (Bloom filters,
+     * hash tables...), where huge pages save many TLB misses.
+     * \param[in] size : size of the block
+     * \return the allocated block. */
+    virtual void* callocHuge (BlockSize_t size) = 0;
+
     /************************************************************/
     /** Destructor. */
     virtual ~IMemoryAllocator () {}
@@ -127,6 +127,84 @@ public:
     /** Create a CpuInfo object
      * \return the created object. */
     virtual CpuInfo* createCpuInfo () = 0;
+
+    /********************************************************************************/
+
+    /** \brief Values of hardware and operating system counters
+     *
+     * Some counters may not be available (for instance, the hardware counters need
+     * perf_event_open, which may be forbidden to the process); only the available ones
+     * are meaningful.
+     */
+    struct Counters
+    {
+        /** Kinds of counters. */
+        enum Kind
+        {
+            INSTRUCTIONS,       /* instructions retired (perf_event_open) */
+            CYCLES,             /* cpu cycles (perf_event_open) */
+            CACHE_MISSES,       /* last level cache misses (perf_event_open) */
+            BRANCH_MISSES,      /* branch mispredictions (perf_event_open) */
+            CPU_USER,           /* user cpu time, in msec (getrusage) */
+            CPU_SYS,            /* system cpu time, in msec (getrusage) */
+            MAJOR_FAULTS,       /* page faults that needed an I/O (getrusage) */
+            CONTEXT_SWITCHES,   /* voluntary and involuntary context switches (getrusage) */
+            BYTES_READ,         /* bytes given by the read system calls (/proc/self/io) */
+            BYTES_WRITTEN,      /* bytes given to the write system calls (/proc/self/io) */
+            DISK_READ,          /* bytes actually read from the storage (/proc/self/io) */
+            DISK_WRITTEN,       /* bytes actually sent to the storage (/proc/self/io) */
+            NB_KINDS
+        };
+
+        /** Constructor. */
+        Counters ()  { reset(); }
+
+        /** Set all the counters as unavailable. */
+        void reset ()  {  for (size_t i=0; i<NB_KINDS; i++)  { values[i] = 0;  available[i] = false; }  }
+
+        /** Add the values of the available counters of another instance. */
+        Counters& operator+= (const Counters& c)
+        {
+            for (size_t i=0; i<NB_KINDS; i++)  {  if (c.available[i])  { values[i] += c.values[i];  available[i] = true; }  }
+            return *this;
+        }
+
+        /** Get the name of a kind of counter (used as a key in properties). */
+        static const char* getName (size_t kind)
+        {
+            static const char* names[] = {
+                "instructions", "cycles", "cache_misses", "branch_misses", "cpu_user", "cpu_sys",
+                "major_faults", "context_switches", "bytes_read", "bytes_written", "disk_read", "disk_written"
+            };
+            return kind < NB_KINDS ? names[kind] : "?";
+        }
+
+        u_int64_t values    [NB_KINDS];
+        bool      available [NB_KINDS];
+    };
+
+    /** \brief Interface providing a way to get counters between two execution points
+     */
+    class CountersInfo : public SmartPointer
+    {
+    public:
+
+        /** Start counting. */
+        virtual void start () = 0;
+
+        /** Stop counting. */
+        virtual void stop () = 0;
+
+        /** Get the counters between start and stop. */
+        virtual const Counters& getCounters () = 0;
+    };
+
+    /** Create a CountersInfo object.
+     * \param[in] thread : if true, only the calling thread is counted; otherwise, the process
+     * is counted (for the hardware counters: the calling thread and the threads it creates
+     * after 'start', once they are finished).
+     * \return the created object. */
+    virtual CountersInfo* createCountersInfo (bool thread) = 0;
 };
 
 /********************************************************************************/
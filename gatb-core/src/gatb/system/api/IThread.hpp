@@ -183,6 +183,12 @@ public:
     /** Return the id of the current process. */
     virtual u_int64_t getProcess () = 0;
 
+    /** Bind the calling thread to one of the cores the process may run on. The cores are
+     * ordered so that consecutive indexes are spread over the NUMA nodes.
+     * \param[in] idx : index of the core (modulo the number of cores)
+     * \return true if the thread could be bound. */
+    virtual bool bindThreadSelf (size_t idx) = 0;
+
     /** Destructor. */
     virtual ~IThreadFactory ()  {}
 };
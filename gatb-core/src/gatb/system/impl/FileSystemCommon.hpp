@@ -34,7 +34,9 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <errno.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <iostream>
 
@@ -57,7 +59,7 @@ public:
     /** Constructor.
      * \param[in] path : full path of the file
      * \param[in] mode : read/write mode (same as fopen function) */
-    CommonFile (const char* path, const char* mode) : _path(path), _handle(0), _isStdout(false)
+    CommonFile (const char* path, const char* mode) : _path(path), _handle(0), _isStdout(false), _mapAddr(0), _mapSize(0)
     {
         _isStdout = path && strcmp(path,"stdout")==0;
         _handle   = _isStdout ? stdout : fopen (path, mode);
@@ -69,7 +71,7 @@ public:
     }
 
     /** Destructor. */
-    virtual ~CommonFile ()  {  if (_handle && !_isStdout)  {  
+    virtual ~CommonFile ()  {  unmap();  if (_handle && !_isStdout)  {  
         //std::cout << "closing file " << _path << " handle " << _handle << std::endl; 
         fclose (_handle);  }  }
 
@@ -131,6 +133,20 @@ public:
         return ::fwrite (ptr, size, nmemb, getHandle());
     }
 
+    /** \copydoc IFile::pwrite */
+    size_t pwrite (const void* ptr, size_t size, u_int64_t offset)
+    {
+        size_t done = 0;
+        while (done < size)
+        {
+            ssize_t nb = ::pwrite (fileno (getHandle()), (const char*)ptr + done, size - done, offset + done);
+            if (nb < 0 && errno == EINTR)  { continue; }
+            if (nb <= 0)  { break; }
+            done += nb;
+        }
+        return done;
+    }
+
     /** \copydoc IFile::flush */
     void flush ()  { if (isOpen())  {  fflush (getHandle()); } }
 
@@ -147,10 +163,44 @@ public:
     /** \copydoc IFile::getPath */
     const std::string& getPath () const  {  return _path;  }
 
+    /** \copydoc IFile::map */
+    u_int8_t* map (bool sequential=true)
+    {
+        if (_mapAddr == 0 && isOpen() && !_isStdout)
+        {
+            struct stat st;
+            if (fstat (fileno (getHandle()), &st) == 0 && st.st_size > 0)
+            {
+                void* addr = mmap (0, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno (getHandle()), 0);
+                if (addr != MAP_FAILED)
+                {
+                    if (sequential)  { madvise (addr, st.st_size, MADV_SEQUENTIAL); }
+                    _mapAddr = (u_int8_t*) addr;
+                    _mapSize = st.st_size;
+                }
+            }
+        }
+        return _mapAddr;
+    }
+
+    /** \copydoc IFile::getMapSize */
+    u_int64_t getMapSize () const  { return _mapSize; }
+
+    /** \copydoc IFile::willNeed */
+    void willNeed ()  {  if (_mapAddr != 0)  {  madvise (_mapAddr, _mapSize, MADV_WILLNEED);  }  }
+
+    /** \copydoc IFile::unmap */
+    void unmap ()
+    {
+        if (_mapAddr != 0)  {  munmap (_mapAddr, _mapSize);  _mapAddr = 0;  _mapSize = 0;  }
+    }
+
 protected:
     std::string _path;
     FILE*       _handle;
     bool        _isStdout;
+    u_int8_t*   _mapAddr;
+    u_int64_t   _mapSize;
 
     FILE* getHandle()
     {
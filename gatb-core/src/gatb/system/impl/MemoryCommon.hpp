@@ -33,6 +33,15 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
 
 /********************************************************************************/
 namespace gatb      {
@@ -83,6 +92,196 @@ public:
      {
          if (ptr != 0)  {  ::free (ptr);  }
      }
+
+     /** \copydoc IMemoryAllocator::memalign */
+     void* memalign (BlockSize_t size, BlockSize_t alignment)
+     {
+         void* res = 0;
+         if (posix_memalign (&res, std::max (alignment, (BlockSize_t)sizeof(void*)), size) != 0)  {  throw Exception ("no memory for memalign"); }
+         return res;
+     }
+
+     /** \copydoc IMemoryAllocator::callocHuge
+      * Big blocks are aligned on huge pages and advised to the transparent huge pages. */
+     void* callocHuge (BlockSize_t size)
+     {
+         if (size < HUGE_PAGE_SIZE)  {  return calloc (1, size);  }
+
+         void* res = memalign (size, HUGE_PAGE_SIZE);
+#ifdef MADV_HUGEPAGE
+         /** A failure (THP disabled) only means that regular pages are used. */
+         madvise (res, size, MADV_HUGEPAGE);
+#endif
+         ::memset (res, 0, size);
+         return res;
+     }
+};
+
+/********************************************************************************/
+
+/** \brief Implementation of IMemoryAllocator interface for big arrays randomly accessed by all threads.
+ *
+ *  The blocks are anonymous memory mappings, so:
+ *      - on a NUMA machine, their pages are interleaved over the NUMA nodes (Linux only), so that
+ *        queries from each socket hit local and remote memory evenly, instead of all the pages
+ *        being on the node of the allocating thread.
+ *      - their pages are already zeroed, so calloc doesn't touch them. If interleaving is not
+ *        possible (eg. not allowed in a container), a page is placed on the node of the first
+ *        thread writing it, which is also much better than having one thread resetting the block.
+ *
+ *  The mapping of a block (start and length) is kept in a header page before it, so this allocator
+ *  should only be used for big blocks (Bloom filters, MPHF values...).
+ *
+ *  callocHuge first tries explicit huge pages (MAP_HUGETLB, only available if the administrator
+ *  reserved some), then maps a block aligned on huge pages and advises it to the transparent huge
+ *  pages, so that the kernel can back it with huge pages if THP is enabled in 'madvise' mode.
+ */
+class MemoryAllocatorNuma : public IMemoryAllocator
+{
+public:
+
+    /** Singleton. */
+    static IMemoryAllocator& singleton()  { static MemoryAllocatorNuma instance; return instance; }
+
+    /** \copydoc IMemoryAllocator::malloc */
+     void* malloc  (BlockSize_t size)
+     {
+         BlockSize_t actualSize = size + getPageSize();
+
+         void* res = mmap (0, actualSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+         if (res == MAP_FAILED)  {  throw Exception ("no memory for malloc"); }
+
+         interleave (res, actualSize);
+
+         return storeMapping ((u_int8_t*)res + getPageSize(), res, actualSize);
+     }
+
+     /** \copydoc IMemoryAllocator::calloc */
+     void* calloc  (size_t nmemb, BlockSize_t size)  {  return malloc (nmemb*size);  }
+
+     /** \copydoc IMemoryAllocator::realloc */
+     void* realloc (void *ptr, BlockSize_t size)
+     {
+         if (ptr == 0)  {  return malloc (size);  }
+
+         u_int8_t*   base   = getBase   (ptr);
+         BlockSize_t length = getLength (ptr);
+
+         void* res = malloc (size);
+         ::memcpy (res, ptr, std::min (length - ((u_int8_t*)ptr - base), size));
+         munmap (base, length);
+         return res;
+     }
+
+     /** \copydoc IMemoryAllocator::free */
+     void  free (void *ptr)
+     {
+         if (ptr != 0)  {  munmap (getBase(ptr), getLength(ptr));  }
+     }
+
+     /** \copydoc IMemoryAllocator::memalign */
+     void* memalign (BlockSize_t size, BlockSize_t alignment)
+     {
+         /** Blocks are already page aligned. */
+         if (alignment <= getPageSize())  {  return malloc (size);  }
+         return mapAligned (size, alignment);
+     }
+
+     /** \copydoc IMemoryAllocator::callocHuge */
+     void* callocHuge (BlockSize_t size)
+     {
+         if (size < HUGE_PAGE_SIZE)  {  return calloc (1, size);  }
+
+#ifdef MAP_HUGETLB
+         /** The header page shares the first huge page with the beginning of the block. */
+         BlockSize_t actualSize = (size + getPageSize() + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+         void* res = mmap (0, actualSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+         if (res != MAP_FAILED)
+         {
+             interleave (res, actualSize);
+             return storeMapping ((u_int8_t*)res + getPageSize(), res, actualSize);
+         }
+#endif
+
+         void* res2 = mapAligned (size, HUGE_PAGE_SIZE);
+#ifdef MADV_HUGEPAGE
+         /** A failure (THP disabled) only means that regular pages are used. */
+         madvise (res2, size, MADV_HUGEPAGE);
+#endif
+         return res2;
+     }
+
+private:
+
+     static size_t getPageSize ()  {  static size_t pageSize = sysconf (_SC_PAGESIZE);  return pageSize;  }
+
+     /** The header of a block holds the start and the length of its mapping. */
+     static void* storeMapping (void* ptr, void* base, BlockSize_t length)
+     {
+         ((BlockSize_t*)ptr)[-2] = (BlockSize_t)(size_t)base;
+         ((BlockSize_t*)ptr)[-1] = length;
+         return ptr;
+     }
+
+     static u_int8_t*   getBase   (void* ptr)  {  return (u_int8_t*)(size_t) ((BlockSize_t*)ptr)[-2];  }
+     static BlockSize_t getLength (void* ptr)  {  return ((BlockSize_t*)ptr)[-1];  }
+
+     /** Map a block with the given alignment (a multiple of the page size); the pages of the
+      * mapping before the header page and after the block are released. */
+     static void* mapAligned (BlockSize_t size, BlockSize_t alignment)
+     {
+         BlockSize_t mapSize = size + getPageSize() + alignment;
+
+         u_int8_t* res = (u_int8_t*) mmap (0, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+         if (res == (u_int8_t*)MAP_FAILED)  {  throw Exception ("no memory for memalign"); }
+
+         u_int8_t*   ptr    = (u_int8_t*) (((size_t)res + getPageSize() + alignment - 1) & ~(size_t)(alignment - 1));
+         u_int8_t*   base   = ptr - getPageSize();
+         BlockSize_t length = (size + getPageSize() + getPageSize() - 1) & ~(BlockSize_t)(getPageSize() - 1);
+
+         if (base > res)                     {  munmap (res, base - res);  }
+         if (base + length < res + mapSize)  {  munmap (base + length, (res + mapSize) - (base + length));  }
+
+         interleave (base, length);
+
+         return storeMapping (ptr, base, length);
+     }
+
+     /** Interleave the pages of a block over the online NUMA nodes; does nothing with only one node. */
+     static void interleave (void* ptr, BlockSize_t size)
+     {
+#ifdef __linux__
+         static unsigned long nodes = getOnlineNodes();
+
+         /** There is no point in interleaving over a single node. */
+         if ((nodes & (nodes-1)) == 0)  { return; }
+
+         /** A failure only means that the pages will be placed on first touch. */
+         syscall (SYS_mbind, ptr, size, MPOL_INTERLEAVE, &nodes, sizeof(nodes)*8 + 1, 0);
+#endif
+     }
+
+     /** Mask of the online NUMA nodes (the 64 first ones), read from a list like "0-1,3". */
+     static unsigned long getOnlineNodes ()
+     {
+         unsigned long mask = 1;
+
+         FILE* file = fopen ("/sys/devices/system/node/online", "r");
+         if (file != 0)
+         {
+             int first=0, last=0;  char sep=0;
+             for (mask=0; fscanf (file, "%d", &first) == 1; )
+             {
+                 last = first;
+                 if ((sep = fgetc (file)) == '-')  {  if (fscanf (file, "%d", &last) != 1)  { break; }  sep = fgetc (file);  }
+                 for (int i=first; i<=last && i<64; i++)  {  mask |= 1UL << i;  }
+                 if (sep != ',')  { break; }
+             }
+             fclose (file);
+         }
+         return mask ? mask : 1;
+     }
 };
 
 /********************************************************************************/
@@ -95,11 +294,13 @@ public:
  * Statistics operations are provided through the IMemory interface. Providing such
  * services implies that we have some management of the allocated blocks. In particular
  * we need to store the size of block which is done by allocating some extra space for
- * each block (this space being used for storing the block size).
+ * each block (this space being used for storing the block size and the offset of the
+ * block in the referred allocation).
  *
  * Note that such an implementation requires a little bit more memory than clients
  * actually ask for: for instance, if a client calls malloc with 100, the final allocated
- * block size will be 100+4=104 bytes (if sizeof(BlockSize_t)==4).
+ * block size will be 100+16=116 bytes (if sizeof(BlockSize_t)==8). Aligned and huge
+ * blocks require a whole alignment (or page) more.
  *
  * It is mandatory that blocks created through this implementation are also deleted by the
  * same implementation.
@@ -118,22 +319,14 @@ public:
      void* malloc  (BlockSize_t size)
      {
          /** We add the size for storing the size of the pointer to be allocated. */
-         BlockSize_t actualSize = size + sizeof(BlockSize_t);
+         BlockSize_t actualSize = size + getHeaderSize();
 
          /** We allocate the block in a classical way. Note the cast due to the fact
           * that we need to do some arithmetic on the pointer. */
          u_int8_t* res = (u_int8_t*) _alloc.malloc (actualSize);
 
-         /** We store the required size. */
-         storeBlockSize (res, actualSize);
-
-         /** We update the statistics information. Note that we force synchronization since
-          * we could have concurrent access on the instance. */
-         __sync_fetch_and_add (&_nbBlocks,      1);
-         __sync_fetch_and_add (&_currentMemory, actualSize);
-
-         /** we return the result. */
-         return res + sizeof(BlockSize_t);
+         /** We store the required size and we return the result. */
+         return storeBlock (res, getHeaderSize(), actualSize);
      }
 
      /** \copydoc IMemoryAllocator::calloc */
@@ -158,32 +351,39 @@ public:
          /** We retrieve the actual block pointer and the previous block size. */
          if (ptr != 0)
          {
-             actualPtr    = (u_int8_t*)ptr - sizeof(BlockSize_t);
-             previousSize = *((BlockSize_t*)actualPtr);
+             if (getBlockOffset(ptr) != getHeaderSize())  {  throw Exception ("can't realloc an aligned block");  }
+
+             actualPtr    = (u_int8_t*)ptr - getHeaderSize();
+             previousSize = getBlockSize (ptr);
          }
 
          /** We add the size for storing the size of the pointer to be allocated. */
-         BlockSize_t actualSize = size + sizeof(BlockSize_t);
+         BlockSize_t actualSize = size + getHeaderSize();
 
          /** We reallocate the actual block. */
          u_int8_t* res = (u_int8_t*)_alloc.realloc (actualPtr, actualSize);
 
          /** We store the required size. */
-         storeBlockSize (res, size);
+         ((BlockSize_t*)res)[0] = getHeaderSize();
+         ((BlockSize_t*)res)[1] = actualSize;
 
          /** We update the statistics information. Note that we force synchronization since
           * we could have concurrent access on the instance. */
-         if (size > previousSize)  // The size of the block is going to increase.
+         if (ptr == 0)  // This is a new block.
+         {
+             __sync_fetch_and_add (&_nbBlocks, 1);
+         }
+         if (actualSize > previousSize)  // The size of the block is going to increase.
          {
-             __sync_fetch_and_add (&_currentMemory, size - previousSize);
+             __sync_fetch_and_add (&_currentMemory, actualSize - previousSize);
          }
          else  // The size of the block is going to decrease.
          {
-             __sync_fetch_and_sub (&_currentMemory, previousSize - size);
+             __sync_fetch_and_sub (&_currentMemory, previousSize - actualSize);
          }
 
          /** We return the result. */
-         return res + sizeof(BlockSize_t);
+         return res + getHeaderSize();
      }
 
      /** \copydoc IMemoryAllocator::free */
@@ -191,14 +391,11 @@ public:
      {
          if (ptr != 0)
          {
-             /** We retrieve the actual block pointer. */
-             u_int8_t* actualPtr = (u_int8_t*)ptr - sizeof(BlockSize_t);
-
              /** We retrieve the block size. */
-             BlockSize_t actualSize = *((BlockSize_t*)actualPtr);
+             BlockSize_t actualSize = getBlockSize (ptr);
 
              /** We release the actual allocated block. */
-             _alloc.free (actualPtr);
+             _alloc.free ((u_int8_t*)ptr - getBlockOffset (ptr));
 
              /** We update the current blocks number. */
              __sync_fetch_and_sub (&_nbBlocks,      1);
@@ -206,6 +403,30 @@ public:
          }
      }
 
+     /** \copydoc IMemoryAllocator::memalign */
+     void* memalign (BlockSize_t size, BlockSize_t alignment)
+     {
+         /** The header takes a whole alignment, so that the block keeps the alignment. */
+         BlockSize_t offset     = std::max (alignment, getHeaderSize());
+         BlockSize_t actualSize = size + offset;
+
+         u_int8_t* res = (u_int8_t*) _alloc.memalign (actualSize, offset);
+
+         return storeBlock (res, offset, actualSize);
+     }
+
+     /** \copydoc IMemoryAllocator::callocHuge */
+     void* callocHuge (BlockSize_t size)
+     {
+         /** The header takes a whole page, so that the block stays page aligned. */
+         static BlockSize_t offset = sysconf (_SC_PAGESIZE);
+         BlockSize_t actualSize = size + offset;
+
+         u_int8_t* res = (u_int8_t*) _alloc.callocHuge (actualSize);
+
+         return storeBlock (res, offset, actualSize);
+     }
+
      /** \copydoc IMemory::getNbBlocks */
      size_t getNbBlocks () { return _nbBlocks; }
 
@@ -223,8 +444,27 @@ protected:
      TotalSize_t _currentMemory;
      TotalSize_t _peakMemory;
 
-     /** */
-     void storeBlockSize (void* ptr, BlockSize_t size)  {  *((BlockSize_t*)ptr) = size;  }
+     /** The header just before a block holds its offset in the referred allocation and its actual size. */
+     static BlockSize_t getHeaderSize ()  {  return 2*sizeof(BlockSize_t);  }
+
+     static BlockSize_t getBlockOffset (void* ptr)  {  return ((BlockSize_t*)ptr)[-2];  }
+     static BlockSize_t getBlockSize   (void* ptr)  {  return ((BlockSize_t*)ptr)[-1];  }
+
+     /** Store the header of a new block and update the statistics. */
+     void* storeBlock (u_int8_t* res, BlockSize_t offset, BlockSize_t actualSize)
+     {
+         u_int8_t* ptr = res + offset;
+
+         ((BlockSize_t*)ptr)[-2] = offset;
+         ((BlockSize_t*)ptr)[-1] = actualSize;
+
+         /** We update the statistics information. Note that we force synchronization since
+          * we could have concurrent access on the instance. */
+         __sync_fetch_and_add (&_nbBlocks,      1);
+         __sync_fetch_and_add (&_currentMemory, actualSize);
+
+         return ptr;
+     }
 };
 
 /********************************************************************************/
@@ -321,10 +561,40 @@ public:
          MemorySizeStore::free (ptr);
      }
 
+     /** \copydoc IMemoryAllocator::memalign */
+     void* memalign (BlockSize_t size, BlockSize_t alignment)
+     {
+         checkLimits ("memalign", size);
+         return MemorySizeStore::memalign (size, alignment);
+     }
+
+     /** \copydoc IMemoryAllocator::callocHuge */
+     void* callocHuge (BlockSize_t size)
+     {
+         checkLimits ("callocHuge", size);
+         return MemorySizeStore::callocHuge (size);
+     }
+
 protected:
 
      BlockSize_t _maxBlockSize;
      TotalSize_t _maxTotalSize;
+
+     /** Check that a request of the given size doesn't exceed the thresholds. */
+     void checkLimits (const char* what, BlockSize_t size)
+     {
+         /** We check that the required block size is not too big. */
+         if (size > _maxBlockSize)
+         {
+             throw Exception ("block size too big for %s: %d required but %d allowed", what, size, _maxBlockSize);
+         }
+
+         /** We check that we don't reach the maximum size allowed. */
+         if (_currentMemory + size >= _maxTotalSize)
+         {
+             throw Exception ("memory maximum reached for %s: required %d, current %d, max %d", what, size, _currentMemory, _maxTotalSize);
+         }
+     }
 };
 
 /********************************************************************************/
@@ -384,6 +654,12 @@ public:
      /** \copydoc IMemoryAllocator::free */
      void  free (void *ptr)                          { _alloc.free (ptr);                   }
 
+     /** \copydoc IMemoryAllocator::memalign */
+     void* memalign (BlockSize_t size, BlockSize_t alignment)  { return _alloc.memalign (size, alignment);  }
+
+     /** \copydoc IMemoryAllocator::callocHuge */
+     void* callocHuge (BlockSize_t size)             { return _alloc.callocHuge (size);     }
+
      /** \copydoc IMemoryOperations::memset */
      void* memset (void* s, int c, size_t n)                 { return _ope.memset (s, c, n);      }
 
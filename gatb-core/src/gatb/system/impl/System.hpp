@@ -133,6 +133,14 @@ class System
 #endif
      }
 
+     /********************************************************************************/
+     /** Access for memory methods dedicated to big arrays randomly accessed by all threads,
+      * whose pages are spread over the NUMA nodes (see MemoryAllocatorNuma). */
+     static IMemory&         memoryNuma  ()
+     {
+        static MemoryCommon instance (MemoryAllocatorNuma::singleton(), MemoryOperationsCommon::singleton());  return instance;
+     }
+
      /********************************************************************************/
      /** Access for thread methods. */
      static IThreadFactory&  thread  ()
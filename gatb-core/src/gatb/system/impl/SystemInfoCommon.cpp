@@ -22,8 +22,12 @@
 
 #include <string.h>
 #include <unistd.h>
+#include <sched.h>
 #include <sys/times.h>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
 
 using namespace std;
 
@@ -95,6 +99,22 @@ private:
 /** */
 ISystemInfo::CpuInfo* SystemInfoCommon::createCpuInfo ()  {  return new CpuInfoCommon (); }
 
+/********************************************************************************/
+/** \brief CountersInfo with no available counter
+ */
+class CountersInfoCommon : public ISystemInfo::CountersInfo
+{
+public:
+    void start ()  {}
+    void stop  ()  {}
+    const ISystemInfo::Counters& getCounters ()  { return _counters; }
+private:
+    ISystemInfo::Counters _counters;
+};
+
+/** */
+ISystemInfo::CountersInfo* SystemInfoCommon::createCountersInfo (bool thread)  {  return new CountersInfoCommon (); }
+
 std::string SystemInfoCommon::getVersion () const  { return STR_LIBRARY_VERSION; }
 
 std::string SystemInfoCommon::getBuildDate () const { return STR_COMPILATION_DATE; }
@@ -122,20 +142,218 @@ std::string SystemInfoCommon::getBuildSystem () const { return STR_OPERATING_SYS
 #include <sys/resource.h>
 #include <sys/times.h>
 
+/********************************************************************************/
+/* Control groups (cgroups) are used by containers (docker, kubernetes...) and job
+ * schedulers (slurm...) for restricting the memory and the CPU time of a process. The
+ * limits of the group of the current process (or of any of its ancestors) may be much
+ * lower than what the machine has, so they have to be taken into account for sizing
+ * memory pools and thread numbers. Both the cgroup v1 and v2 hierarchies are handled.
+ */
+
+/** Directory of the cgroup of the current process for a controller (eg. "memory" or "cpu"),
+ * and the mount point of its hierarchy. We look first for a v1 hierarchy having this controller,
+ * then for the v2 (unified) hierarchy. Returns false if the process has no such cgroup. */
+static bool getCgroupDir (const string& controller, string& dir, string& mountPoint, bool& isV2)
+{
+    string pathV1, pathV2;
+    bool   foundV1 = false, foundV2 = false;
+
+    /** Lines of /proc/self/cgroup are like "4:memory:/path" (v1) or "0::/path" (v2). */
+    ifstream cgroups ("/proc/self/cgroup");
+    for (string line; getline (cgroups, line); )
+    {
+        size_t c1 = line.find (':');   if (c1 == string::npos)  { continue; }
+        size_t c2 = line.find (':', c1+1);   if (c2 == string::npos)  { continue; }
+
+        string controllers = line.substr (c1+1, c2-c1-1);
+        string path        = line.substr (c2+1);
+
+        if (line.compare (0, c1, "0") == 0 && controllers.empty())  { pathV2 = path;  foundV2 = true;  continue; }
+
+        stringstream ss (controllers);
+        for (string item; getline (ss, item, ','); )  {  if (item == controller)  { pathV1 = path;  foundV1 = true; }  }
+    }
+
+    /** Lines of /proc/self/mountinfo are like "36 32 0:32 /root /sys/fs/cgroup/memory rw - cgroup cgroup rw,memory".
+     * The root of the mount is not '/' when the hierarchy is only partially visible (eg. in a container). */
+    ifstream mounts ("/proc/self/mountinfo");
+    for (string line; getline (mounts, line); )
+    {
+        size_t sep = line.find (" - ");  if (sep == string::npos)  { continue; }
+
+        string id, parent, device, root, point, fstype, source, options;
+        stringstream (line.substr (0, sep))  >> id >> parent >> device >> root >> point;
+        stringstream (line.substr (sep+3))   >> fstype >> source >> options;
+
+        bool match = false;
+        string path;
+
+        if (fstype == "cgroup" && foundV1)
+        {
+            stringstream ss (options);
+            for (string item; getline (ss, item, ','); )  {  if (item == controller)  { match = true; }  }
+            path = pathV1;
+        }
+        else if (fstype == "cgroup2" && foundV2 && !foundV1)
+        {
+            match = true;
+            path  = pathV2;
+        }
+
+        if (!match)  { continue; }
+
+        if (root != "/")
+        {
+            /** If the cgroup is out of the visible part of the hierarchy, we use the root of the mount. */
+            if (path.compare (0, root.size(), root) == 0)  { path = path.substr (root.size()); }
+            else                                           { path = "/"; }
+        }
+
+        mountPoint = point;
+        dir        = point + (path == "/" ? string("") : path);
+        isV2       = fstype == "cgroup2";
+        return true;
+    }
+
+    return false;
+}
+
+/** Read the first word of a file of a cgroup directory. */
+static bool readCgroupFile (const string& dir, const char* name, string& value)
+{
+    ifstream file ((dir + "/" + name).c_str());
+    return (bool) (file >> value);
+}
+
+/** Read a value of the 'stat' file of a cgroup directory (eg. "inactive_file"). */
+static u_int64_t readCgroupStat (const string& dir, const char* name, const char* key)
+{
+    ifstream file ((dir + "/" + name).c_str());
+    string    k;
+    u_int64_t v = 0;
+    while (file >> k >> v)  {  if (k == key)  { return v; }  }
+    return 0;
+}
+
+/** Apply a functor to the cgroup directory of a controller and to its ancestors up to the mount point
+ * (the limits of a group are also bounded by the limits of its ancestors). */
+template<typename Functor> static bool forEachCgroupDir (const string& controller, Functor fct)
+{
+    string dir, mountPoint;
+    bool   isV2 = false;
+
+    if (getCgroupDir (controller, dir, mountPoint, isV2) == false)  { return false; }
+
+    while (true)
+    {
+        fct (dir, isV2);
+        if (dir.size() <= mountPoint.size())  { break; }
+        dir = dir.substr (0, dir.rfind ('/'));
+    }
+    return true;
+}
+
+/** Get the memory limit (in bytes) of the cgroup of the process, 0 if none. */
+static u_int64_t getCgroupMemoryLimit ()
+{
+    u_int64_t result = 0;
+
+    forEachCgroupDir ("memory", [&] (const string& dir, bool isV2)
+    {
+        string value;
+        if (readCgroupFile (dir, isV2 ? "memory.max" : "memory.limit_in_bytes", value) == false)  { return; }
+        if (value == "max")  { return; }
+
+        u_int64_t limit = strtoull (value.c_str(), 0, 10);
+
+        /** Without limit, cgroup v1 gives a huge number (like 2^63 rounded to the page size). */
+        if (limit == 0 || limit >= (1ULL << 60))  { return; }
+
+        if (result == 0 || limit < result)  { result = limit; }
+    });
+
+    return result;
+}
+
+/** Get the memory used (in bytes) by the cgroup of the process. The inactive page cache is
+ * not counted, since the kernel reclaims it before hitting the limit. */
+static u_int64_t getCgroupMemoryUsed ()
+{
+    string dir, mountPoint, value;
+    bool   isV2 = false;
+
+    if (getCgroupDir ("memory", dir, mountPoint, isV2) == false)  { return 0; }
+
+    if (readCgroupFile (dir, isV2 ? "memory.current" : "memory.usage_in_bytes", value) == false)  { return 0; }
+
+    u_int64_t used     = strtoull (value.c_str(), 0, 10);
+    u_int64_t inactive = readCgroupStat (dir, "memory.stat", isV2 ? "inactive_file" : "total_inactive_file");
+
+    return used > inactive ? used - inactive : used;
+}
+
+/** Get the number of cores allowed by the CPU quota of the cgroup of the process, 0 if none. */
+static size_t getCgroupCpuQuota ()
+{
+    size_t result = 0;
+
+    forEachCgroupDir ("cpu", [&] (const string& dir, bool isV2)
+    {
+        string quota, period;
+
+        /** cgroup v2 gives "quota period" (quota being 'max' without limit), v1 gives a -1 quota without limit. */
+        if (isV2)
+        {
+            ifstream file ((dir + "/cpu.max").c_str());
+            if (!(file >> quota >> period))  { return; }
+        }
+        else
+        {
+            if (readCgroupFile (dir, "cpu.cfs_quota_us",  quota)  == false)  { return; }
+            if (readCgroupFile (dir, "cpu.cfs_period_us", period) == false)  { return; }
+        }
+
+        if (quota == "max" || quota[0] == '-')  { return; }
+
+        u_int64_t q = strtoull (quota.c_str(),  0, 10);
+        u_int64_t p = strtoull (period.c_str(), 0, 10);
+        if (q == 0 || p == 0)  { return; }
+
+        /** A partial core is rounded up: 1.5 cores of quota still allow to use 2 threads. */
+        size_t nb = (q + p - 1) / p;
+
+        if (result == 0 || nb < result)  { result = nb; }
+    });
+
+    return result;
+}
+
 /********************************************************************************/
 size_t SystemInfoLinux::getNbCores () const
 {
     size_t result = 0;
 
-    /** We open the "/proc/cpuinfo" file. */
-    FILE* file = fopen ("/proc/cpuinfo", "r");
-    if (file)
+    /** We get the number of cores the process is allowed to run on (see taskset, cpusets...). */
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    if (sched_getaffinity (0, sizeof(set), &set) == 0)  {  result = CPU_COUNT (&set);  }
+
+    /** Otherwise, we count the cores of the "/proc/cpuinfo" file. */
+    if (result == 0)
     {
-        char buffer[256];
-        while (fgets(buffer, sizeof(buffer), file))  {  if (strstr(buffer, "processor") != NULL)  { result ++;  }  }
-        fclose (file);
+        FILE* file = fopen ("/proc/cpuinfo", "r");
+        if (file)
+        {
+            char buffer[256];
+            while (fgets(buffer, sizeof(buffer), file))  {  if (strstr(buffer, "processor") != NULL)  { result ++;  }  }
+            fclose (file);
+        }
     }
 
+    /** A CPU quota may allow fewer cores than that. */
+    size_t quota = getCgroupCpuQuota ();
+    if (quota > 0 && quota < result)  { result = quota; }
+
     if (result==0)  { result = 1; }
 
     return result;
@@ -161,6 +379,11 @@ u_int64_t SystemInfoLinux::getMemoryPhysicalTotal () const
     sysinfo (&memInfo);
     u_int64_t result = memInfo.totalram;
     result *= memInfo.mem_unit;
+
+    /** The memory limit of the cgroup is the actual total memory for the process. */
+    u_int64_t limit = getCgroupMemoryLimit ();
+    if (limit > 0 && limit < result)  { result = limit; }
+
     return result;
 }
 
@@ -171,6 +394,15 @@ u_int64_t SystemInfoLinux::getMemoryPhysicalUsed () const
     sysinfo (&memInfo);
     u_int64_t result = memInfo.totalram - memInfo.freeram;
     result *= memInfo.mem_unit;
+
+    /** With a memory limit for the cgroup, what matters is the memory used by the cgroup
+     * (the free memory is then the room left before an OOM kill). */
+    u_int64_t limit = getCgroupMemoryLimit ();
+    if (limit > 0 && limit < (u_int64_t)memInfo.totalram * memInfo.mem_unit)
+    {
+        result = std::min (getCgroupMemoryUsed(), limit);
+    }
+
     return result;
 }
 
@@ -220,6 +452,150 @@ u_int64_t SystemInfoLinux::getMemorySelfMaxUsed () const
     if (getrusage(RUSAGE_SELF, &usage)==0)  {  result = usage.ru_maxrss;  }
     return result;
 }
+
+/********************************************************************************/
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+
+/** \brief Linux implementation of CountersInfo
+ *
+ * The hardware counters are got with perf_event_open (if the kernel allows it, see
+ * /proc/sys/kernel/perf_event_paranoid), the cpu times, page faults and context switches
+ * with getrusage, and the I/O counters from the 'io' file of /proc.
+ */
+class CountersInfoLinux : public ISystemInfo::CountersInfo
+{
+public:
+
+    CountersInfoLinux (bool thread) : _thread(thread)
+    {
+        for (size_t i=0; i<NB_HARDWARE; i++)  { _fd[i] = -1; }
+    }
+
+    ~CountersInfoLinux ()  {  closeHardware ();  }
+
+    void start ()
+    {
+        openHardware ();
+        sample (_start);
+    }
+
+    void stop ()
+    {
+        ISystemInfo::Counters end;
+        sample (end);
+        closeHardware ();
+
+        _counters.reset();
+        for (size_t i=0; i<ISystemInfo::Counters::NB_KINDS; i++)
+        {
+            if (_start.available[i] && end.available[i])
+            {
+                _counters.available[i] = true;
+                _counters.values[i]    = end.values[i] >= _start.values[i] ? end.values[i] - _start.values[i] : 0;
+            }
+        }
+    }
+
+    const ISystemInfo::Counters& getCounters ()  { return _counters; }
+
+private:
+
+    enum { NB_HARDWARE = 4 };
+
+    bool                  _thread;
+    int                   _fd[NB_HARDWARE];
+    ISystemInfo::Counters _start;
+    ISystemInfo::Counters _counters;
+
+    void openHardware ()
+    {
+        static const u_int64_t configs[NB_HARDWARE] = {
+            PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        for (size_t i=0; i<NB_HARDWARE; i++)
+        {
+            struct perf_event_attr attr;
+            memset (&attr, 0, sizeof(attr));
+            attr.type           = PERF_TYPE_HARDWARE;
+            attr.size           = sizeof(attr);
+            attr.config         = configs[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.inherit        = _thread ? 0 : 1;
+            attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            /** We count the calling thread (and its future children if inherit is set), on any cpu.
+             * If the kernel refuses, the counter is just not available. */
+            _fd[i] = syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+    }
+
+    void closeHardware ()
+    {
+        for (size_t i=0; i<NB_HARDWARE; i++)  {  if (_fd[i] >= 0)  { close (_fd[i]);  _fd[i] = -1; }  }
+    }
+
+    void sample (ISystemInfo::Counters& c)
+    {
+        c.reset();
+
+        /** Hardware counters; they may be multiplexed by the kernel, so we scale them. */
+        for (size_t i=0; i<NB_HARDWARE; i++)
+        {
+            u_int64_t buf[3];
+            if (_fd[i] >= 0 && read (_fd[i], buf, sizeof(buf)) == sizeof(buf))
+            {
+                c.values[i]    = (buf[2] > 0 && buf[2] < buf[1]) ? (u_int64_t) ((double)buf[0] * buf[1] / buf[2]) : buf[0];
+                c.available[i] = true;
+            }
+        }
+
+        /** Operating system counters. */
+        struct rusage usage;
+        if (getrusage (_thread ? RUSAGE_THREAD : RUSAGE_SELF, &usage) == 0)
+        {
+            setValue (c, ISystemInfo::Counters::CPU_USER,         usage.ru_utime.tv_sec*1000 + usage.ru_utime.tv_usec/1000);
+            setValue (c, ISystemInfo::Counters::CPU_SYS,          usage.ru_stime.tv_sec*1000 + usage.ru_stime.tv_usec/1000);
+            setValue (c, ISystemInfo::Counters::MAJOR_FAULTS,     usage.ru_majflt);
+            setValue (c, ISystemInfo::Counters::CONTEXT_SWITCHES, usage.ru_nvcsw + usage.ru_nivcsw);
+        }
+
+        /** I/O counters. */
+        char filename[64];
+        if (_thread)  {  snprintf (filename, sizeof(filename), "/proc/self/task/%ld/io", (long) syscall (SYS_gettid));  }
+        else          {  snprintf (filename, sizeof(filename), "/proc/self/io");  }
+
+        FILE* file = fopen (filename, "r");
+        if (file)
+        {
+            char line[128];
+            unsigned long long value;
+            while (fgets (line, sizeof(line), file) != NULL)
+            {
+                     if (sscanf (line, "rchar: %llu",       &value) == 1)  {  setValue (c, ISystemInfo::Counters::BYTES_READ,    value);  }
+                else if (sscanf (line, "wchar: %llu",       &value) == 1)  {  setValue (c, ISystemInfo::Counters::BYTES_WRITTEN, value);  }
+                else if (sscanf (line, "read_bytes: %llu",  &value) == 1)  {  setValue (c, ISystemInfo::Counters::DISK_READ,     value);  }
+                else if (sscanf (line, "write_bytes: %llu", &value) == 1)  {  setValue (c, ISystemInfo::Counters::DISK_WRITTEN,  value);  }
+            }
+            fclose (file);
+        }
+    }
+
+    static void setValue (ISystemInfo::Counters& c, size_t kind, u_int64_t value)
+    {
+        c.values[kind]    = value;
+        c.available[kind] = true;
+    }
+};
+
+/********************************************************************************/
+ISystemInfo::CountersInfo* SystemInfoLinux::createCountersInfo (bool thread)
+{
+    return new CountersInfoLinux (thread);
+}
 #endif
 
 /*********************************************************************
@@ -84,6 +84,10 @@ public:
 
     /** \copydoc ISystemInfo::createCpuInfo */
     virtual CpuInfo* createCpuInfo (); //  { return new CpuInfoCommon(); }
+
+    /** \copydoc ISystemInfo::createCountersInfo
+     * Default implementation: no counter is available. */
+    virtual CountersInfo* createCountersInfo (bool thread);
 };
 
 /********************************************************************************/
@@ -114,6 +118,9 @@ public:
 
     /** \copydoc ISystemInfo::getMemorySelfUsed */
     u_int64_t getMemorySelfMaxUsed() const;
+
+    /** \copydoc ISystemInfo::createCountersInfo */
+    CountersInfo* createCountersInfo (bool thread);
 };
 
 /********************************************************************************/
@@ -24,6 +24,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <pthread.h>
+#include <sched.h>
+#include <vector>
 
 #include <unistd.h>
 
@@ -140,6 +142,99 @@ u_int64_t ThreadFactoryLinux::getProcess ()
     return getpid ();
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : read a list of integers like "0-3,8-11" (cpus or nodes list of /sys)
+** INPUT   : filename : file holding the list
+** OUTPUT  : items : items of the list
+** RETURN  : false if the file can't be read
+** REMARKS :
+*********************************************************************/
+static bool readList (const char* filename, vector<int>& items)
+{
+    FILE* file = fopen (filename, "r");
+    if (file == 0)  { return false; }
+
+    int first=0, last=0, sep=0;
+    while (fscanf (file, "%d", &first) == 1)
+    {
+        last = first;
+        if ((sep = fgetc (file)) == '-')  {  if (fscanf (file, "%d", &last) != 1)  { break; }  sep = fgetc (file);  }
+        for (int i=first; i<=last; i++)  {  items.push_back (i);  }
+        if (sep != ',')  { break; }
+    }
+
+    fclose (file);
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : get the cores the process may run on
+** INPUT   :
+** OUTPUT  :
+** RETURN  : the cores, ordered round robin over the NUMA nodes
+** REMARKS : so that the first threads are spread over all the sockets
+*********************************************************************/
+static vector<int> getCores ()
+{
+    vector<int> result;
+
+    cpu_set_t allowed;
+    CPU_ZERO (&allowed);
+    if (sched_getaffinity (0, sizeof(allowed), &allowed) != 0)  { return result; }
+
+    /** We get the allowed cores of each NUMA node. */
+    vector<vector<int> > nodes;
+    for (size_t n=0; ; n++)
+    {
+        char filename[128];
+        snprintf (filename, sizeof(filename), "/sys/devices/system/node/node%ld/cpulist", (long)n);
+
+        vector<int> cpus;
+        if (readList (filename, cpus) == false)  { break; }
+
+        nodes.push_back (vector<int>());
+        for (size_t i=0; i<cpus.size(); i++)  {  if (cpus[i] < CPU_SETSIZE && CPU_ISSET (cpus[i], &allowed))  { nodes.back().push_back (cpus[i]); }  }
+    }
+
+    /** No NUMA information: the cores are taken in order. */
+    if (nodes.empty())
+    {
+        for (int i=0; i<CPU_SETSIZE; i++)  {  if (CPU_ISSET (i, &allowed))  { result.push_back (i); }  }
+        return result;
+    }
+
+    for (size_t i=0, nb=1; nb>0; i++)
+    {
+        nb = 0;
+        for (size_t n=0; n<nodes.size(); n++)  {  if (i < nodes[n].size())  { result.push_back (nodes[n][i]);  nb++; }  }
+    }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool ThreadFactoryLinux::bindThreadSelf (size_t idx)
+{
+    static vector<int> cores = getCores();
+
+    if (cores.empty())  { return false; }
+
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    CPU_SET  (cores[idx % cores.size()], &set);
+
+    return pthread_setaffinity_np (pthread_self(), sizeof(set), &set) == 0;
+}
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
@@ -53,6 +53,9 @@ public:
 
     /** \copydoc IThreadFactory::getProcess */
     u_int64_t getProcess ();
+
+    /** \copydoc IThreadFactory::bindThreadSelf */
+    bool bindThreadSelf (size_t idx);
 };
 
 /********************************************************************************/
@@ -140,6 +140,19 @@ u_int64_t ThreadFactoryMacos::getProcess ()
     return getpid ();
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : thread affinity can't be set on MacOs
+*********************************************************************/
+bool ThreadFactoryMacos::bindThreadSelf (size_t idx)
+{
+    return false;
+}
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
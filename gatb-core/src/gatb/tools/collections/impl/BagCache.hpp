@@ -248,7 +248,12 @@ private:
 
 /** \brief Bag implementation as a cache to a referred Bag instance.
  *
- * The cache is sorted before sent to the reference
+ * The cache is sorted in place before being sent to the reference, so the referred bag
+ * receives a sequence of sorted runs (one per flush of the cache). Each thread can have its
+ * own BagCacheSorted on the same delegate: the only shared resource is the delegate itself,
+ * protected by the synchronizer while a run is appended. Since a run is appended in a single
+ * 'insert' call, it stays contiguous in the delegate; the runs can then be merged by the
+ * reader (see tools::dp::impl::SortedRunsIterator).
  */
 template <typename Item> class BagCacheSorted : public BagCache<Item>
 {
@@ -258,12 +263,16 @@ public:
     BagCacheSorted (Bag<Item>* ref, size_t cacheSize, system::ISynchronizer* synchro=0)
         : BagCache<Item>(ref, cacheSize, synchro)  { }
 
+    /** Destructor. The remaining items are flushed here, as a sorted run (the flush of the
+     * parent destructor would not sort them). */
+    virtual ~BagCacheSorted ()  {  flush ();  }
+
     /**  \copydoc Bag::insert */
     void insert (const Item& item)
     {
         if (this->_idx+1 > this->_nbMax)
         {
-            std::sort (this->_items.begin (), this->_items.end ());
+            sortCache ();
 
             if (this->_synchro)  {  this->_synchro->lock();      }
             this->flushCache ();
@@ -276,14 +285,17 @@ public:
     /**  \copydoc Bag::flush */
     void flush ()
     {
-        this->_items.resize (this->_idx);
-        std::sort (this->_items.begin (), this->_items.end ());
+        sortCache ();
 
         if (this->_synchro)  {  this->_synchro->lock();    }
         this->flushCache ();
         this->_ref->flush();
         if (this->_synchro)  {  this->_synchro->unlock();  }
     }
+
+private:
+
+    void sortCache ()  {  std::sort (this->_items, this->_items + this->_idx);  }
 };
 
 /********************************************************************************/
@@ -180,13 +180,20 @@ public:
 
     /** Constructor.
      * \param[in] tai_bloom : size (in bits) of the bloom filter.
-     * \param[in] nbHash : number of hash functions to use */
-    BloomContainer (u_int64_t tai_bloom, size_t nbHash = 4)
-        : _hash(nbHash), n_hash_func(nbHash), blooma(0), tai(tai_bloom), nchar(0), isSizePowOf2(false)
+     * \param[in] nbHash : number of hash functions to use
+     * \param[in] array : existing bit set to be used (for instance a memory mapped one), not released
+     *  by the Bloom filter; if null, an empty bit set is allocated. */
+    BloomContainer (u_int64_t tai_bloom, size_t nbHash = 4, u_int8_t* array = 0)
+        : _hash(nbHash), n_hash_func(nbHash), blooma(array), tai(tai_bloom), nchar(0), isSizePowOf2(false), ownsArray(array==0)
     {
         nchar  = (1+tai/8LL);
-        blooma = (unsigned char *) MALLOC (nchar*sizeof(unsigned char)); // 1 bit per elem
-        system::impl::System::memory().memset (blooma, 0, nchar*sizeof(unsigned char));
+        /** The bit set is queried at random from all threads: its pages are spread over the NUMA nodes
+         * (and already zeroed, so not touched here by a single thread), and huge pages are used if
+         * possible, since nearly every query misses the TLB otherwise. */
+        if (ownsArray)
+        {
+            blooma = (unsigned char *) system::impl::System::memoryNuma().callocHuge (nchar); // 1 bit per elem
+        }
 
         /** We look whether the provided size is a power of 2 or not.
          *   => if we have a power of two, we can optimize the modulo operations. */
@@ -201,7 +208,7 @@ public:
     /** Destructor. */
     virtual ~BloomContainer ()
     {
-        system::impl::System::memory().free (blooma);
+        if (ownsArray)  {  system::impl::System::memoryNuma().free (blooma);  }
     }
 
     /** \copydoc IBloom::getNbHash */
@@ -262,6 +269,7 @@ protected:
     u_int64_t tai;
     u_int64_t nchar;
     bool      isSizePowOf2;
+    bool      ownsArray;
 };
 
 /********************************************************************************/
@@ -272,7 +280,7 @@ template <typename Item> class Bloom : public BloomContainer<Item>
 public:
 
     /** \copydoc BloomContainer::BloomContainer */
-    Bloom (u_int64_t tai_bloom, size_t nbHash = 4)  : BloomContainer<Item> (tai_bloom, nbHash)  {}
+    Bloom (u_int64_t tai_bloom, size_t nbHash = 4, u_int8_t* array = 0)  : BloomContainer<Item> (tai_bloom, nbHash, array)  {}
 
     /** \copydoc Bag::insert. */
     void insert (const Item& item)
@@ -388,7 +396,7 @@ template <typename Item> class BloomSynchronized : public Bloom<Item>
 public:
 
     /** \copydoc Bloom::Bloom */
-    BloomSynchronized (u_int64_t tai_bloom, size_t nbHash = 4)  : Bloom<Item> (tai_bloom, nbHash)  {}
+    BloomSynchronized (u_int64_t tai_bloom, size_t nbHash = 4, u_int8_t* array = 0)  : Bloom<Item> (tai_bloom, nbHash, array)  {}
 
     /** \copydoc Bag::insert. */
     void insert (const Item& item)
@@ -433,31 +441,33 @@ public:
     /** Constructor.
      * \param[in] tai_bloom : size (in bits) of the bloom filter.
      * \param[in] nbHash : number of hash functions to use
-     * \param[in] block_nbits : size of the block (actual 2^nbits) */
-    BloomCacheCoherent (u_int64_t tai_bloom, size_t nbHash = 4,size_t block_nbits = 12)
-        : Bloom<Item> (tai_bloom + 2*(1<<block_nbits), nbHash),_nbits_BlockSize(block_nbits)
+     * \param[in] block_nbits : size of the block (actual 2^nbits)
+     * \param[in] array : existing bit set to be used (see BloomContainer) */
+    BloomCacheCoherent (u_int64_t tai_bloom, size_t nbHash = 4,size_t block_nbits = 12, u_int8_t* array = 0)
+        : Bloom<Item> (tai_bloom + 2*(1<<block_nbits), nbHash, array),_nbits_BlockSize(block_nbits)
     {
         _mask_block = (1<<_nbits_BlockSize) - 1;
         _reduced_tai = this->tai -  2*(1<<_nbits_BlockSize) ;//2* for neighbor coherent
     }
     
      /** \copydoc Bag::insert. */
-    void insert (const Item& item)
-    {
-        //for insert, no prefetch, perf is not important
-        u_int64_t h0;
+    void insert (const Item& item)  {  insert_aux<true> (item);  }
 
-        h0 = this->_hash (item,0) % _reduced_tai;
+    /** Insert an item with plain stores instead of atomic ones. All the bits set for an item lie in
+     * the block returned by getBlock or in the next one, so threads may insert concurrently as long as
+     * the blocks of their items are separated by at least one block.
+     * \param[in] item : item to be inserted */
+    virtual void insertUnsynchronized (const Item& item)  {  insert_aux<false> (item);  }
 
-        __sync_fetch_and_or (this->blooma + (h0 >> 3), bit_mask[h0 & 7]);
+    /** Get the block holding the first bit set by the insertion of an item.
+     * \param[in] item : item to be inserted
+     * \return the block index, lower than getNbBlocks */
+    virtual u_int64_t getBlock (const Item& item)  {  return (this->_hash (item,0) % _reduced_tai) >> _nbits_BlockSize;  }
+
+    /** Get the number of blocks of the bit set.
+     * \return the number of blocks. */
+    u_int64_t getNbBlocks ()  {  return (this->tai >> _nbits_BlockSize) + 1;  }
 
-        for (size_t i=1; i<this->n_hash_func; i++)
-        {
-            u_int64_t h1 = h0  + (simplehash16( item, i) & _mask_block )   ;
-            __sync_fetch_and_or (this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
-        }
-    }
-    
     /** \copydoc IBloom::getName*/
     std::string  getName () const { return "cache"; }
 
@@ -499,6 +509,31 @@ protected:
     u_int64_t _mask_block;
     size_t    _nbits_BlockSize;
     u_int64_t _reduced_tai;
+
+    /** Set a bit of the bit set, atomically or not. */
+    template<bool sync> void setBit (u_int64_t h)
+    {
+        if (sync)  {  __sync_fetch_and_or (this->blooma + (h >> 3), bit_mask[h & 7]);  }
+        else       {  this->blooma [h >> 3] |= bit_mask[h & 7];  }
+    }
+
+private:
+
+    template<bool sync> void insert_aux (const Item& item)
+    {
+        //for insert, no prefetch, perf is not important
+        u_int64_t h0;
+
+        h0 = this->_hash (item,0) % _reduced_tai;
+
+        setBit<sync> (h0);
+
+        for (size_t i=1; i<this->n_hash_func; i++)
+        {
+            u_int64_t h1 = h0  + (simplehash16( item, i) & _mask_block )   ;
+            setBit<sync> (h1);
+        }
+    }
 };
 	
 /********************************************************************************/
@@ -519,9 +554,10 @@ public:
      * \param[in] tai_bloom : size (in bits) of the bloom filter.
      * \param[in] kmersize : kmer size
      * \param[in] nbHash : number of hash functions to use
-     * \param[in] block_nbits : size of the block (actual 2^nbits) */
-    BloomNeighborCoherent (u_int64_t tai_bloom, size_t kmersize , size_t nbHash = 4,size_t block_nbits = 12 )  :
-    BloomCacheCoherent<Item> (tai_bloom , nbHash,block_nbits), _kmerSize(kmersize)
+     * \param[in] block_nbits : size of the block (actual 2^nbits)
+     * \param[in] array : existing bit set to be used (see BloomContainer) */
+    BloomNeighborCoherent (u_int64_t tai_bloom, size_t kmersize , size_t nbHash = 4,size_t block_nbits = 12, u_int8_t* array = 0)  :
+    BloomCacheCoherent<Item> (tai_bloom , nbHash,block_nbits, array), _kmerSize(kmersize)
     {
         cano2[ 0] = 0;
         cano2[ 1] = 1;
@@ -552,39 +588,16 @@ public:
     }
 
     /** \copydoc Bag::insert. */
-    void insert (const Item& item)
-    {
-        u_int64_t h0;
-        u_int64_t racine;
+    void insert (const Item& item)  {  insert_aux<true> (item);  }
 
-        Item suffix = item & 3 ;
-        Item prefix = (item & _prefmask)  >> ((_kmerSize-2)*2);
-        prefix += suffix;
-        prefix = prefix  & 15 ;
-
-        u_int64_t pref_val = cano2[prefix.getVal()]; //get canonical of pref+suffix
-
-        Item hashpart = ( item >> 2 ) & _maskkm2 ;  // delete 1 nt at each side
-        Item rev =  revcomp(hashpart,_kmerSize-2);
-        if(rev<hashpart) hashpart = rev; //transform to canonical
-
-        // Item km = item;
-        // rev =  revcomp(km,_kmerSize);
-        // if(rev < km) km = rev; //transform to canonical
-        
-        racine = ((this->_hash (hashpart,0) ) % this->_reduced_tai) ;
-        //h0 = ((this->_hash (item >> 2,0) ) % this->_reduced_tai)  + (suffix_val & this->_mask_block);
-        //h0 = racine + (this->_hash (km,0)  & this->_mask_block);
-        h0 = racine + (pref_val );
-        __sync_fetch_and_or (this->blooma + (h0 >> 3), bit_mask[h0 & 7]);
+    /** \copydoc BloomCacheCoherent::insertUnsynchronized */
+    void insertUnsynchronized (const Item& item)  {  insert_aux<false> (item);  }
 
-        for (size_t i=1; i<this->n_hash_func; i++)
-        {
-            u_int64_t h1 = h0  + ( (simplehash16( hashpart, i))  & this->_mask_block )   ;
-            //	u_int64_t h1 = racine  + ( (simplehash16( km, i))  & this->_mask_block )   ; //ceci avec simplehash+8  semble ok
-            //	u_int64_t h1 = h0  +  ( (this->_hash (item>>2,i)+ suffix_val)  & _mask_block );
-            __sync_fetch_and_or (this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
-        }
+    /** \copydoc BloomCacheCoherent::getBlock */
+    u_int64_t getBlock (const Item& item)
+    {
+        Item hashpart;
+        return getFirstHash (item, hashpart) >> this->_nbits_BlockSize;
     }
 
     /** \copydoc IBloom::getName*/
@@ -815,6 +828,46 @@ private:
     Item _prefmask;
     Item _kmerMask;
     size_t _kmerSize;
+
+    /** Compute the first bit set by the insertion of an item, and the part of the item used for the other hashes. */
+    u_int64_t getFirstHash (const Item& item, Item& hashpart)
+    {
+        Item suffix = item & 3 ;
+        Item prefix = (item & _prefmask)  >> ((_kmerSize-2)*2);
+        prefix += suffix;
+        prefix = prefix  & 15 ;
+
+        u_int64_t pref_val = cano2[prefix.getVal()]; //get canonical of pref+suffix
+
+        hashpart = ( item >> 2 ) & _maskkm2 ;  // delete 1 nt at each side
+        Item rev =  revcomp(hashpart,_kmerSize-2);
+        if(rev<hashpart) hashpart = rev; //transform to canonical
+
+        // Item km = item;
+        // rev =  revcomp(km,_kmerSize);
+        // if(rev < km) km = rev; //transform to canonical
+
+        u_int64_t racine = ((this->_hash (hashpart,0) ) % this->_reduced_tai) ;
+        //h0 = ((this->_hash (item >> 2,0) ) % this->_reduced_tai)  + (suffix_val & this->_mask_block);
+        //h0 = racine + (this->_hash (km,0)  & this->_mask_block);
+        return racine + (pref_val );
+    }
+
+    template<bool sync> void insert_aux (const Item& item)
+    {
+        Item hashpart;
+        u_int64_t h0 = getFirstHash (item, hashpart);
+
+        this->template setBit<sync> (h0);
+
+        for (size_t i=1; i<this->n_hash_func; i++)
+        {
+            u_int64_t h1 = h0  + ( (simplehash16( hashpart, i))  & this->_mask_block )   ;
+            //	u_int64_t h1 = racine  + ( (simplehash16( km, i))  & this->_mask_block )   ; //ceci avec simplehash+8  semble ok
+            //	u_int64_t h1 = h0  +  ( (this->_hash (item>>2,i)+ suffix_val)  & _mask_block );
+            this->template setBit<sync> (h1);
+        }
+    }
 };
     
 /********************************************************************************/
@@ -836,9 +889,10 @@ public:
      * \param[in] kmersize : kmer size
      * \param[in] hmersize : hashpart size
      * \param[in] nbHash : number of hash functions to use
-     * \param[in] block_nbits : size of the block (actual 2^nbits) */
-    BloomExtendedNeighborCoherent (u_int64_t tai_bloom, size_t kmersize, size_t nbHash = 7, size_t block_nbits = 12)
-        : BloomCacheCoherent<Item> (tai_bloom, nbHash,block_nbits), _kmerSize(kmersize)
+     * \param[in] block_nbits : size of the block (actual 2^nbits)
+     * \param[in] array : existing bit set to be used (see BloomContainer) */
+    BloomExtendedNeighborCoherent (u_int64_t tai_bloom, size_t kmersize, size_t nbHash = 7, size_t block_nbits = 12, u_int8_t* array = 0)
+        : BloomCacheCoherent<Item> (tai_bloom, nbHash,block_nbits, array), _kmerSize(kmersize)
     {
         _smerSize = _kmerSize - 2;
         _hmerSize = _smerSize - 8;
@@ -876,33 +930,16 @@ public:
     }
 
     /** \copydoc Bag::insert. */
-    void insert (const Item& item)
-    {
-        u_int64_t h0;
-        u_int64_t racine;
+    void insert (const Item& item)  {  insert_aux<true> (item);  }
 
-        Item suffix = item & ((Item)0x3f);
-        Item limits = (item & _kmerPrefMask)  >> ((_kmerSize-6)*2);
-        limits += suffix;
-        u_int64_t delta = cano6[limits.getVal()];
+    /** \copydoc BloomCacheCoherent::insertUnsynchronized */
+    void insertUnsynchronized (const Item& item)  {  insert_aux<false> (item);  }
 
-        Item sharedpart = (item >> 2) & _smerMask;  // delete 1 nt at each side
-        Item rev =  revcomp(sharedpart, _smerSize);
-        if(rev < sharedpart) sharedpart = rev; //transform to canonical
-
-        _hpart = extractHashpart(sharedpart);
-        _hpartHash = this->_hash (_hpart, 0);
-        
-        racine = _hpartHash % this->_reduced_tai;
-        h0 = racine + delta;
-        __sync_fetch_and_or(this->blooma + (h0 >> 3), bit_mask[h0 & 7]);
-
-
-        for (size_t i=1; i<this->n_hash_func; i++)
-        {
-            u_int64_t h1 = h0 + ((simplehash16( _hpart, i)) & this->_mask_block);
-            __sync_fetch_and_or(this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
-        }
+    /** \copydoc BloomCacheCoherent::getBlock */
+    u_int64_t getBlock (const Item& item)
+    {
+        Item hpart;
+        return getFirstHash (item, hpart) >> this->_nbits_BlockSize;
     }
 
     /** \copydoc IBloom::getName*/
@@ -1194,6 +1231,40 @@ private:
         return hpart;
     }
 
+    /** Compute the first bit set by the insertion of an item, and the hash part of the item.
+     * NOTE: local variables are used rather than _hpart/_hpartHash, which cache the last contains query
+     * and must not be modified by concurrent insertions. */
+    u_int64_t getFirstHash (const Item& item, Item& hpart)
+    {
+        Item suffix = item & ((Item)0x3f);
+        Item limits = (item & _kmerPrefMask)  >> ((_kmerSize-6)*2);
+        limits += suffix;
+        u_int64_t delta = cano6[limits.getVal()];
+
+        Item sharedpart = (item >> 2) & _smerMask;  // delete 1 nt at each side
+        Item rev =  revcomp(sharedpart, _smerSize);
+        if(rev < sharedpart) sharedpart = rev; //transform to canonical
+
+        hpart = extractHashpart(sharedpart);
+
+        u_int64_t racine = this->_hash (hpart, 0) % this->_reduced_tai;
+        return racine + delta;
+    }
+
+    template<bool sync> void insert_aux (const Item& item)
+    {
+        Item hpart;
+        u_int64_t h0 = getFirstHash (item, hpart);
+
+        this->template setBit<sync> (h0);
+
+        for (size_t i=1; i<this->n_hash_func; i++)
+        {
+            u_int64_t h1 = h0 + ((simplehash16( hpart, i)) & this->_mask_block);
+            this->template setBit<sync> (h1);
+        }
+    }
+
     void precomputeCano6()
     {
         for (uint64_t i=0; i<0x1000; i++) {
@@ -1250,16 +1321,17 @@ public:
      * \param[in] tai_bloom : size of the Bloom filter (in bits)
      * \param[in] nbHash : number of hash functions for the Bloom filter
      * \param[in] kmersize : kmer size (used only for some implementations).
+     * \param[in] array : existing bit set to be used, for instance a memory mapped one (see BloomContainer).
      */
-    template<typename T> IBloom<T>* createBloom (tools::misc::BloomKind kind, u_int64_t tai_bloom, size_t nbHash, size_t kmersize)
+    template<typename T> IBloom<T>* createBloom (tools::misc::BloomKind kind, u_int64_t tai_bloom, size_t nbHash, size_t kmersize, u_int8_t* array = 0)
     {
         switch (kind)
         {
             case tools::misc::BLOOM_NONE:      return new BloomNull<T>             ();
-            case tools::misc::BLOOM_BASIC:     return new BloomSynchronized<T>     (tai_bloom, nbHash);
-            case tools::misc::BLOOM_CACHE:     return new BloomCacheCoherent<T>    (tai_bloom, nbHash);
-			case tools::misc::BLOOM_NEIGHBOR:  return new BloomNeighborCoherent<T> (tai_bloom, kmersize, nbHash);
-            case tools::misc::BLOOM_DEFAULT:   return new BloomCacheCoherent<T>    (tai_bloom, nbHash);
+            case tools::misc::BLOOM_BASIC:     return new BloomSynchronized<T>     (tai_bloom, nbHash, array);
+            case tools::misc::BLOOM_CACHE:     return new BloomCacheCoherent<T>    (tai_bloom, nbHash, 12, array);
+			case tools::misc::BLOOM_NEIGHBOR:  return new BloomNeighborCoherent<T> (tai_bloom, kmersize, nbHash, 12, array);
+            case tools::misc::BLOOM_DEFAULT:   return new BloomCacheCoherent<T>    (tai_bloom, nbHash, 12, array);
             default:        throw system::Exception ("bad Bloom kind %d in createBloom", kind);
         }
     }
@@ -1269,17 +1341,19 @@ public:
      * \param[in] sizeStr : size of the Bloom filter (in bits) as a string
      * \param[in] nbHashStr : number of hash functions for the Bloom filter as a string
      * \param[in] kmerSizeStr : kmer size (used only for some implementations) as a string.
+     * \param[in] array : existing bit set to be used, for instance a memory mapped one (see BloomContainer).
      */
     template<typename T> IBloom<T>* createBloom (
         const std::string& name,
         const std::string& sizeStr,
         const std::string& nbHashStr,
-        const std::string& kmerSizeStr
+        const std::string& kmerSizeStr,
+        u_int8_t* array = 0
     )
     {
         //std::cout << "custom createbloom, name=" << name << " size=" << sizeStr << " nbHash=" << nbHashStr << " k=" << kmerSizeStr << std::endl;
         tools::misc::BloomKind kind;  parse (name, kind);
-        return createBloom<T> (kind, (u_int64_t)atol (sizeStr.c_str()), (size_t)atol (nbHashStr.c_str()), atol (kmerSizeStr.c_str()));
+        return createBloom<T> (kind, (u_int64_t)atol (sizeStr.c_str()), (size_t)atol (nbHashStr.c_str()), atol (kmerSizeStr.c_str()), array);
     }
 };
 
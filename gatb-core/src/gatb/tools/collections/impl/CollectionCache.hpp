@@ -120,6 +120,42 @@ private:
     Collection<Item>& _ref;
 };
 
+/********************************************************************************/
+
+/** \brief Cache implementation of the Collection interface, writing sorted runs
+ *
+ * This implementation is like CollectionCache, except that the cache is sorted in place
+ * before being inserted into the delegate Collection (see BagCacheSorted). The delegate
+ * then holds a sequence of sorted runs, which can be merged while being read.
+ *
+ * Unlike CollectionCacheSorted, there is no buffer shared by the instances used by the
+ * different threads: a flush only takes the lock of the delegate, without any copy.
+ */
+template <class Item> class CollectionCacheSortedRuns : public CollectionAbstract<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor. */
+    CollectionCacheSortedRuns (Collection<Item>& ref,  size_t cacheSize, system::ISynchronizer* synchro)
+        : CollectionAbstract<Item> (
+            new BagCacheSorted<Item> (ref.bag(), cacheSize, synchro),
+            ref.iterable()
+        ), _ref(ref)  {}
+
+    /** Destructor. */
+    virtual ~CollectionCacheSortedRuns() {}
+
+    /** \copydoc Collection::remove */
+    void remove ()  { _ref.remove(); }
+
+    /** Accessor to the delegate Collection.
+     * \return the delegate Collection instance. */
+    Collection<Item>& getRef ()  { return _ref; }
+
+private:
+    Collection<Item>& _ref;
+};
+
 /********************************************************************************/
 } } } } } /* end of namespaces. */
 /********************************************************************************/
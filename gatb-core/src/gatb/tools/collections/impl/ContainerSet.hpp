@@ -74,6 +74,82 @@ private:
     std::vector<Item> _items;
 };
 
+/********************************************************************************/
+/** \brief Implementation of the Container interface with an Eytzinger layout
+ *
+ * The items are sorted and then stored in the order of a breadth first traversal of
+ * the implicit binary search tree (children of node k are nodes 2k and 2k+1). A lookup
+ * still needs log(N) comparisons, but the first levels of the tree share a few cache lines
+ * and the nodes of the next levels are prefetched while the current one is compared, so a
+ * lookup costs far fewer cache misses than a binary search in the sorted vector (see
+ * ContainerSet).
+ *
+ * This is the container used for the critical false positives of the de Bruijn graph, which
+ * are looked up for every node found in the Bloom filter.
+ */
+template <typename Item> class ContainerEytzinger : public Container<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor.
+     * \param[in] it : iterator over the items of the container. */
+    ContainerEytzinger (dp::Iterator<Item>* it)
+    {
+        LOCAL (it);
+
+        std::vector<Item> sorted;
+        for (it->first(); !it->isDone(); it->next())  {  sorted.push_back (it->item());  }
+
+        std::sort (sorted.begin(), sorted.end());
+        sorted.erase (std::unique (sorted.begin(), sorted.end()), sorted.end());
+
+        /** Index 0 is not used, the root of the tree is at index 1. */
+        _n = sorted.size();
+        _items.resize (_n + 1);
+
+        size_t idx = 0;
+        build (sorted, idx, 1);
+    }
+
+    /** \copydoc Container::contains */
+    bool contains (const Item& item)
+    {
+        /** The B descendants of node k, log2(B) levels below, are contiguous from index B*k: with B
+         * items per cache line, we prefetch them while going down the next levels. */
+        static const size_t B = sizeof(Item) < 64 ? 64/sizeof(Item) : 1;
+
+        const Item* items = _items.data();
+        size_t k = 1;
+
+        while (k <= _n)
+        {
+            __builtin_prefetch (items + std::min (B*k, _n));
+            k = 2*k + (items[k] < item);
+        }
+
+        /** We go up to the last node where we went left, ie. the lower bound of the item. */
+        k >>= __builtin_ffsll (~k);
+
+        return k != 0 && items[k] == item;
+    }
+
+private:
+
+    /** Fill the tree with an in-order traversal, which gives the sorted items in order. */
+    void build (const std::vector<Item>& sorted, size_t& idx, size_t k)
+    {
+        if (k <= _n)
+        {
+            build (sorted, idx, 2*k);
+            _items[k] = sorted[idx++];
+            build (sorted, idx, 2*k+1);
+        }
+    }
+
+    std::vector<Item> _items;
+    size_t            _n;
+};
+
 /********************************************************************************/
 } } } } } /* end of namespaces. */
 /********************************************************************************/
@@ -62,7 +62,10 @@ namespace gatb        {
 						typedef BooPHF<Key, Adaptator> Hash;
 						
 						/** Default constructor. */
-						MapMPHF () : hash() {}
+						MapMPHF () : hash(), data(0), values(0), nbValues(0) {}
+						
+						/** Destructor. */
+						~MapMPHF ()  {  freeData();  }
 						
 						/** Build the hash function from a set of items.
 						 * \param[in] keys : iterable over the keys of the hash table
@@ -74,8 +77,7 @@ namespace gatb        {
 							hash.build (&keys, nbThreads, progress);
 							
 							/** We resize the vector of Value objects. */
-							data.resize (keys.getNbItems());
-							clearData();
+							resizeData (keys.getNbItems());
 							initDiscretizationScheme();
 						}
 						
@@ -164,9 +166,7 @@ namespace gatb        {
 							hash = other->hash;
 							
 							/** We resize the vector of Value objects. */
-							data.resize ((unsigned long)((hash.size()) / (unsigned long)x) + 1LL); // that +1 and not (hash.size+x-1) / x
-							
-							clearData();
+							resizeData ((unsigned long)((hash.size()) / (unsigned long)x) + 1LL); // that +1 and not (hash.size+x-1) / x
 						}
 						
 						/** Save the hash function into a Group object.
@@ -186,36 +186,77 @@ namespace gatb        {
 							size_t nbKeys = hash.load (group, name);
 							
 							/** We resize the vector of Value objects. */
-							data.resize (nbKeys);
-							clearData();
+							resizeData (nbKeys);
 							initDiscretizationScheme();
 						}
 						
+						/** Save the values into a collection of a Group object (the hash function itself is saved by 'save'),
+						 * so that they can be loaded back by 'loadData' instead of being computed again.
+						 * \param[out] group : group where to save the values
+						 * \param[in] name : name of the saved values
+						 * \return the number of bytes of the saved data.
+						 */
+						size_t saveData (tools::storage::impl::Group& group, const std::string& name)
+						{
+							tools::storage::impl::Storage::ostream os (group, name);
+							os.write (reinterpret_cast<char const*>(values), nbValues*sizeof(Value));
+							os.flush();
+							return nbValues*sizeof(Value);
+						}
+						
+						/** Load the values saved by 'saveData'. The hash function must have been loaded (or shared
+						 * through 'useHashFrom') before, so that the number of values is known.
+						 *
+						 * If the storage maps the values in memory (see STORAGE_MMAP), they are used in place.
+						 * \param[in] group : group where to load the values from
+						 * \param[in] name : name of the values
+						 */
+						void loadData (tools::storage::impl::Group& group, const std::string& name)
+						{
+							size_t nbMapped = 0;
+							Value* mapped   = (Value*) group.mapCollection<math::NativeInt8> (name, nbMapped);
+							
+							if (mapped != 0 && nbMapped == nbValues*sizeof(Value))
+							{
+								freeData ();
+								values = mapped;
+								return;
+							}
+							
+							tools::storage::impl::Storage::istream is (group, name, 1<<20);
+							is.read (reinterpret_cast<char*>(values), nbValues*sizeof(Value));
+							
+							if ((size_t)is.gcount() != nbValues*sizeof(Value))
+							{
+								throw system::Exception ("MapMPHF: %s holds %ld bytes instead of %ld", name.c_str(), (long)is.gcount(), (long)(nbValues*sizeof(Value)));
+							}
+						}
+						
 						/** Get the value for a given key
 						 * \param[in] key : the key
 						 * \return the value associated to the key. */
 						Value& operator[] (const Key& key)  {
-							return data[hash(key)];
+							return values[hash(key)];
 						}
 						
 						/** Get the value for a given index
 						 * \param[in] code : the key
 						 * \return the value associated to the key. */
 						Value& at (typename Hash::Code code)  {
-							return data[code];
+							return values[code];
 						
 						}
 						
 						Value& at (const Key& key)  {
-							return data[hash(key)];
+							return values[hash(key)];
 						}
 						
                         int abundanceAt (const Key& key)  {
-							return floorf((_abundanceDiscretization [data[hash(key)]]  +  _abundanceDiscretization [data[hash(key)]+1])/2.0);
+							return floorf((_abundanceDiscretization [values[hash(key)]]  +  _abundanceDiscretization [values[hash(key)]+1])/2.0);
 						}
 	
                         int abundanceAt (typename Hash::Code code)  {
-							return floorf((_abundanceDiscretization [data[code]]  +  _abundanceDiscretization [data[code]+1])/2.0);
+							return floorf((_abundanceDiscretization [values[code]]  +  _abundanceDiscretization [values[code]+1])/2.0);
 						}
 						
 						/** Get the hash code of the given key. */
@@ -226,8 +267,8 @@ namespace gatb        {
 						size_t size() const { return hash.size(); }
 						
 						void clearData() { 
-							for (unsigned long i = 0; i < data.size(); i ++)
-								data[i] = 0;
+							for (unsigned long i = 0; i < nbValues; i ++)
+								values[i] = 0;
 						}
 						
 						std::vector<int>   _abundanceDiscretization;
@@ -235,7 +276,26 @@ namespace gatb        {
 					private:
 						
 						Hash               hash;
-						std::vector<Value> data;
+						
+						/** Values allocated by the map. They are queried at random from all threads, so their pages
+						 * are spread over the NUMA nodes (see System::memoryNuma) and are huge pages if possible. */
+						Value*             data;
+						
+						/** Values in use: either 'data' or values mapped by the storage. */
+						Value*             values;
+						size_t             nbValues;
+						
+						/** Allocate 'nb' zeroed values. Their pages are not touched here, so that they are placed
+						 * by the threads computing the values if they can't be interleaved. */
+						void resizeData (size_t nb)
+						{
+							freeData ();
+							data     = (Value*) system::impl::System::memoryNuma().callocHuge (nb*sizeof(Value));
+							values   = data;
+							nbValues = nb;
+						}
+						
+						void freeData ()  {  system::impl::System::memoryNuma().free (data);  data = 0;  }
 						
 						
 					};
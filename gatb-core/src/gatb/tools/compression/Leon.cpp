@@ -1706,6 +1706,9 @@ void Leon::startDecompressionAllStreams(){
 			
 		case 2:             _progress_decode = new ProgressSynchro ( new Progress ( _blockCount/2, "Decompressing all streams"), System::thread().newSynchronizer()   );break;
 	}
+
+	/** The progress may also be written as JSON for monitoring tools. */
+	_progress_decode = ProgressJson::wrap (_progress_decode, _blockCount/2, "Decompressing all streams");
 	
 	
 	getInfo()->add(1, "Block count", "%u", _blockCount/2);
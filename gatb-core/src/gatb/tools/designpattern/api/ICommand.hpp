@@ -35,6 +35,7 @@
 #include <gatb/tools/designpattern/api/Iterator.hpp>
 
 #include <vector>
+#include <algorithm>
 
 /********************************************************************************/
 namespace gatb  {
@@ -145,6 +146,59 @@ public:
         size_t groupSize;
     };
 
+    /** Counters gathered on each dispatched command, when the counters are activated
+     * (see tools::misc::impl::TimeInfo::setCounters). Each command counts its own thread.
+     * From the values of the slowest command and the mean values of each dispatch, one can
+     * know the imbalance between the threads. */
+    struct CommandsCounters
+    {
+        CommandsCounters () : nbDispatches(0), nbCommands(0)  {}
+
+        /** Add the counters of the commands of one dispatch. */
+        void add (const std::vector<system::ISystemInfo::Counters>& commands)
+        {
+            if (commands.empty())  { return; }
+
+            system::ISystemInfo::Counters sum, max;
+            for (size_t i=0; i<commands.size(); i++)
+            {
+                sum += commands[i];
+                for (size_t k=0; k<system::ISystemInfo::Counters::NB_KINDS; k++)
+                {
+                    if (commands[i].available[k])
+                    {
+                        max.values[k]    = std::max (max.values[k], commands[i].values[k]);
+                        max.available[k] = true;
+                    }
+                }
+            }
+
+            system::ISystemInfo::Counters mean (sum);
+            for (size_t k=0; k<system::ISystemInfo::Counters::NB_KINDS; k++)  {  mean.values[k] /= commands.size();  }
+
+            total   += sum;
+            slowest += max;
+            average += mean;
+            nbDispatches ++;
+            nbCommands   += commands.size();
+        }
+
+        /** Get the imbalance for a kind of counter, ie. the ratio between the sum over the dispatches
+         * of the values of the slowest command and of the mean values (1 for perfectly balanced threads).
+         * \param[in] kind : kind of counter
+         * \return the imbalance, or 0 if the counter is not available. */
+        double getImbalance (size_t kind) const
+        {
+            return average.available[kind] && average.values[kind] > 0 ? (double)slowest.values[kind] / (double)average.values[kind] : 0;
+        }
+
+        size_t                          nbDispatches;
+        size_t                          nbCommands;
+        system::ISystemInfo::Counters   total;      // sum over all the commands
+        system::ISystemInfo::Counters   slowest;    // sum over the dispatches of the max over the commands
+        system::ISystemInfo::Counters   average;    // sum over the dispatches of the mean over the commands
+    };
+
     /** Dispatch commands execution in some separate contexts (threads for instance).
      *  Once the commands are launched, this dispatcher waits for the commands finish.
      *  Then, it may have to execute a post treatment command (if any).
@@ -230,8 +284,15 @@ public:
      * \return the number of items. */
     virtual size_t getGroupSize () const = 0;
 
+    /** Get the counters of the commands dispatched so far (empty if the counters are not activated).
+     * \return the counters. */
+    const CommandsCounters& getCommandsCounters () const  { return _commandsCounters; }
+
 protected:
 
+    /** Counters of the dispatched commands. */
+    CommandsCounters _commandsCounters;
+
     /** Factory method for synchronizer instantiation.
      * \return the created synchronizer. */
     virtual system::ISynchronizer* newSynchro () = 0;
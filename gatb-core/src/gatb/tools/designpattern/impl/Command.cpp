@@ -60,6 +60,33 @@ private:
     system::ISynchronizer* _synchro;
 };
 
+/** Command gathering the counters of the thread executing a delegate command. */
+class CommandCounters : public ICommand, public system::SmartPointer
+{
+public:
+
+    CommandCounters (ICommand* ref, system::ISystemInfo::Counters& counters) : _ref(0), _counters(counters)  { setRef(ref); }
+    ~CommandCounters ()  { setRef(0); }
+
+    void execute ()
+    {
+        system::ISystemInfo::CountersInfo* info = system::impl::System::info().createCountersInfo (true);
+        LOCAL (info);
+
+        info->start();
+        _ref->execute();
+        info->stop();
+
+        _counters = info->getCounters();
+    }
+
+private:
+    ICommand* _ref;
+    void setRef (ICommand* ref)  { SP_SETATTR(ref); }
+
+    system::ISystemInfo::Counters& _counters;
+};
+
 /********************************************************************************/
 class SynchronizerNull : public system::ISynchronizer, public system::SmartPointer
 {
@@ -80,11 +107,21 @@ size_t SerialDispatcher::dispatchCommands (std::vector<ICommand*>& commands, ICo
 {
     TIME_START (ti, "compute");
 
-    for (std::vector<ICommand*>::iterator it = commands.begin(); it != commands.end(); it++)
+    /** We may have to gather counters for each command. */
+    bool withCounters = tools::misc::impl::TimeInfo::getCounters();
+    std::vector<system::ISystemInfo::Counters> counters (withCounters ? commands.size() : 0);
+
+    size_t idx = 0;
+    for (std::vector<ICommand*>::iterator it = commands.begin(); it != commands.end(); it++, idx++)
     {
-        if (*it != 0)  {  (*it)->use ();  (*it)->execute ();  (*it)->forget ();  }
+        if (*it == 0)  { continue; }
+
+        if (withCounters)  {  CommandCounters cmd (*it, counters[idx]);  cmd.execute();  }
+        else               {  (*it)->use ();  (*it)->execute ();  (*it)->forget ();  }
     }
 
+    _commandsCounters.add (counters);
+
     /** We may have to do some post treatment. Note that we do it in the current thread. */
     if (post != 0)  {  post->use ();  post->execute ();  post->forget ();  }
 
@@ -106,6 +143,8 @@ system::ISynchronizer* SerialDispatcher::newSynchro ()
     return new SynchronizerNull();
 }
 
+bool Dispatcher::_bindThreads = false;
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -133,6 +172,10 @@ size_t Dispatcher::dispatchCommands (std::vector<ICommand*>& commands, ICommand*
 
     system::IThreadGroup* threadGroup = system::impl::ThreadGroup::create ();
 
+    /** We may have to gather counters for each command. */
+    bool withCounters = tools::misc::impl::TimeInfo::getCounters();
+    std::vector<system::ISystemInfo::Counters> counters (withCounters ? commands.size() : 0);
+
     size_t idx = 0;
 
     /** We create threads and add them to the thread group. */
@@ -145,9 +188,11 @@ size_t Dispatcher::dispatchCommands (std::vector<ICommand*>& commands, ICommand*
          *  Note that we provide here a IThreadGroup::Info instance as data for the main loop
          *  => it is important that at the beginning of the main loop we retrieved the correct
          *  type from the void* data. */
+        ICommand* cmd = withCounters ? (ICommand*) new CommandCounters (*it, counters[idx]) : *it;
+
         threadGroup->add (
             mainloop,
-            new IThreadGroup::Info (threadGroup,  new CommandStartSynchro (*it, threadGroup->getSynchro()), idx )
+            new IThreadGroup::Info (threadGroup,  new CommandStartSynchro (cmd, threadGroup->getSynchro()), idx )
         );
     }
 
@@ -160,6 +205,8 @@ size_t Dispatcher::dispatchCommands (std::vector<ICommand*>& commands, ICommand*
     /** Some cleanup. */
     system::impl::ThreadGroup::destroy (threadGroup);
 
+    _commandsCounters.add (counters);
+
     TIME_STOP (ti, "compute");
 
     /** We return the result. */
@@ -211,6 +258,9 @@ void* Dispatcher::mainloop (void* data)
     assert (threadGroup != 0);
     assert (cmd         != 0);
 
+    /** We may bind the thread to one core, according to its index in the group. */
+    if (_bindThreads)  {  system::impl::System::thread().bindThreadSelf (info->idx);  }
+
     /** Here, we should catch any exception thrown locally in a thread
      * and keep it to re-throw it in the main thread. */
     try
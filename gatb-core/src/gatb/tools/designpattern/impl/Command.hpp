@@ -114,8 +114,20 @@ public:
     /** \copydoc IDispatcher::getGroupSize */
     size_t getGroupSize () const  { return _groupSize; }
 
+    /** Bind (or not) each thread of the dispatchers of the process to one core (see IThreadFactory::bindThreadSelf),
+     * so that the threads don't migrate away from the memory they touched.
+     * \param[in] bind : true for binding the threads. */
+    static void setThreadsBinding (bool bind)  { _bindThreads = bind; }
+
+    /** Tells whether the threads of the dispatchers are bound to cores.
+     * \return true if the threads are bound. */
+    static bool getThreadsBinding ()  { return _bindThreads; }
+
 private:
 
+    /** */
+    static bool _bindThreads;
+
     /** */
     system::ISynchronizer* newSynchro ();
 
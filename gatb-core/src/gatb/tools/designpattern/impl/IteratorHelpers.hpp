@@ -29,6 +29,8 @@
 #include <gatb/tools/designpattern/api/Iterator.hpp>
 #include <set>
 #include <list>
+#include <vector>
+#include <algorithm>
 #include <boost/variant.hpp>
 
 /********************************************************************************/
@@ -765,6 +767,85 @@ protected:
 
 /********************************************************************************/
 
+/** \brief Iterator merging the sorted runs of a vector
+ *
+ * The vector is supposed to be a concatenation of sorted runs (for instance the content of a
+ * collection written through a collections::impl::BagCacheSorted); the runs are the maximal
+ * sorted sequences of the vector, so nothing else than the items is needed to find them.
+ *
+ * The items are iterated in increasing order: the runs are merged lazily, each 'next' taking
+ * the smallest item among the heads of the runs. The vector is neither copied nor modified.
+ */
+template <class Item> class SortedRunsIterator : public Iterator<Item>
+{
+public:
+
+    /** Constructor.
+     * \param[in] items : the sorted runs to be merged. */
+    SortedRunsIterator (const std::vector<Item>& items) : _items(items), _isDone(true)  {}
+
+    /** Destructor. */
+    virtual ~SortedRunsIterator () {}
+
+    /** \copydoc  Iterator::first */
+    void first()
+    {
+        /** We look for the runs, ie. the positions where the order is broken. */
+        _runs.clear();
+        size_t start = 0;
+        for (size_t i=1; i<_items.size(); i++)
+        {
+            if (_items[i] < _items[i-1])  {  _runs.push_back (Run (start, i));  start = i;  }
+        }
+        if (start < _items.size())  {  _runs.push_back (Run (start, _items.size()));  }
+
+        std::make_heap (_runs.begin(), _runs.end(), CompareRuns (_items));
+
+        next ();
+    }
+
+    /** \copydoc  Iterator::next */
+    void next()
+    {
+        _isDone = _runs.empty();
+        if (_isDone)  { return; }
+
+        /** We take the run with the smallest head and move forward in it. */
+        std::pop_heap (_runs.begin(), _runs.end(), CompareRuns (_items));
+
+        Run& run = _runs.back();
+        this->_item = (Item*) &(_items[run.first++]);
+
+        if (run.first < run.second)  {  std::push_heap (_runs.begin(), _runs.end(), CompareRuns (_items));  }
+        else                         {  _runs.pop_back();  }
+    }
+
+    /** \copydoc  Iterator::isDone */
+    bool isDone() {   return _isDone;  }
+
+    /** \copydoc  Iterator::item */
+    Item& item ()  { return *(this->_item); }
+
+private:
+
+    /** A run is defined by its current and end positions in the vector. */
+    typedef std::pair<size_t,size_t> Run;
+
+    /** Comparator for a heap giving the run with the smallest head. */
+    struct CompareRuns
+    {
+        CompareRuns (const std::vector<Item>& items) : _items(items)  {}
+        bool operator() (const Run& a, const Run& b) const  {  return _items[b.first] < _items[a.first];  }
+        const std::vector<Item>& _items;
+    };
+
+    const std::vector<Item>& _items;
+    std::vector<Run>         _runs;
+    bool                     _isDone;
+};
+
+/********************************************************************************/
+
 template <template <class> class IteratorType , typename T1, typename T2=T1, typename T3=T2, typename T4=T3>
 class IteratorVariant : public IteratorType <boost::variant<T1,T2,T3,T4> >
 {
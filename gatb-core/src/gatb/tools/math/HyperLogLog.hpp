@@ -0,0 +1,134 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file HyperLogLog.hpp
+ *  \brief Cardinality estimation of a stream of 64 bits hash values
+ */
+
+#ifndef _GATB_CORE_TOOLS_MATH_HYPERLOGLOG_HPP_
+#define _GATB_CORE_TOOLS_MATH_HYPERLOGLOG_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+#include <gatb/system/api/Exception.hpp>
+
+#include <vector>
+#include <cmath>
+
+/********************************************************************************/
+namespace gatb  {
+namespace core  {
+namespace tools {
+namespace math  {
+/********************************************************************************/
+
+/** \brief HyperLogLog cardinality estimator
+ *
+ * Estimates the number of distinct items of a stream with 2^precision registers of one
+ * byte each (ie. 16 KBytes for the default precision), with a standard error of about
+ * 1.04/sqrt(2^precision), ie. 0.8% for the default precision.
+ *
+ * The items are given as 64 bits hash values: the 'precision' high bits select the register,
+ * the position of the first set bit in the remaining bits is the register candidate value.
+ * With 64 bits hash values, no large range correction is needed; the small range correction
+ * (linear counting on the empty registers) is applied for small cardinalities.
+ *
+ * Two estimators with the same precision can be merged, which allows to fill one estimator
+ * per thread and to merge them at the end.
+ *
+ * Example:
+ * \code
+ *  HyperLogLog hll;
+ *  for (u_int64_t i=0; i<1000000; i++)  {  hll.add (hash1 (i, 0));  }
+ *  u_int64_t nbDistinct = hll.estimate();
+ * \endcode
+ */
+class HyperLogLog
+{
+public:
+
+    /** Constructor.
+     * \param[in] precision : log2 of the number of registers, in [4,18] */
+    HyperLogLog (size_t precision=14) : _precision(precision), _registers ((size_t)1 << precision, 0)
+    {
+        if (precision < 4 || precision > 18)  { throw system::Exception ("HyperLogLog: bad precision %d (should be in [4,18])", precision); }
+    }
+
+    /** Add an item to the estimator.
+     * \param[in] hash : 64 bits hash value of the item. */
+    void add (u_int64_t hash)
+    {
+        size_t    idx  = hash >> (64 - _precision);
+        u_int64_t w    = (hash << _precision) | ((u_int64_t)1 << (_precision-1)); // sentinel bit bounds the rank
+        u_int8_t  rank = __builtin_clzll (w) + 1;
+
+        if (rank > _registers[idx])  {  _registers[idx] = rank;  }
+    }
+
+    /** Merge another estimator into this one (the result estimates the union of both streams).
+     * \param[in] other : estimator to be merged, with the same precision. */
+    void merge (const HyperLogLog& other)
+    {
+        if (other._precision != _precision)  { throw system::Exception ("HyperLogLog: cannot merge precisions %d and %d", _precision, other._precision); }
+
+        for (size_t i=0; i<_registers.size(); i++)  {  if (other._registers[i] > _registers[i])  { _registers[i] = other._registers[i]; }  }
+    }
+
+    /** Get the estimated number of distinct items added so far.
+     * \return the cardinality estimation. */
+    u_int64_t estimate () const
+    {
+        double m     = _registers.size();
+        double sum   = 0;
+        size_t nbNul = 0;
+
+        for (size_t i=0; i<_registers.size(); i++)
+        {
+            sum += std::ldexp (1.0, - (int)_registers[i]);
+            if (_registers[i] == 0)  { nbNul++; }
+        }
+
+        double alpha = 0.7213 / (1.0 + 1.079 / m);
+        double E     = alpha * m * m / sum;
+
+        /** Small range correction. */
+        if (E <= 2.5*m && nbNul > 0)  {  E = m * std::log (m / (double)nbNul);  }
+
+        return (u_int64_t) (E + 0.5);
+    }
+
+    /** Reset the estimator. */
+    void clear ()  {  std::fill (_registers.begin(), _registers.end(), 0);  }
+
+    /** Get the precision of the estimator.
+     * \return log2 of the number of registers. */
+    size_t getPrecision () const  { return _precision; }
+
+private:
+
+    size_t                 _precision;
+    std::vector<u_int8_t>  _registers;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_MATH_HYPERLOGLOG_HPP_ */
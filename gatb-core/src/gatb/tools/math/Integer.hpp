@@ -32,6 +32,7 @@
 #include <boost/variant.hpp>
 #include <boost/mpl/vector.hpp>
 #include <boost/mpl/pop_front.hpp>
+#include <boost/mpl/front.hpp>
 #include <boost/mpl/int.hpp>
 #include <boost/mpl/at.hpp>
 
@@ -68,6 +69,10 @@ public:
 
     /** We define a boost variant from this type list. */
     typedef typename boost::make_variant_over<transfolist>::type Type;
+
+    /** Type of the first (ie. smallest) span. Most operators check it first and then bypass
+     * the visitor dispatch, since the smallest span is by far the most common. */
+    typedef typename boost::mpl::front<transfolist>::type FirstType;
     /* so, before, Type was defined as a plain boost::variant like this: 
      typedef typename boost::variant<LargeInt<1>, LargeInt<2>, LargeInt<3>, LargeInt<4> > Type;
      I checked: the new make_variant_over has no impact on runtime performance. Probably not surprising, as this code is probably purely compile-time.
@@ -127,7 +132,12 @@ public:
      * \param[in] b : second operand
      * \return sum of the two operands.
      */
-    inline friend IntegerTemplate   operator+  (const IntegerTemplate& a, const IntegerTemplate& b)  {  return  boost::apply_visitor (Integer_plus(),  *a, *b);  }
+    inline friend IntegerTemplate   operator+  (const IntegerTemplate& a, const IntegerTemplate& b)
+    {
+        const FirstType* x = a.first();  const FirstType* y = b.first();
+        if (x && y)  {  return IntegerTemplate (*x + *y);  }
+        return  boost::apply_visitor (Integer_plus(),  *a, *b);
+    }
 
     /** Operator -
      * \param[in] a : first operand
@@ -141,21 +151,36 @@ public:
      * \param[in] b : second operand
      * \return 'or' of the two operands.
      */
-    inline friend IntegerTemplate   operator|  (const IntegerTemplate& a, const IntegerTemplate& b)  {  return  boost::apply_visitor (Integer_or(),    *a, *b);  }
+    inline friend IntegerTemplate   operator|  (const IntegerTemplate& a, const IntegerTemplate& b)
+    {
+        const FirstType* x = a.first();  const FirstType* y = b.first();
+        if (x && y)  {  return IntegerTemplate (*x | *y);  }
+        return  boost::apply_visitor (Integer_or(),    *a, *b);
+    }
 
     /** Operator ^
      * \param[in] a : first operand
      * \param[in] b : second operand
      * \return 'xor' of the two operands.
      */
-    inline friend IntegerTemplate   operator^  (const IntegerTemplate& a, const IntegerTemplate& b)  {  return  boost::apply_visitor (Integer_xor(),   *a, *b);  }
+    inline friend IntegerTemplate   operator^  (const IntegerTemplate& a, const IntegerTemplate& b)
+    {
+        const FirstType* x = a.first();  const FirstType* y = b.first();
+        if (x && y)  {  return IntegerTemplate (*x ^ *y);  }
+        return  boost::apply_visitor (Integer_xor(),   *a, *b);
+    }
 
     /** Operator &
      * \param[in] a : first operand
      * \param[in] b : second operand
      * \return 'and' of the two operands.
      */
-    inline friend IntegerTemplate   operator&  (const IntegerTemplate& a, const IntegerTemplate& b)  {  return  boost::apply_visitor (Integer_and(),   *a, *b);  }
+    inline friend IntegerTemplate   operator&  (const IntegerTemplate& a, const IntegerTemplate& b)
+    {
+        const FirstType* x = a.first();  const FirstType* y = b.first();
+        if (x && y)  {  return IntegerTemplate (*x & *y);  }
+        return  boost::apply_visitor (Integer_and(),   *a, *b);
+    }
 
     /** Operator ~
      * \param[in] a : operand
@@ -168,7 +193,12 @@ public:
      * \param[in] b : second operand
      * \return equality of the two operands.
      */
-    inline friend bool      operator== (const IntegerTemplate& a, const IntegerTemplate& b)  {  return  boost::apply_visitor (Integer_equals(), *a, *b);  }
+    inline friend bool      operator== (const IntegerTemplate& a, const IntegerTemplate& b)
+    {
+        const FirstType* x = a.first();  const FirstType* y = b.first();
+        if (x && y)  {  return *x == *y;  }
+        return  boost::apply_visitor (Integer_equals(), *a, *b);
+    }
 
     /** Operator !=
      * \param[in] a : first operand
@@ -182,7 +212,12 @@ public:
      * \param[in] b : second operand
      * \return '<' of the two operands.
      */
-    inline friend bool      operator<  (const IntegerTemplate& a, const IntegerTemplate& b)  {  return  boost::apply_visitor (Integer_less(),   *a, *b);  }
+    inline friend bool      operator<  (const IntegerTemplate& a, const IntegerTemplate& b)
+    {
+        const FirstType* x = a.first();  const FirstType* y = b.first();
+        if (x && y)  {  return *x < *y;  }
+        return  boost::apply_visitor (Integer_less(),   *a, *b);
+    }
 
     /** Operator <=
      * \param[in] a : first operand
@@ -243,27 +278,43 @@ public:
      * \param[in] idx : index of the nucleotide to be retrieved
      * \return the nucleotide value as follow: A=0, C=1, T=2 and G=3
      */
-    u_int8_t  operator[]  (size_t idx) const   { return  boost::apply_visitor (Integer_value_at(idx), *(*this)); }
+    u_int8_t  operator[]  (size_t idx) const
+    {
+        if (const FirstType* x = first())  {  return (*x)[idx];  }
+        return  boost::apply_visitor (Integer_value_at(idx), *(*this));
+    }
 
     /** Get the reverse complement of a kmer encoded as an IntegerTemplate object. Note that the kmer size must be known.
      * \param[in] a : kmer value to be reversed-complemented
      * \param[in] sizeKmer : size of the kmer
      * \return the reverse complement kmer as a IntegerTemplate value
      */
-    friend IntegerTemplate revcomp (const IntegerTemplate& a,  size_t sizeKmer)  {  return  boost::apply_visitor (Integer_revcomp(sizeKmer),  *a);  }
+    friend IntegerTemplate revcomp (const IntegerTemplate& a,  size_t sizeKmer)
+    {
+        if (const FirstType* x = a.first())  {  return IntegerTemplate (revcomp (*x, sizeKmer));  }
+        return  boost::apply_visitor (Integer_revcomp(sizeKmer),  *a);
+    }
 
     /** Get a hash value on 64 bits for a given IntegerTemplate object.
      * \param[in] a : the integer value
      * \param[in] seed : some seed value used for the hash computation.
      * \return the hash value on 64 bits.
      */
-    friend u_int64_t hash1        (const IntegerTemplate& a,  u_int64_t seed)  {  return  boost::apply_visitor (Integer_hash1(seed),  *a);          }
+    friend u_int64_t hash1        (const IntegerTemplate& a,  u_int64_t seed)
+    {
+        if (const FirstType* x = a.first())  {  return hash1 (*x, seed);  }
+        return  boost::apply_visitor (Integer_hash1(seed),  *a);
+    }
 
     /** Get a hash value on 64 bits for a given IntegerTemplate object.
      * \param[in] a : the integer value
      * \return the hash value on 64 bits.
      */
-    friend u_int64_t oahash       (const IntegerTemplate& a)                   {  return  boost::apply_visitor (Integer_oahash(), *a);              }
+    friend u_int64_t oahash       (const IntegerTemplate& a)
+    {
+        if (const FirstType* x = a.first())  {  return oahash (*x);  }
+        return  boost::apply_visitor (Integer_oahash(), *a);
+    }
 
     /** Get a hash value on 64 bits for a given IntegerTemplate object.
      * Note: although we return 64 bits, only the first 16 bits are set
@@ -439,6 +490,9 @@ private:
           Type& operator *()       { return v; }
     const Type& operator *() const { return v; }
 
+    /** Fast path accessor: returns the value if it holds the first span type, 0 otherwise. */
+    const FirstType* first () const  {  return boost::get<FirstType> (&v);  }
+
 
     /** Now, we define the Apply structure that allows to find the correct implementation of LargeInt
      * according to the given kmerSize (at runtime). */
@@ -83,6 +83,9 @@ namespace math  {
  *  This template class may have a specialization for precision=2. If the used operating
  *  system allows it, native 128 bits integers are used.
  *
+ *  This template class has a specialization for precision=3 (kmers up to 96 nucleotides), where
+ *  the three words are handled explicitly with branch-free shifts and comparisons.
+ *
  *  In the other cases, the LargeInt provides a generic integer calculus class. Note that
  *  such an implementation could be optimized in several ways, including direct assembly
  *  code for maximum speed.
@@ -722,13 +725,12 @@ private:
 template<int precision>  inline LargeInt<precision> revcomp (const LargeInt<precision>& x, size_t sizeKmer)
 {
     LargeInt<precision> res;
-    res.setVal(0);
-    unsigned char* kmerrev  = (unsigned char *) (&(res.value[0]));
-    unsigned char* kmer     = (unsigned char *) (&(x.value[0]));
 
-    for (size_t i=0; i<8*precision; ++i)
+    /** We reverse the order of the words and reverse complement each of them (no more
+     * byte per byte revcomp_4NT lookups), then we align the result on the kmer size. */
+    for (size_t i=0; i<precision; ++i)
     {
-        kmerrev[8*precision-1-i] = revcomp_4NT [kmer[i]];
+        res.value[precision-1-i] = NativeInt64::revcompWord (x.value[i]);
     }
 
     return (res >> (2*( 32*precision - sizeKmer))  ) ;
@@ -879,6 +881,11 @@ template<int precision> inline void justSweepForAA(const LargeInt<precision>& x,
 /********************************************************************************/
 #include <gatb/tools/math/LargeInt2.pri> 
 
+/********************************************************************************/
+/********************     SPECIALIZATION FOR precision=3     ********************/
+/********************************************************************************/
+#include <gatb/tools/math/LargeInt3.pri>
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
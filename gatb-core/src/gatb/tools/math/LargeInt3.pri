@@ -0,0 +1,341 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file LargeInt<3>.hpp
+ *  \brief Integer class relying on three u_int64_t words (kmers up to 96 nucleotides)
+ *
+ *  The generic LargeInt implementation loops over the words and branches on the shift
+ *  sizes. Here the three words are handled explicitly: shifts are done with a word
+ *  selection followed by a bit shift (no branch on the shift amount), comparisons are
+ *  computed with boolean arithmetic, and the revcomp works on whole words.
+ *
+ *  The memory layout (u_int64_t value[3], lowest word first) is the same as the generic
+ *  LargeInt<3>, so serialized kmers are unchanged.
+ */
+
+/********************************************************************************/
+
+template<>  class LargeInt<3>
+{
+public:
+
+#ifdef USE_LARGEINT_CONSTRUCTOR
+    /** Constructor.
+     * \param[in] c : initial value of the large integer. */
+    LargeInt<3> (const u_int64_t& c=0)  {  value[0] = c;  value[1] = 0;  value[2] = 0;  }
+#endif
+
+    u_int64_t getVal () const  { return value[0]; }
+    inline void setVal (u_int64_t c)  {  value[0] = c;  value[1] = 0;  value[2] = 0;  }
+    inline void setVal (const LargeInt<3>& c)  {  value[0] = c.value[0];  value[1] = c.value[1];  value[2] = c.value[2];  }
+
+    static const char* getName ()  { return "LargeInt<3>"; }
+
+    static size_t getSize ()  { return 8*sizeof(u_int64_t)*3; }
+
+    /** Returns lower 64 bits */
+    u_int64_t toInt () const  {  throw system::Exception ("LargeInt<3> no support of toInt");  }
+
+    /********************************************************************************/
+    LargeInt<3> operator+  (const LargeInt<3>& other)   const
+    {
+        LargeInt<3> res;
+        u_int64_t carry;
+        res.value[0] = value[0] + other.value[0];            carry  = res.value[0] < value[0];
+        res.value[1] = value[1] + other.value[1] + carry;    carry  = (res.value[1] < value[1]) | ((res.value[1] == value[1]) & carry);
+        res.value[2] = value[2] + other.value[2] + carry;
+        return res;
+    }
+
+    LargeInt<3> operator+  (const u_int64_t& other)     const
+    {
+        LargeInt<3> res;
+        u_int64_t carry;
+        res.value[0] = value[0] + other;      carry = res.value[0] < value[0];
+        res.value[1] = value[1] + carry;      carry = res.value[1] < value[1];
+        res.value[2] = value[2] + carry;
+        return res;
+    }
+
+    LargeInt<3> operator-  (const LargeInt<3>& other)   const
+    {
+        LargeInt<3> res;
+        u_int64_t borrow;
+        res.value[0] = value[0] - other.value[0];             borrow = res.value[0] > value[0];
+        res.value[1] = value[1] - other.value[1] - borrow;    borrow = (res.value[1] > value[1]) | ((res.value[1] == value[1]) & borrow);
+        res.value[2] = value[2] - other.value[2] - borrow;
+        return res;
+    }
+
+    LargeInt<3> operator-  (const u_int64_t& other)     const
+    {
+        LargeInt<3> res;
+        u_int64_t borrow;
+        res.value[0] = value[0] - other;      borrow = res.value[0] > value[0];
+        res.value[1] = value[1] - borrow;     borrow = res.value[1] > value[1];
+        res.value[2] = value[2] - borrow;
+        return res;
+    }
+
+    LargeInt<3> operator|  (const LargeInt<3>& other)   const   {  LargeInt<3> res;  for (int i=0; i<3; i++)  { res.value[i] = value[i] | other.value[i]; }  return res;  }
+    LargeInt<3> operator^  (const LargeInt<3>& other)   const   {  LargeInt<3> res;  for (int i=0; i<3; i++)  { res.value[i] = value[i] ^ other.value[i]; }  return res;  }
+    LargeInt<3> operator&  (const LargeInt<3>& other)   const   {  LargeInt<3> res;  for (int i=0; i<3; i++)  { res.value[i] = value[i] & other.value[i]; }  return res;  }
+    LargeInt<3> operator&  (const char& other)          const   {  LargeInt<3> res;  res.setVal (value[0] & other);  return res;  }
+    LargeInt<3> operator~  ()                           const   {  LargeInt<3> res;  for (int i=0; i<3; i++)  { res.value[i] = ~value[i]; }  return res;  }
+
+    /********************************************************************************/
+    /** Same restrictions as the generic implementation: minia only multiplies by 2, 4 and 21. */
+    LargeInt<3> operator*  (const int& coeff)           const
+    {
+        if (coeff == 2 || coeff == 4)  {  return (*this) << (coeff / 2);  }
+        if (coeff == 21)               {  return ((*this) << 4) + ((*this) << 2) + (*this);  }
+
+        printf("unsupported LargeInt multiplication: %d\n",coeff);
+        exit(1);
+    }
+
+    /********************************************************************************/
+    LargeInt<3> operator/  (const u_int32_t& divisor)   const
+    {
+        LargeInt<3> res;
+        res.setVal(0);
+
+        u_int64_t r = 0;
+        const u_int64_t mask32bits = 0xFFFFFFFF;
+        for (int i = 2; i >= 0; --i)
+        {
+            for (int j = 1; j >= 0; --j)
+            {
+                u_int64_t n = (r << 32) | ((value[i] >> (32*j)) & mask32bits);
+                res.value[i] |= ((n / divisor) & mask32bits) << (32*j);
+                r = n % divisor;
+            }
+        }
+        return res;
+    }
+
+    u_int32_t   operator%  (const u_int32_t& divisor)   const
+    {
+        u_int64_t r = 0;
+        const u_int64_t mask32bits = 0xFFFFFFFF;
+        for (int i = 2; i >= 0; --i)
+        {
+            r = ((r << 32) | (value[i] >> 32))         % divisor;
+            r = ((r << 32) | (value[i] & mask32bits))  % divisor;
+        }
+        return (u_int32_t)r;
+    }
+
+    /********************************************************************************/
+    /** Operator <<. The word shift is done with selections (compiled as conditional moves),
+     * and the bit shift pulls the carried bits from the previous word; '(x>>1) >> (63-s)'
+     * avoids the undefined shift by 64 when s==0, so there is no branch on the shift amount.
+     * \param[in] coeff : operand, in [0,192]
+     * \return left shift of the object
+     */
+    LargeInt<3> operator<< (const int& coeff)           const
+    {
+        const int w = coeff >> 6;
+        const int s = coeff & 63;
+
+        const u_int64_t r0 = w==0 ? value[0] : 0;
+        const u_int64_t r1 = w==0 ? value[1] : (w==1 ? value[0] : 0);
+        const u_int64_t r2 = w==0 ? value[2] : (w==1 ? value[1] : (w==2 ? value[0] : 0));
+
+        LargeInt<3> res;
+        res.value[0] = (r0 << s);
+        res.value[1] = (r1 << s) | ((r0 >> 1) >> (63-s));
+        res.value[2] = (r2 << s) | ((r1 >> 1) >> (63-s));
+        return res;
+    }
+
+    /** Operator >>. Same scheme as operator<<.
+     * \param[in] coeff : operand, in [0,192]
+     * \return right shift of the object
+     */
+    LargeInt<3> operator>> (const int& coeff)           const
+    {
+        const int w = coeff >> 6;
+        const int s = coeff & 63;
+
+        const u_int64_t r2 = w==0 ? value[2] : 0;
+        const u_int64_t r1 = w==0 ? value[1] : (w==1 ? value[2] : 0);
+        const u_int64_t r0 = w==0 ? value[0] : (w==1 ? value[1] : (w==2 ? value[2] : 0));
+
+        LargeInt<3> res;
+        res.value[2] = (r2 >> s);
+        res.value[1] = (r1 >> s) | ((r2 << 1) << (63-s));
+        res.value[0] = (r0 >> s) | ((r1 << 1) << (63-s));
+        return res;
+    }
+
+    /********************************************************************************/
+    bool operator== (const LargeInt<3>& c) const  {  return ((value[0] ^ c.value[0]) | (value[1] ^ c.value[1]) | (value[2] ^ c.value[2])) == 0;  }
+    bool operator== (const u_int64_t&   c) const  {  return ((value[0] ^ c) | value[1] | value[2]) == 0;  }
+    bool operator!= (const LargeInt<3>& c) const  {  return ! (*this == c);  }
+    bool operator!= (const u_int64_t&   c) const  {  return ! (*this == c);  }
+
+    /** Lexicographic comparison of the words, computed without branches. */
+    bool operator<  (const LargeInt<3>& c) const
+    {
+        /** borrow of the subtraction (*this - c), which the compiler keeps branch free */
+        u_int64_t borrow = value[0] < c.value[0];
+        borrow = (value[1] < c.value[1]) + ((value[1] - c.value[1]) < borrow);
+        borrow = (value[2] < c.value[2]) + ((value[2] - c.value[2]) < borrow);
+        return borrow;
+    }
+
+    bool operator<= (const LargeInt<3>& c) const  {  return ! (c < *this);  }
+
+    /********************************************************************************/
+    LargeInt<3>& operator+=  (const LargeInt<3>& other)    {  *this = *this + other;  return *this; }
+    LargeInt<3>& operator+=  (const u_int64_t& other)      {  *this = *this + other;  return *this; }
+    LargeInt<3>& operator^=  (const LargeInt<3>& other)    {  for (int i=0; i<3; i++)  { value[i] ^= other.value[i]; }  return *this; }
+    LargeInt<3>& operator&=  (const LargeInt<3>& other)    {  for (int i=0; i<3; i++)  { value[i] &= other.value[i]; }  return *this; }
+    LargeInt<3>& operator|=  (const LargeInt<3>& other)    {  for (int i=0; i<3; i++)  { value[i] |= other.value[i]; }  return *this; }
+
+    LargeInt<3>& operator<<=  (const int& coeff)  {  *this = *this << coeff;  return *this; }
+    LargeInt<3>& operator>>=  (const int& coeff)  {  *this = *this >> coeff;  return *this; }
+
+    /********************************************************************************/
+    LargeInt<3>& sync_fetch_and_or (const LargeInt<3>& other)
+    {
+        for (int i=0 ; i < 3 ; i++)  {  __sync_fetch_and_or (this->value + i, other.value[i]); }
+        return *this;
+    }
+
+    LargeInt<3>& sync_fetch_and_and (const LargeInt<3>& other)
+    {
+        for (int i=0 ; i < 3 ; i++)  {  __sync_fetch_and_and (this->value + i, other.value[i]); }
+        return *this;
+    }
+
+    u_int8_t  operator[]  (size_t idx) const   {  return (value[idx/32] >> (2*(idx % 32))) & 3; }
+
+    /********************************************************************************/
+    friend std::ostream & operator<<(std::ostream & s, const LargeInt<3> & l)
+    {
+        int i=0;
+        s << std::hex;
+        for (i=2; i>=0 && l.value[i]==0; i--)  {}
+        for (  ; i>=0 ; i--)  { s << l.value[i];   if (i>=1) { s << ".";  }  }
+        s << std::dec;
+        return s;
+    }
+
+    /********************************************************************************/
+    /** Print corresponding kmer in ASCII
+     * \param[sizeKmer] in : kmer size (def=96).
+     */
+    std::string toString (size_t sizeKmer) const
+    {
+        char seq[97];
+        char bin2NT[4] = {'A','C','T','G'};
+
+        for (size_t i=0; i<sizeKmer; i++)  {  seq[sizeKmer-i-1] = bin2NT [(*this)[i]];  }
+        seq[sizeKmer]='\0';
+        return seq;
+    }
+
+    /********************************************************************************/
+    inline static hid_t hdf5 (bool& isCompound)
+    {
+        hid_t result = H5Tcopy (H5T_NATIVE_INT);
+        H5Tset_precision (result, 64*3);
+        return result;
+    }
+
+    /********************************************************************************/
+    template<typename Map>
+    static LargeInt<3> polynom (const char* data, size_t size, Map fct)
+    {
+        LargeInt<3> res;
+        res.setVal(0);
+        for (size_t i=0; i<size; ++i)  {  res = (res << 2) + (u_int64_t) fct(data[i]);  }
+        return res;
+    }
+
+private:
+    u_int64_t value[3];
+
+    friend LargeInt<3> revcomp (const LargeInt<3>& i,   size_t sizeKmer);
+    friend u_int64_t    hash1    (const LargeInt<3>& key, u_int64_t  seed);
+    friend u_int64_t    hash2    (const LargeInt<3>& key, u_int64_t  seed);
+    friend u_int64_t    oahash  (const LargeInt<3>& key);
+    friend u_int64_t    simplehash16    (const LargeInt<3>& key, int  shift);
+    template<int T, typename m_T>  \
+                     friend void fastLexiMinimizer (const LargeInt<T>& key, const unsigned int _nbMinimizers, \
+                             const unsigned int m, m_T &minimizer, size_t &position, bool &validResult);
+    template<int T>  friend void justSweepForAA(const LargeInt<T>& x, const unsigned int _nbMinimizers, unsigned int &dummy);
+};
+
+/********************************************************************************/
+inline LargeInt<3> revcomp (const LargeInt<3>& x, size_t sizeKmer)
+{
+    //  the three words are swapped and reverse complemented as a whole, then the result
+    //  is shifted back so that the kmer occupies the 2*sizeKmer lowest bits.
+    LargeInt<3> res;
+    res.value[2] = NativeInt64::revcompWord (x.value[0]);
+    res.value[1] = NativeInt64::revcompWord (x.value[1]);
+    res.value[0] = NativeInt64::revcompWord (x.value[2]);
+    return res >> (2*(96 - sizeKmer));
+}
+
+/********************************************************************************/
+inline u_int64_t hash1 (const LargeInt<3>& elem, u_int64_t seed=0)
+{
+    return NativeInt64::hash64 (elem.value[0],seed) ^
+           NativeInt64::hash64 (elem.value[1],seed) ^
+           NativeInt64::hash64 (elem.value[2],seed);
+}
+
+inline u_int64_t hash2 (const LargeInt<3>& elem, u_int64_t seed=0)
+{
+    u_int64_t result = 0, key;
+
+    for (size_t i=0;i<3;i++)
+    {
+        // from inline uint64_t twang_mix64(uint64_t key) taken from https://github.com/facebook/folly/blob/master/folly/Hash.h
+        key = elem.value[i];
+        key = (~key) + (key << 21);  // key *= (1 << 21) - 1; key -= 1;
+        key = key ^ (key >> 24);
+        key = key + (key << 3) + (key << 8);  // key *= 1 + (1 << 3) + (1 << 8)
+        key = key ^ (key >> 14);
+        key = key + (key << 2) + (key << 4);  // key *= 1 + (1 << 2) + (1 << 4)
+        key = key ^ (key >> 28);
+        key = key + (key << 31);  // key *= 1 + (1 << 31)
+
+        result ^= key;
+    }
+    return result;
+}
+
+/********************************************************************************/
+inline u_int64_t oahash (const LargeInt<3>& elem)
+{
+    return NativeInt64::oahash64 (elem.value[0]) ^
+           NativeInt64::oahash64 (elem.value[1]) ^
+           NativeInt64::oahash64 (elem.value[2]);
+}
+
+/********************************************************************************/
+inline u_int64_t simplehash16 (const LargeInt<3>& elem, int  shift)
+{
+    return NativeInt64::simplehash16_64 (elem.value[0], shift);
+}
@@ -143,16 +143,26 @@ public:
 
     
     /********************************************************************************/
-    inline static u_int64_t revcomp64 (const u_int64_t& x, size_t sizeKmer)
+    /** Reverse complement of a full 64 bits word (ie. 32 nucleotides), with word-level bit tricks
+     * instead of the byte per byte revcomp_4NT lookup. This is the building block of the revcomp
+     * of all the LargeInt specializations.
+     * \param[in] x : the word to be reverse complemented
+     * \return the reverse complement of the 32 nucleotides of the word.
+     */
+    inline static u_int64_t revcompWord (u_int64_t x)
     {
-        u_int64_t res = x;
-
-        unsigned char* kmerrev  = (unsigned char *) (&(res));
-        unsigned char* kmer     = (unsigned char *) (&(x));
-
-        for (size_t i=0; i<8; ++i)  {  kmerrev[8-1-i] = revcomp_4NT [kmer[i]];  }
+        x = ((x>> 2 & 0x3333333333333333) | (x & 0x3333333333333333) <<  2);
+        x = ((x>> 4 & 0x0F0F0F0F0F0F0F0F) | (x & 0x0F0F0F0F0F0F0F0F) <<  4);
+        x = ((x>> 8 & 0x00FF00FF00FF00FF) | (x & 0x00FF00FF00FF00FF) <<  8);
+        x = ((x>>16 & 0x0000FFFF0000FFFF) | (x & 0x0000FFFF0000FFFF) << 16);
+        x = ((x>>32 & 0x00000000FFFFFFFF) | (x & 0x00000000FFFFFFFF) << 32);
+        return x ^ 0xAAAAAAAAAAAAAAAA;
+    }
 
-        return (res >> (2*( 32 - sizeKmer))) ;
+    /********************************************************************************/
+    inline static u_int64_t revcomp64 (const u_int64_t& x, size_t sizeKmer)
+    {
+        return (revcompWord (x) >> (2*( 32 - sizeKmer))) ;
     }
 
 	
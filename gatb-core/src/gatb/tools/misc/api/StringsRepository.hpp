@@ -96,6 +96,10 @@ public:
     const char* prefix         ()  { return "-prefix";         }
     const char* progress_bar   ()  { return "-bargraph";       }
     const char* nb_cores       ()  { return "-nb-cores";       }
+    const char* bind_cores     ()  { return "-bind-cores";     }
+    const char* counters       ()  { return "-counters";       }
+    const char* progress_json  ()  { return "-progress-json";  }
+    const char* progress_period ()  { return "-progress-period"; }
     const char* partition_type ()  { return "-partition-type"; }
     const char* histogram_max  ()  { return "-histo-max";      }
     const char* uri_debloom    ()  { return "-debloom";        }
@@ -123,6 +127,9 @@ public:
     const char* repartition_type() { return "-repartition-type"; }
     const char* compress_level()   { return "-out-compress"; }
     const char* config_only()      { return "-config-only"; }
+    const char* config_sample()    { return "-config-sample"; }
+    const char* pipeline_passes()  { return "-pipeline-passes"; }
+    const char* cache_reads()      { return "-cache-reads"; }
     const char* storage_type()     { return "-storage-type"; }
     const char* kff()              { return "-kff"; }
 
@@ -155,6 +162,10 @@ public:
 #define STR_PREFIX              gatb::core::tools::misc::StringRepository::singleton().prefix ()
 #define STR_PROGRESS_BAR        gatb::core::tools::misc::StringRepository::singleton().progress_bar ()
 #define STR_NB_CORES            gatb::core::tools::misc::StringRepository::singleton().nb_cores ()
+#define STR_BIND_CORES          gatb::core::tools::misc::StringRepository::singleton().bind_cores ()
+#define STR_COUNTERS            gatb::core::tools::misc::StringRepository::singleton().counters ()
+#define STR_PROGRESS_JSON       gatb::core::tools::misc::StringRepository::singleton().progress_json ()
+#define STR_PROGRESS_PERIOD     gatb::core::tools::misc::StringRepository::singleton().progress_period ()
 #define STR_PARTITION_TYPE      gatb::core::tools::misc::StringRepository::singleton().partition_type ()
 #define STR_HISTOGRAM_MAX       gatb::core::tools::misc::StringRepository::singleton().histogram_max ()
 #define STR_URI_DEBLOOM         gatb::core::tools::misc::StringRepository::singleton().uri_debloom ()
@@ -181,6 +192,9 @@ public:
 #define STR_REPARTITION_TYPE    gatb::core::tools::misc::StringRepository::singleton().repartition_type()
 #define STR_COMPRESS_LEVEL      gatb::core::tools::misc::StringRepository::singleton().compress_level()
 #define STR_CONFIG_ONLY         gatb::core::tools::misc::StringRepository::singleton().config_only()
+#define STR_CONFIG_SAMPLE       gatb::core::tools::misc::StringRepository::singleton().config_sample()
+#define STR_PIPELINE_PASSES     gatb::core::tools::misc::StringRepository::singleton().pipeline_passes()
+#define STR_CACHE_READS         gatb::core::tools::misc::StringRepository::singleton().cache_reads()
 #define STR_STORAGE_TYPE        gatb::core::tools::misc::StringRepository::singleton().storage_type ()
 #define STR_KFF                 gatb::core::tools::misc::StringRepository::singleton().kff()
 
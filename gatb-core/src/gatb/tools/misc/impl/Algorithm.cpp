@@ -21,6 +21,7 @@
 #include <gatb/system/impl/System.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
+#include <gatb/tools/misc/impl/ProgressJson.hpp>
 #include <gatb/tools/designpattern/impl/Command.hpp>
 
 #define DEBUG(a)  printf a
@@ -88,16 +89,52 @@ void Algorithm::run ()
     ISystemInfo::CpuInfo* cpuinfo = System::info().createCpuInfo();
     LOCAL (cpuinfo);
 
+    /** We may count some hardware and operating system events of the whole process. */
+    ISystemInfo::CountersInfo* counters = TimeInfo::getCounters() ? System::info().createCountersInfo(false) : 0;
+    LOCAL (counters);
+
+    /** We may have to notify the monitoring tools (see ProgressJsonSink). */
+    ProgressJsonSink& sink = ProgressJsonSink::singleton();
+    if (sink.isOpen())  { sink.beginStage (getName()); }
+
     cpuinfo->start();
+    if (counters)  { counters->start(); }
 
     /** We execute the algorithm. */
     this->execute ();
 
+    if (counters)  { counters->stop(); }
     cpuinfo->stop();
 
     /** We gather some system information. */
     getSystemInfo()->add (1, "system");
     getSystemInfo()->add (2, "cpu",         "%.1f", cpuinfo->getUsage());
+
+    /** The counters go with the statistics of the algorithm, so they are saved with them (see Graph). */
+    if (counters)
+    {
+        getInfo()->add (1, "counters");
+        TimeInfo::addCounters (getInfo(), 2, counters->getCounters());
+
+        /** We give the counters of the dispatched commands, and the imbalance between them. */
+        const IDispatcher::CommandsCounters& commands = getDispatcher()->getCommandsCounters();
+
+        if (commands.nbDispatches > 0)
+        {
+            getInfo()->add (1, "commands");
+            getInfo()->add (2, "nb_dispatches", "%ld", commands.nbDispatches);
+            getInfo()->add (2, "nb_commands",   "%ld", commands.nbCommands);
+            TimeInfo::addCounters (getInfo(), 2, commands.total);
+
+            getInfo()->add (2, "imbalance");
+            for (size_t k=0; k<ISystemInfo::Counters::NB_KINDS; k++)
+            {
+                if (commands.average.available[k])  {  getInfo()->add (3, ISystemInfo::Counters::getName(k), "%.2f", commands.getImbalance(k));  }
+            }
+        }
+    }
+
+    if (sink.isOpen())  { sink.endStage (getName(), getInfo()); }
 }
 
 /*********************************************************************
@@ -110,15 +147,18 @@ void Algorithm::run ()
 *********************************************************************/
 dp::IteratorListener* Algorithm::createIteratorListener (size_t nbIterations, const char* message)
 {
-    if (getInput()->get(STR_VERBOSE)==0)  { return new IteratorListener(); }
+    IteratorListener* result = 0;
 
-    switch (getInput()->getInt(STR_VERBOSE))
+    switch (getInput()->get(STR_VERBOSE) ? getInput()->getInt(STR_VERBOSE) : 0)
     {
-        case 0: default:    return new IteratorListener ();
-        case 1:             return new ProgressTimerAndSystem   (nbIterations, message);
-        case 2:             return new ProgressTimer            (nbIterations, message);
-        case 3:             return new Progress                 (nbIterations, message);
+        case 0: default:    result = new IteratorListener ();                                   break;
+        case 1:             result = new ProgressTimerAndSystem   (nbIterations, message);      break;
+        case 2:             result = new ProgressTimer            (nbIterations, message);      break;
+        case 3:             result = new Progress                 (nbIterations, message);      break;
     }
+
+    /** The progress may also be written as JSON for monitoring tools. */
+    return ProgressJson::wrap (result, nbIterations, message);
 }
 
 /********************************************************************************/
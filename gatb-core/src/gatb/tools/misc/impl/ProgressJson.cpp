@@ -0,0 +1,667 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/tools/misc/impl/ProgressJson.hpp>
+#include <gatb/tools/misc/api/StringsRepository.hpp>
+
+#include <json/json.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+/********************************************************************************/
+namespace gatb {  namespace core { namespace tools {  namespace misc {  namespace impl {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ProgressJsonSink& ProgressJsonSink::singleton ()
+{
+    static ProgressJsonSink instance;
+    return instance;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ProgressJsonSink::ProgressJsonSink ()
+    : _isOpen(false), _isStopped(true), _fd(-1), _isSocket(false), _period(1.0),
+      _synchro(0), _thread(0), _cpuinfo(0), _t0(0), _taskT0(0), _done(0), _todo(0), _stages(0)
+{
+    _synchro = System::thread().newSynchronizer();
+    _cpuinfo = System::info().createCpuInfo();  _cpuinfo->use();
+    _stages  = new json::JSON (json::JSON::Make (json::JSON::Class::Array));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the sink is supposed to be closed by its user (see Scope)
+*********************************************************************/
+ProgressJsonSink::~ProgressJsonSink ()
+{
+    delete _stages;
+    _cpuinfo->forget();
+    delete _synchro;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool ProgressJsonSink::open (const std::string& uri, double period, const std::string& tmpDir)
+{
+    if (_isOpen)  { return false; }
+
+    static const string socketPrefix = "unix:";
+
+    _isSocket = uri.compare (0, socketPrefix.size(), socketPrefix) == 0;
+
+    if (_isSocket)
+    {
+        string path = uri.substr (socketPrefix.size());
+
+        struct sockaddr_un addr;
+        memset (&addr, 0, sizeof(addr));
+        if (path.size() >= sizeof(addr.sun_path))  { throw Exception ("Socket path '%s' is too long", path.c_str()); }
+
+        addr.sun_family = AF_UNIX;
+        strncpy (addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+
+        _fd = socket (AF_UNIX, SOCK_STREAM, 0);
+        if (_fd < 0)  { throw ExceptionErrno ("Unable to create socket for '%s'", path.c_str()); }
+
+        if (connect (_fd, (struct sockaddr*) &addr, sizeof(addr)) < 0)
+        {
+            ExceptionErrno e ("Unable to connect to socket '%s'", path.c_str());
+            ::close (_fd);  _fd = -1;
+            throw e;
+        }
+
+#ifdef SO_NOSIGPIPE
+        /** A monitoring tool that stops listening must not kill the job. */
+        int one = 1;  setsockopt (_fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    }
+    else
+    {
+        _fd = ::open (uri.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (_fd < 0)  { throw ExceptionErrno ("Unable to create file '%s'", uri.c_str()); }
+    }
+
+    _period = period > 0 ? period : 1.0;
+    _tmpDir = tmpDir.empty() ? System::file().getTemporaryDirectory() : tmpDir;
+
+    _t0     = System::time().getTimeStamp();
+    _taskT0 = _t0;
+    _task   = "";
+    _done   = 0;
+    _todo   = 0;
+    _runningStages.clear();
+    *_stages = json::JSON::Make (json::JSON::Class::Array);
+
+    _cpuinfo->start();
+
+    /** We launch the thread writing the snapshots. */
+    _isStopped = false;
+    _isOpen    = true;
+    _thread    = System::thread().newThread (mainloop, this);
+
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJsonSink::close (IProperties* info, const std::string& status)
+{
+    if (!_isOpen)  { return; }
+
+    /** We stop the thread writing the snapshots. */
+    _isStopped = true;
+    _thread->join();
+    delete _thread;
+    _thread = 0;
+
+    LocalSynchronizer l (_synchro);
+
+    json::JSON report;
+    report["type"]       = "report";
+    report["status"]     = status;
+    report["time"]       = (System::time().getTimeStamp() - _t0) / 1000.0;
+    report["mem_max_mb"] = System::info().getMemorySelfMaxUsed() / 1024;
+    report["stages"]     = *_stages;
+
+    if (info != 0)
+    {
+        JsonPropertiesVisitor visitor (report["info"]);
+        info->accept (&visitor);
+    }
+
+    write (report);
+
+    if (_fd >= 0)  { ::close (_fd);  _fd = -1; }
+
+    _isOpen = false;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJsonSink::beginStage (const std::string& name)
+{
+    LocalSynchronizer l (_synchro);
+
+    ITime::Value now = System::time().getTimeStamp();
+    _runningStages.push_back (make_pair (name, now));
+
+    json::JSON event;
+    event["type"]  = "stage_begin";
+    event["time"]  = (now - _t0) / 1000.0;
+    event["stage"] = name;
+
+    write (event);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJsonSink::endStage (const std::string& name, IProperties* info)
+{
+    LocalSynchronizer l (_synchro);
+
+    ITime::Value now = System::time().getTimeStamp();
+    ITime::Value t0  = now;
+
+    /** We look for the stage in the running ones, from the last started one. */
+    for (size_t i=_runningStages.size(); i>0; i--)
+    {
+        if (_runningStages[i-1].first == name)
+        {
+            t0 = _runningStages[i-1].second;
+            _runningStages.erase (_runningStages.begin() + (i-1));
+            break;
+        }
+    }
+
+    json::JSON stage;
+    stage["stage"]   = name;
+    stage["elapsed"] = (now - t0) / 1000.0;
+    if (info != 0)
+    {
+        JsonPropertiesVisitor visitor (stage["info"]);
+        info->accept (&visitor);
+    }
+
+    _stages->append (stage);
+
+    json::JSON event (stage);
+    event["type"] = "stage_end";
+    event["time"] = (now - _t0) / 1000.0;
+
+    write (event);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJsonSink::beginTask (const std::string& message, u_int64_t todo)
+{
+    LocalSynchronizer l (_synchro);
+
+    _task   = message;
+    _todo   = todo;
+    _done   = 0;
+    _taskT0 = System::time().getTimeStamp();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJsonSink::setTaskMessage (const std::string& message)
+{
+    LocalSynchronizer l (_synchro);
+
+    _task = message;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : as Progress::finish, the whole task is considered as done.
+*********************************************************************/
+void ProgressJsonSink::endTask ()
+{
+    LocalSynchronizer l (_synchro);
+
+    if (_done < _todo)  { _done = _todo; }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : to be called with the synchronizer locked
+*********************************************************************/
+void ProgressJsonSink::fillSnapshot (json::JSON& snapshot)
+{
+    ITime::Value now = System::time().getTimeStamp();
+
+    /** The messages of the progress bars are padded with spaces. */
+    string task = _task;
+    task.erase (task.find_last_not_of (' ') + 1);
+
+    u_int64_t done    = _done;
+    double    elapsed = (now - _taskT0) / 1000.0;
+    double    rate    = elapsed > 0 ? done / elapsed : 0;
+
+    snapshot["time"]  = (now - _t0) / 1000.0;
+    snapshot["stage"] = _runningStages.empty() ? string("") : _runningStages.back().first;
+    snapshot["task"]  = task;
+    snapshot["done"]  = done;
+    snapshot["todo"]  = _todo;
+    snapshot["rate"]  = rate;
+
+    if (_todo > 0)  {  snapshot["percent"] = 100.0 * std::min (done, _todo) / _todo;  }
+    if (_todo > done && rate > 0)  {  snapshot["eta"] = (_todo - done) / rate;  }
+
+    snapshot["mem_mb"]      = System::info().getMemorySelfUsed()    / 1024;
+    snapshot["mem_max_mb"]  = System::info().getMemorySelfMaxUsed() / 1024;
+    snapshot["tmp_free_mb"] = System::file().getAvailableSpace (_tmpDir) / 1024;
+
+    /** The cpu usage is the one since the previous snapshot. */
+    snapshot["cpu"] = _cpuinfo->getUsage();
+    _cpuinfo->start();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : to be called with the synchronizer locked
+*********************************************************************/
+void ProgressJsonSink::write (json::JSON& object)
+{
+    if (_fd < 0)  { return; }
+
+    /** One object per line. */
+    string line = object.dump (1, "");
+    std::replace (line.begin(), line.end(), '\n', ' ');
+    line += '\n';
+
+    for (size_t nb=0; nb<line.size(); )
+    {
+        ssize_t res = _isSocket ?
+            send    (_fd, line.data()+nb, line.size()-nb, MSG_NOSIGNAL) :
+            ::write (_fd, line.data()+nb, line.size()-nb);
+
+        if (res < 0 && errno == EINTR)  { continue; }
+
+        /** We give up the output, but the job goes on. */
+        if (res <= 0)  {  ::close (_fd);  _fd = -1;  return;  }
+
+        nb += res;
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void* ProgressJsonSink::mainloop (void* arg)
+{
+    ProgressJsonSink& sink = *(ProgressJsonSink*) arg;
+
+    ITime::Value last = System::time().getTimeStamp();
+
+    while (!sink._isStopped)
+    {
+        /** We sleep by small steps, so the sink can be closed quickly. */
+        usleep (50*1000);
+
+        ITime::Value now = System::time().getTimeStamp();
+        if (now - last < sink._period*1000)  { continue; }
+        last = now;
+
+        LocalSynchronizer l (sink._synchro);
+
+        json::JSON snapshot;
+        snapshot["type"] = "progress";
+        sink.fillSnapshot (snapshot);
+        sink.write (snapshot);
+    }
+
+    return 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ProgressJsonSink::Scope::Scope (IProperties* options, IProperties* info)
+    : _info(info), _isOwner(false)
+{
+    if (options == 0 || options->get(STR_PROGRESS_JSON) == 0)  { return; }
+
+    double period = options->get(STR_PROGRESS_PERIOD) ? options->getDouble(STR_PROGRESS_PERIOD) : 1.0;
+
+    /** The free space is the one of the directory of the temporary files. */
+    string tmpDir;
+    if      (options->get(STR_URI_OUTPUT_TMP) && !options->getStr(STR_URI_OUTPUT_TMP).empty())  { tmpDir = options->getStr(STR_URI_OUTPUT_TMP); }
+    else if (options->get(STR_URI_OUTPUT_DIR) && !options->getStr(STR_URI_OUTPUT_DIR).empty())  { tmpDir = options->getStr(STR_URI_OUTPUT_DIR); }
+
+    _isOwner = ProgressJsonSink::singleton().open (options->getStr(STR_PROGRESS_JSON), period, tmpDir);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ProgressJsonSink::Scope::~Scope ()
+{
+    if (_isOwner)  {  ProgressJsonSink::singleton().close (_info, std::uncaught_exception() ? "error" : "ok");  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ProgressJson::ProgressJson (dp::IteratorListener* ref, u_int64_t ntasks, const char* msg)
+    : ProgressProxy (ref), _todo(ntasks), _message(msg ? msg : "")
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+dp::IteratorListener* ProgressJson::wrap (dp::IteratorListener* ref, u_int64_t ntasks, const char* msg)
+{
+    return ProgressJsonSink::singleton().isOpen() ? new ProgressJson (ref, ntasks, msg) : ref;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJson::init ()
+{
+    ProgressProxy::init ();
+    ProgressJsonSink::singleton().beginTask (_message, _todo);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJson::finish ()
+{
+    ProgressProxy::finish ();
+    ProgressJsonSink::singleton().endTask ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJson::inc (u_int64_t ntasks_done)
+{
+    ProgressProxy::inc (ntasks_done);
+    ProgressJsonSink::singleton().incTask (ntasks_done);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJson::set (u_int64_t ntasks_done)
+{
+    ProgressProxy::set (ntasks_done);
+    ProgressJsonSink::singleton().setTask (ntasks_done);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJson::reset (u_int64_t ntasks)
+{
+    ProgressProxy::reset (ntasks);
+    _todo = ntasks;
+    ProgressJsonSink::singleton().beginTask (_message, _todo);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ProgressJson::setMessage (const std::string& msg)
+{
+    ProgressProxy::setMessage (msg);
+    _message = msg;
+    ProgressJsonSink::singleton().setTaskMessage (_message);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+JsonPropertiesVisitor::JsonPropertiesVisitor (json::JSON& root)
+    : _root(root)
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void JsonPropertiesVisitor::visitBegin ()
+{
+    _root = json::JSON::Make (json::JSON::Class::Object);
+    _stack.clear();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : JSON value of a property: a number if possible, a string otherwise
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+static json::JSON getJsonValue (const std::string& value)
+{
+    const char* s = value.c_str();
+    char*       end = 0;
+
+    /** We don't want 'nan', 'inf' or hexadecimal values to be taken as numbers. */
+    bool isNumber = !value.empty() && (isdigit(s[0]) || (s[0]=='-' && isdigit(s[1])));
+    bool isFloat  = value.find_first_not_of ("-0123456789") != string::npos;
+
+    if (isNumber && !isFloat)
+    {
+        long long v = strtoll (s, &end, 10);
+        if (*end == 0)  { return json::JSON (v); }
+    }
+    if (isNumber && isFloat && value.find_first_not_of ("-0123456789.eE+") == string::npos)
+    {
+        double v = strtod (s, &end);
+        if (*end == 0)  { return json::JSON (v); }
+    }
+
+    return json::JSON (value);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : a property whose value has already been set becomes an object
+**           when its first child is visited, its value being kept in the 'value' field.
+*********************************************************************/
+void JsonPropertiesVisitor::visitProperty (IProperty* prop)
+{
+    if (prop == 0)  { return; }
+
+    /** We look for the parent of the property. */
+    while (!_stack.empty() && _stack.back().first >= prop->depth)  { _stack.pop_back(); }
+
+    json::JSON* parent = _stack.empty() ? &_root : _stack.back().second;
+
+    if (parent->JSONType() != json::JSON::Class::Object)
+    {
+        json::JSON value (*parent);
+        *parent = json::JSON::Make (json::JSON::Class::Object);
+        if (value.JSONType() != json::JSON::Class::Null)  { (*parent)["value"] = value; }
+    }
+
+    json::JSON& child = (*parent)[prop->key];
+
+    /** A key may be given several times (several steps with the same name for instance). */
+    if (child.JSONType() != json::JSON::Class::Object)
+    {
+        child = prop->value.empty() ? json::JSON() : getJsonValue (prop->value);
+    }
+
+    _stack.push_back (make_pair (prop->depth, &child));
+}
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
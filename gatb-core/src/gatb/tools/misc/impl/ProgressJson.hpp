@@ -0,0 +1,276 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file ProgressJson.hpp
+ *  \brief Progress information as JSON snapshots, for monitoring tools
+ */
+
+#ifndef _GATB_CORE_TOOLS_MISC_PROGRESS_JSON_HPP_
+#define _GATB_CORE_TOOLS_MISC_PROGRESS_JSON_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/misc/impl/Progress.hpp>
+#include <gatb/tools/misc/api/IProperty.hpp>
+
+#include <string>
+#include <vector>
+
+/** Class of the JSON library (see thirdparty/json). */
+namespace json { class JSON; }
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace tools     {
+namespace misc      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Sink of progress information, written as JSON snapshots
+ *
+ * Once opened, the sink writes one JSON object per line (JSON lines) into a file, or into a Unix
+ * socket if the uri is 'unix:<path>' (the socket must be listened to by the monitoring tool).
+ * The objects have a 'type' field:
+ *      - 'progress' : periodic snapshot, written by a thread of the sink every 'period' seconds
+ *        (even if nothing progresses, so a stuck job can be detected). It holds the current stage
+ *        (the name of the running Algorithm), the current task (the message of the last progress
+ *        listener) with its number of items done and to do, the rate (items/s) and the remaining
+ *        time of the task, and the memory, cpu and free temporary disk of the process.
+ *      - 'stage_begin', 'stage_end' : written when an Algorithm starts or ends; the 'stage_end'
+ *        object holds the statistics of the algorithm (Algorithm::getInfo).
+ *      - 'report' : final report, written when the sink is closed; it holds the status ('ok' or
+ *        'error'), the elapsed time, the statistics of all the stages and the final statistics
+ *        (for instance the graph information).
+ *
+ * The sink is a singleton, so it can be fed by all the algorithms of the process: Algorithm::run
+ * notifies the stages, and the listeners created by Algorithm::createIteratorListener (and by the
+ * other long steps like BCALM or Leon) are wrapped by a ProgressJson proxy.
+ *
+ * A write failure (for instance a monitoring tool that stops listening to the socket) closes the
+ * output but does not stop the job.
+ *
+ * Sample of use:
+ * \code
+ * void sample (IProperties* options, IProperties* info)
+ * {
+ *      // the sink is opened if the '-progress-json' option is set, and closed with 'info' as final report.
+ *      ProgressJsonSink::Scope scope (options, info);
+ *
+ *      // the progress of this listener is written into the sink.
+ *      IteratorListener* listener = ProgressJson::wrap (new IteratorListener(), 1000, "my task");
+ *      LOCAL (listener);
+ * }
+ * \endcode
+ */
+class ProgressJsonSink
+{
+public:
+
+    /** Get the sink of the process.
+     * \return the singleton instance. */
+    static ProgressJsonSink& singleton ();
+
+    /** Open the sink. An exception is thrown if the file can't be created or the socket can't be connected.
+     * \param[in] uri : path of the output file, or 'unix:<path>' for a Unix socket
+     * \param[in] period : number of seconds between two 'progress' snapshots
+     * \param[in] tmpDir : directory whose free space is given in the snapshots
+     * \return false if the sink is already opened (nothing is done in such a case). */
+    bool open (const std::string& uri, double period=1.0, const std::string& tmpDir="");
+
+    /** Write the final report and close the sink.
+     * \param[in] info : final statistics (may be 0)
+     * \param[in] status : status of the job */
+    void close (IProperties* info, const std::string& status="ok");
+
+    /** Tells whether the sink is opened. */
+    bool isOpen () const  { return _isOpen; }
+
+    /** Notify the beginning of a stage.
+     * \param[in] name : name of the stage */
+    void beginStage (const std::string& name);
+
+    /** Notify the end of a stage.
+     * \param[in] name : name of the stage
+     * \param[in] info : statistics of the stage (may be 0) */
+    void endStage (const std::string& name, IProperties* info);
+
+    /** Notify the beginning of a task of the current stage (see ProgressJson).
+     * \param[in] message : description of the task
+     * \param[in] todo : number of items to be done */
+    void beginTask (const std::string& message, u_int64_t todo);
+
+    /** Notify some progress of the current task. May be called by several threads.
+     * \param[in] done : number of items done since the last call */
+    void incTask (u_int64_t done)  {  __sync_fetch_and_add (&_done, done);  }
+
+    /** Set the number of items done of the current task.
+     * \param[in] done : number of items done */
+    void setTask (u_int64_t done)  {  _done = done;  }
+
+    /** Change the description of the current task, without changing its progress.
+     * \param[in] message : description of the task */
+    void setTaskMessage (const std::string& message);
+
+    /** Notify the end of the current task. */
+    void endTask ();
+
+    /** Open the sink according to the '-progress-json' and '-progress-period' options, and close it
+     * when the instance is deleted; the status of the final report is 'error' if the instance is
+     * deleted because of an exception. Nothing is done if the sink is already opened, so scopes
+     * can be nested (a tool building a graph for instance). */
+    class Scope
+    {
+    public:
+        /** Constructor.
+         * \param[in] options : options of the job
+         * \param[in] info : final statistics, given in the report when the sink is closed (may be 0) */
+        Scope (IProperties* options, IProperties* info);
+
+        /** Destructor. */
+        ~Scope ();
+
+    private:
+        IProperties* _info;
+        bool         _isOwner;
+    };
+
+private:
+
+    ProgressJsonSink ();
+    ~ProgressJsonSink ();
+
+    /** Build a snapshot of the current progress. */
+    void fillSnapshot (json::JSON& snapshot);
+
+    /** Write an object as a line of the output. */
+    void write (json::JSON& object);
+
+    /** Main loop of the thread writing the 'progress' snapshots. */
+    static void* mainloop (void* arg);
+
+    bool                           _isOpen;
+    volatile bool                  _isStopped;
+    int                            _fd;
+    bool                           _isSocket;
+    double                         _period;
+    std::string                    _tmpDir;
+
+    system::ISynchronizer*         _synchro;
+    system::IThread*               _thread;
+    system::ISystemInfo::CpuInfo*  _cpuinfo;
+
+    system::ITime::Value           _t0;
+    system::ITime::Value           _taskT0;
+
+    /** Running stages (an algorithm may run other algorithms), with their start time. */
+    std::vector<std::pair<std::string,system::ITime::Value> > _runningStages;
+
+    std::string                    _task;
+    volatile u_int64_t             _done;
+    u_int64_t                      _todo;
+
+    /** Statistics of the ended stages, given in the final report. */
+    json::JSON*                    _stages;
+};
+
+/********************************************************************************/
+
+/** \brief Proxy writing the progress of a listener into the ProgressJsonSink
+ *
+ * The notifications are forwarded to the referred listener (usually the progress bar of the
+ * terminal), and given to the sink as the progress of its current task.
+ */
+class ProgressJson : public ProgressProxy
+{
+public:
+
+    /** Constructor.
+     * \param[in] ref : referred listener
+     * \param[in] ntasks : nb of items to be processed
+     * \param[in] msg : description of the task */
+    ProgressJson (dp::IteratorListener* ref, u_int64_t ntasks, const char* msg);
+
+    /** Wrap a listener by a ProgressJson instance if the sink is opened.
+     * \param[in] ref : listener to be wrapped
+     * \param[in] ntasks : nb of items to be processed
+     * \param[in] msg : description of the task
+     * \return the ProgressJson instance, or the provided listener if the sink is not opened. */
+    static dp::IteratorListener* wrap (dp::IteratorListener* ref, u_int64_t ntasks, const char* msg);
+
+    /** \copydoc dp::IteratorListener::init */
+    void init ();
+
+    /** \copydoc dp::IteratorListener::finish */
+    void finish ();
+
+    /** \copydoc dp::IteratorListener::inc */
+    void inc (u_int64_t ntasks_done);
+
+    /** \copydoc dp::IteratorListener::set */
+    void set (u_int64_t ntasks_done);
+
+    /** \copydoc dp::IteratorListener::reset */
+    void reset (u_int64_t ntasks);
+
+    /** \copydoc dp::IteratorListener::setMessage */
+    void setMessage (const std::string& msg);
+
+private:
+
+    u_int64_t   _todo;
+    std::string _message;
+};
+
+/********************************************************************************/
+
+/** \brief Conversion of a IProperties instance into a JSON object.
+ *
+ * The 'depth' attribute of each IProperty instance is used as a basis for building the tree of
+ * objects. A property having children is an object, its value being given by a 'value' field;
+ * the values that are numbers are given as JSON numbers, the other ones as strings.
+ */
+class JsonPropertiesVisitor : public IPropertiesVisitor
+{
+public:
+
+    /** Constructor.
+     * \param[in] root : JSON object to be filled. */
+    JsonPropertiesVisitor (json::JSON& root);
+
+    /** \copydoc IPropertiesVisitor::visitBegin */
+    void visitBegin ();
+
+    /** \copydoc IPropertiesVisitor::visitEnd */
+    void visitEnd   ()  {}
+
+    /** \copydoc IPropertiesVisitor::visitProperty */
+    void visitProperty (IProperty* prop);
+
+private:
+
+    json::JSON&                                    _root;
+    std::vector<std::pair<size_t,json::JSON*> >    _stack;
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_MISC_PROGRESS_JSON_HPP_ */
@@ -31,6 +31,8 @@ using namespace gatb::core::system::impl;
 namespace gatb {  namespace core { namespace tools {  namespace misc {  namespace impl {
 /********************************************************************************/
 
+bool TimeInfo::_countersActivated = false;
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -68,12 +70,32 @@ TimeInfo::TimeInfo (system::ITime& aTime) : _time(aTime)
 void TimeInfo::start (const char* name)
 {
     _entriesT0 [name] = _time.getTimeStamp();
+
+    if (_countersActivated)
+    {
+        /** Within a dispatched command, we count only the current thread, otherwise the
+         * other threads of the dispatcher would be counted several times. */
+        std::pair<IThread*,size_t> info;
+        bool inCommand = ThreadGroup::findThreadInfo (System::thread().getThreadSelf(), info);
+
+        ISystemInfo::CountersInfo*& counters = _countersT0 [name];
+        if (counters != 0)  { counters->forget(); }
+
+        counters = System::info().createCountersInfo (inCommand);
+        counters->use ();
+        counters->start ();
+    }
 }
 
 	
 //destructor
 TimeInfo::~TimeInfo()
 {
+    for (map <string, ISystemInfo::CountersInfo*>::iterator it = _countersT0.begin(); it != _countersT0.end(); ++it)
+    {
+        it->second->forget();
+    }
+
 	if(_synchro)
 	{
 		delete _synchro;
@@ -91,6 +113,16 @@ TimeInfo::~TimeInfo()
 void TimeInfo::stop (const char* name)
 {
     _entries [name] += _time.getTimeStamp() - _entriesT0 [name];
+
+    map <string, ISystemInfo::CountersInfo*>::iterator it = _countersT0.find (name);
+    if (it != _countersT0.end())
+    {
+        it->second->stop ();
+        _counters [name] += it->second->getCounters();
+
+        it->second->forget ();
+        _countersT0.erase (it);
+    }
 }
 
 /*********************************************************************
@@ -113,6 +145,11 @@ TimeInfo& TimeInfo::operator+= (TimeInfo& ti)
         _entries[it->first] += it->second;
     }
 
+    for (map <string, ISystemInfo::Counters>::const_iterator it = ti._counters.begin(); it != ti._counters.end(); ++it)
+    {
+        _counters[it->first] += it->second;
+    }
+
 	_synchro->unlock();
     return *this;
 }
@@ -123,7 +160,7 @@ TimeInfo& TimeInfo::operator+= (TimeInfo& ti)
 ** INPUT   :
 ** OUTPUT  :
 ** RETURN  :
-** REMARKS :
+** REMARKS : the counters are not divided: they keep the total of the threads.
  GR: this must be thread safe ! because multiple threads may call this on the same TimeInfo object at the same time !
 *********************************************************************/
 TimeInfo& TimeInfo::operator/= (size_t nb)
@@ -191,11 +228,46 @@ tools::misc::IProperties* TimeInfo::getProperties (const std::string& root)
     for (it = getEntries().begin(); it != getEntries().end();  it++)
     {
         props->add (1, it->first.c_str(), "%.3f", (double)(it->second) / 1000.0);
+
+        std::map <std::string, ISystemInfo::Counters>::const_iterator itCounters = _counters.find (it->first);
+        if (itCounters != _counters.end())  {  addCounters (props, 2, itCounters->second);  }
     }
 
     return props;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ISystemInfo::Counters TimeInfo::getCountersByKey (const std::string& key)
+{
+    ISystemInfo::Counters result;
+    std::map <std::string, ISystemInfo::Counters>::iterator  it = _counters.find (key);
+    if (it != _counters.end()) { result = it->second; }
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void TimeInfo::addCounters (tools::misc::IProperties* props, size_t depth, const ISystemInfo::Counters& counters)
+{
+    for (size_t i=0; i<ISystemInfo::Counters::NB_KINDS; i++)
+    {
+        if (counters.available[i])  {  props->add (depth, ISystemInfo::Counters::getName(i), "%lld", counters.values[i]);  }
+    }
+}
+
 /********************************************************************************/
 } } } } } /* end of namespaces. */
 /********************************************************************************/
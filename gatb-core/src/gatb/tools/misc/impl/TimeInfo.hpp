@@ -68,6 +68,12 @@ namespace impl      {
           << "part2: " << t.getEntryByKey("part2") << endl;
  }
  * \endcode
+ *
+ * If the counters are activated (see setCounters), some hardware and operating system
+ * counters (instructions, cache misses, cpu times, bytes read and written...) are also
+ * gathered for each label, and given with the durations by getProperties. A label started
+ * within a command dispatched by a Dispatcher counts the thread of the command only; other
+ * labels count the whole process.
   */
 class TimeInfo : public system::SmartPointer
 {
@@ -124,12 +130,38 @@ public:
      */
     virtual tools::misc::IProperties* getProperties (const std::string& root);
 
+    /** Retrieve the counters for a given label (see setCounters).
+     * \param[in] key : the label we want the counters for.
+     * \return the counters (none available if the label is unknown).
+     */
+    system::ISystemInfo::Counters getCountersByKey (const std::string& key);
+
+    /** Activate (or not) the gathering of counters by the TimeInfo instances and the dispatchers
+     * of the process. By default, the counters are not gathered.
+     * \param[in] activate : true for gathering the counters. */
+    static void setCounters (bool activate)  { _countersActivated = activate; }
+
+    /** Tells whether the counters are gathered.
+     * \return true if the counters are gathered. */
+    static bool getCounters ()  { return _countersActivated; }
+
+    /** Add the available counters as properties.
+     * \param[in] props : properties to be completed
+     * \param[in] depth : depth of the added properties
+     * \param[in] counters : counters to be added */
+    static void addCounters (tools::misc::IProperties* props, size_t depth, const system::ISystemInfo::Counters& counters);
+
 private:
 
     system::ITime&  _time;
     std::map <std::string, u_int32_t>  _entriesT0;
     std::map <std::string, u_int32_t>  _entries;
 	gatb::core::system::ISynchronizer* _synchro;
+
+    std::map <std::string, system::ISystemInfo::CountersInfo*>  _countersT0;
+    std::map <std::string, system::ISystemInfo::Counters>       _counters;
+
+    static bool _countersActivated;
 };
 
 /********************************************************************************/
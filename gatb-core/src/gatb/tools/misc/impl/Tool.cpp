@@ -21,6 +21,7 @@
 #include <gatb/system/impl/System.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
+#include <gatb/tools/misc/impl/ProgressJson.hpp>
 #include <gatb/tools/misc/impl/LibraryInfo.hpp>
 #include <gatb/tools/designpattern/impl/Command.hpp>
 
@@ -56,6 +57,10 @@ Tool::Tool (const std::string& name) : userDisplayHelp(0), _helpTarget(0),userDi
     setParser (new OptionsParser(name));
 
     getParser()->push_back (new OptionOneParam (STR_NB_CORES,    "number of cores",      false, "0"  ));
+    getParser()->push_back (new OptionNoParam  (STR_BIND_CORES,  "bind each thread to one core", false));
+    getParser()->push_back (new OptionNoParam  (STR_COUNTERS,    "gather hardware and system counters", false));
+    getParser()->push_back (new OptionOneParam (STR_PROGRESS_JSON,   "write progress snapshots as JSON lines into a file (or 'unix:<path>' socket)", false));
+    getParser()->push_back (new OptionOneParam (STR_PROGRESS_PERIOD, "seconds between two JSON progress snapshots", false, "1"));
     getParser()->push_back (new OptionOneParam (STR_VERBOSE,     "verbosity level",      false, "1"  ));
 	getParser()->push_back (new OptionNoParam (STR_VERSION, "version", false));
 	getParser()->push_back (new OptionNoParam (STR_HELP, "help", false));
@@ -168,6 +173,9 @@ IProperties* Tool::run (IProperties* input)
         setDispatcher (new Dispatcher (_input->getInt(STR_NB_CORES)) );
     }
 
+    /** We may write the progress for monitoring tools, with the statistics as final report. */
+    ProgressJsonSink::Scope progressJson (_input, _info);
+
     /** We may have some pre processing. */
     preExecute ();
 
@@ -203,6 +211,12 @@ void Tool::preExecute ()
     /** set nb cores to be actual number of free cores, if was 0. */
     if (_input->getInt(STR_NB_CORES)<=0)  { _input->setInt (STR_NB_CORES, System::info().getNbCores());  }
 
+    /** bind the threads to cores if required. */
+    if (_input->get(STR_BIND_CORES) != 0)  { Dispatcher::setThreadsBinding (true);  }
+
+    /** gather hardware and system counters if required. */
+    if (_input->get(STR_COUNTERS) != 0)  { TimeInfo::setCounters (true);  }
+
 //    /** We add the input properties to the statistics result. */
 //    _info->add (1, _input);
 }
@@ -249,12 +263,17 @@ void Tool::postExecute ()
 *********************************************************************/
 dp::IteratorListener* Tool::createIteratorListener (size_t nbIterations, const char* message)
 {
+    IteratorListener* result = 0;
+
     switch (getInput()->getInt(STR_VERBOSE))
     {
-        case 0: default:    return new IteratorListener ();
-        case 1:             return new ProgressTimer (nbIterations, message);
-        case 2:             return new Progress      (nbIterations, message);
+        case 0: default:    result = new IteratorListener ();                        break;
+        case 1:             result = new ProgressTimer (nbIterations, message);      break;
+        case 2:             result = new Progress      (nbIterations, message);      break;
     }
+
+    /** The progress may also be written as JSON for monitoring tools. */
+    return ProgressJson::wrap (result, nbIterations, message);
 }
 
 /*********************************************************************
@@ -0,0 +1,252 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file CollectionMmap.hpp
+ *  \brief Collection read in place from a memory mapped file
+ */
+
+#ifndef _GATB_CORE_TOOLS_STORAGE_IMPL_COLLECTION_MMAP_HPP_
+#define _GATB_CORE_TOOLS_STORAGE_IMPL_COLLECTION_MMAP_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/collections/api/Collection.hpp>
+#include <gatb/tools/collections/impl/BagFile.hpp>
+#include <gatb/tools/collections/impl/CollectionAbstract.hpp>
+#include <gatb/tools/designpattern/api/Iterator.hpp>
+#include <gatb/system/impl/System.hpp>
+#include <json/json.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace tools     {
+namespace storage   {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Iterator over an array of items.
+ *
+ * The items are copied into the current item of the iterator (see Iterator::setItem).
+ */
+template <class Item> class IteratorMmap : public dp::Iterator<Item>
+{
+public:
+
+    /** Constructor.
+     * \param[in] items : items to be iterated
+     * \param[in] nbItems : number of items */
+    IteratorMmap (const Item* items, size_t nbItems) : _items(items), _nbItems(nbItems), _idx(0)  {}
+
+    /** \copydoc dp::Iterator::first */
+    void first()  {  _idx = 0;  if (_idx < _nbItems)  { *(this->_item) = _items[_idx]; }  }
+
+    /** \copydoc dp::Iterator::next */
+    void next()   {  ++_idx;    if (_idx < _nbItems)  { *(this->_item) = _items[_idx]; }  }
+
+    /** \copydoc dp::Iterator::isDone */
+    bool isDone() {  return _idx >= _nbItems;  }
+
+    /** \copydoc dp::Iterator::item */
+    Item& item ()  { return *(this->_item); }
+
+private:
+
+    const Item* _items;
+    size_t      _nbItems;
+    size_t      _idx;
+};
+
+/********************************************************************************/
+
+/** \brief Iterable over an array of items of a memory mapped file.
+ */
+template <class Item> class IterableMmap : public collections::Iterable<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor.
+     * \param[in] items : mapped items
+     * \param[in] nbItems : number of items */
+    IterableMmap (Item* items, size_t nbItems) : _items(items), _nbItems(nbItems)  {}
+
+    /** \copydoc Iterable::iterator */
+    dp::Iterator<Item>* iterator ()  { return new IteratorMmap<Item> (_items, _nbItems); }
+
+    /** \copydoc Iterable::getNbItems */
+    int64_t getNbItems ()  { return _nbItems; }
+
+    /** \copydoc Iterable::estimateNbItems */
+    int64_t estimateNbItems ()  { return _nbItems; }
+
+    /** \copydoc Iterable::getItems */
+    Item* getItems (Item*& buffer)
+    {
+        if (_nbItems > 0)  { memcpy (buffer, _items, _nbItems*sizeof(Item)); }
+        return buffer;
+    }
+
+    /** \copydoc Iterable::getItems(Item*&,size_t,size_t) */
+    size_t getItems (Item*& buffer, size_t start, size_t nb)
+    {
+        if (start >= _nbItems)     { return 0; }
+        if (start+nb > _nbItems)   { nb = _nbItems - start; }
+        memcpy (buffer, _items + start, nb*sizeof(Item));
+        return nb;
+    }
+
+private:
+
+    Item*  _items;
+    size_t _nbItems;
+};
+
+/********************************************************************************/
+
+/** \brief Bag writing a staging file, which replaces the mapped collection when the storage is closed.
+ *
+ * The file is created at the first insertion only, so that merely reading a mapped collection
+ * doesn't stage anything.
+ */
+template <class Item> class BagMmap : public collections::Bag<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor.
+     * \param[in] filename : staging file, empty if the storage is read only. */
+    BagMmap (const std::string& filename) : _filename(filename), _bag(0)  {}
+
+    /** Destructor. */
+    ~BagMmap ()  {  setBag (0);  }
+
+    /** \copydoc Bag::insert */
+    void insert (const Item& item)  {  getBag()->insert (item);  }
+
+    /** \copydoc Bag::insert(const std::vector<Item>&, size_t) */
+    void insert (const std::vector<Item>& items, size_t length)  {  getBag()->insert (items, length);  }
+
+    /** \copydoc Bag::insert(const Item*, size_t) */
+    void insert (const Item* items, size_t length)  {  getBag()->insert (items, length);  }
+
+    /** \copydoc Bag::flush */
+    void flush ()  {  if (_bag != 0)  { _bag->flush(); }  }
+
+private:
+
+    std::string _filename;
+
+    collections::Bag<Item>* _bag;
+    void setBag (collections::Bag<Item>* bag)  { SP_SETATTR(bag); }
+
+    collections::Bag<Item>* getBag ()
+    {
+        if (_bag == 0)
+        {
+            if (_filename.empty())  { throw system::Exception ("Can't write a collection of a storage opened in read only mode"); }
+
+            /** The mapped content is replaced, not appended to. */
+            system::impl::System::file().remove (_filename);
+            setBag (new collections::impl::BagFile<Item> (_filename));
+        }
+        return _bag;
+    }
+};
+
+/********************************************************************************/
+
+/** \brief Implementation of the Collection interface for a collection of a memory mapped file.
+ *
+ * The items are read in place from the mapping. Inserting items stages a new content for the
+ * collection (see BagMmap), which is used when the storage is closed.
+ */
+template <class Item> class CollectionMmap : public collections::impl::CollectionAbstract<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor.
+     * \param[in] items : mapped items
+     * \param[in] nbItems : number of mapped items
+     * \param[in] filename : staging file of the collection, empty if the storage is read only
+     * \param[in] properties : mapped properties of the collection (as a JSON string) */
+    CollectionMmap (Item* items, size_t nbItems, const std::string& filename, const std::string& properties)
+        : collections::impl::CollectionAbstract<Item> (new BagMmap<Item> (filename), new IterableMmap<Item> (items, nbItems)),
+          _name(filename), _propertiesName(filename.empty() ? filename : filename+".props"), _properties(properties)
+    {}
+
+    /** \copydoc tools::collections::Collection::remove */
+    void remove ()
+    {
+        if (_name.empty())  { return; }
+        system::impl::System::file().remove (_name);
+        system::impl::System::file().remove (_propertiesName);
+    }
+
+    /** \copydoc tools::collections::Collection::addProperty */
+    void addProperty (const std::string& key, const std::string value)
+    {
+        if (_propertiesName.empty())  { throw system::Exception ("Can't set property '%s' of a storage opened in read only mode", key.c_str()); }
+
+        json::JSON j = getJson();
+        j[key] = value;
+
+        std::ofstream file (_propertiesName);
+        file << j.dump();
+    }
+
+    /** \copydoc tools::collections::Collection::getProperty */
+    std::string getProperty (const std::string& key)
+    {
+        json::JSON j = getJson();
+        return j.hasKey(key) ? j[key].ToString() : std::string("");
+    }
+
+private:
+
+    std::string _name;
+    std::string _propertiesName;
+    std::string _properties;
+
+    /** The staged properties (if any) override the mapped ones. */
+    json::JSON getJson ()
+    {
+        std::string data = _properties;
+
+        if (!_propertiesName.empty() && system::impl::System::file().doesExist (_propertiesName))
+        {
+            std::ifstream file (_propertiesName);
+            std::string line;
+            for (data.clear(); getline (file, line); )  { data += line; }
+        }
+
+        json::JSON j;
+        if (data.size() > 0)  { j = json::LoadJson (data); }
+        return j;
+    }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_STORAGE_IMPL_COLLECTION_MMAP_HPP_ */
@@ -194,11 +194,22 @@ class Storage_istreambuf : public std::streambuf
     public:
     Storage_istreambuf (Group& group, const std::string& name, std::size_t buff_sz = 1024, std::size_t put_back = 64) :
             put_back_(std::max(put_back, size_t(1))),
-            buffer_(std::max(buff_sz, put_back_) + put_back_), currentIdx(0)
+            buffer_(std::max(buff_sz, put_back_) + put_back_), currentIdx(0), _collection(0)
         {
-            char *end = &buffer_.front() + buffer_.size();
-            setg(end, end, end);
-            _collection = & group.getCollection<math::NativeInt8> (name);
+            /** If the storage maps the collection in memory, we read it in place. */
+            size_t nbItems = 0;
+            char*  mapped  = (char*) group.mapCollection<math::NativeInt8> (name, nbItems);
+
+            if (mapped != 0)
+            {
+                setg (mapped, mapped, mapped + nbItems);
+            }
+            else
+            {
+                char *end = &buffer_.front() + buffer_.size();
+                setg(end, end, end);
+                _collection = & group.getCollection<math::NativeInt8> (name);
+            }
         }
 
     private:
@@ -208,6 +219,9 @@ class Storage_istreambuf : public std::streambuf
             if (gptr() < egptr()) // buffer not exhausted
                 return traits_type::to_int_type(*gptr());
 
+            if (_collection == 0) // mapped collection entirely read
+                return traits_type::eof();
+
             char *base = &buffer_.front();
             char *start = base;
 
@@ -243,11 +257,11 @@ class Storage_istreambuf : public std::streambuf
         Storage_istreambuf &operator= (const Storage_istreambuf &);
 
     private:
-        collections::Collection<math::NativeInt8>* _collection;
-
         const std::size_t put_back_;
         std::vector<char> buffer_;
         size_t currentIdx;
+
+        collections::Collection<math::NativeInt8>* _collection;
 };
 
 /*********************************************************************
@@ -284,8 +298,8 @@ Storage::ostream::~ostream()
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-Storage::istream::istream (Group& group, const std::string& name)
-    : std::ios(0), std::istream(new Storage_istreambuf(group,name))
+Storage::istream::istream (Group& group, const std::string& name, size_t bufferSize)
+    : std::ios(0), std::istream(new Storage_istreambuf(group,name,bufferSize))
 {
 }
 
@@ -307,10 +321,11 @@ Storage::istream::~istream ()
 ////////// SuperKmerBinFiles //////////
 ///////////////////////////////////////
 	
-SuperKmerBinFiles::SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files) : _basefilename(name), _path(path),_nb_files(nb_files)
+SuperKmerBinFiles::SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files, bool lockFreeWrites) : _basefilename(name), _path(path),_lockFreeWrites(lockFreeWrites),_nb_files(nb_files)
 {
 	_nbKmerperFile.resize(_nb_files,0);
 	_FileSize.resize(_nb_files,0);
+	_writeOffsets.resize(_nb_files,0);
 	
 	openFiles("wb"); //at construction will open file for writing
 	// then use close() and openFiles() to open for reading
@@ -319,33 +334,47 @@ SuperKmerBinFiles::SuperKmerBinFiles(const std::string& path,const std::string&
 
 void SuperKmerBinFiles::openFile( const char* mode, int fileId)
 {
+	//may have already been opened for reading by prefetchFile
+	if(_files[fileId]!=0 && mode[0]=='r')
+		return;
+
 	std::stringstream ss;
 	ss << _basefilename << "." << fileId;
 		
 	_files[fileId] = system::impl::System::file().newFile (_path, ss.str(), mode);
 	_synchros[fileId] = system::impl::System::thread().newSynchronizer();
 	_synchros[fileId]->use();
+
+	//blocks will be read in place from the mapping (0 if mmap failed, then we fall back to fread)
+	_maps[fileId] = (mode[0]=='r') ? _files[fileId]->map() : 0;
+	_mapOffsets[fileId] = 0;
+	if(mode[0]=='w')
+		_writeOffsets[fileId] = 0;
 }
 	
 void SuperKmerBinFiles::openFiles( const char* mode)
 {
 	_files.resize(_nb_files,0);
+	_maps.resize(_nb_files,0);
+	_mapOffsets.resize(_nb_files,0);
 	_synchros.resize(_nb_files,0);
 	
 	system::impl::System::file().mkdir(_path, 0755);
 
 	for(unsigned int ii=0;ii<_files.size();ii++)
 	{
-		std::stringstream ss;
-		ss << _basefilename << "." << ii;
-		
-		_files[ii] = system::impl::System::file().newFile (_path, ss.str(), mode);
-		_synchros[ii] = system::impl::System::thread().newSynchronizer();
-		_synchros[ii]->use();
-
+		openFile(mode,ii);
 	}
 }
 
+void SuperKmerBinFiles::prefetchFile(int fileId)
+{
+	openFile("rb",fileId);
+
+	if(_maps[fileId]!=0)
+		_files[fileId]->willNeed();
+}
+
 	
 std::string SuperKmerBinFiles::getFileName(int fileId)
 {
@@ -358,9 +387,56 @@ std::string SuperKmerBinFiles::getFileName(int fileId)
 
 	
 int SuperKmerBinFiles::readBlock(unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id)
+{
+	const unsigned char * data;
+	
+	int res = readBlock(&data, block, max_block_size, nb_bytes_read, file_id);
+
+	if(res && data != *block)
+	{
+		if(*nb_bytes_read > *max_block_size)
+		{
+			*block = (unsigned char *) realloc(*block, *nb_bytes_read);
+			*max_block_size = *nb_bytes_read;
+		}
+		memcpy(*block, data, *nb_bytes_read);
+	}
+	
+	return res;
+}
+
+int SuperKmerBinFiles::readBlock(const unsigned char ** data, unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id)
 {
 	_synchros[file_id]->lock();
 	
+	if(_maps[file_id]!=0)
+	{
+		//block header then block, read in place ; the block header may not be aligned
+		u_int64_t offset  = _mapOffsets[file_id];
+		u_int64_t mapSize = _files[file_id]->getMapSize();
+
+		if(offset + sizeof(*nb_bytes_read) > mapSize)
+		{
+			_synchros[file_id]->unlock();
+			return 0;
+		}
+
+		memcpy(nb_bytes_read, _maps[file_id] + offset, sizeof(*nb_bytes_read));
+		offset += sizeof(*nb_bytes_read);
+
+		if(offset + *nb_bytes_read > mapSize)
+		{
+			_synchros[file_id]->unlock();
+			throw system::Exception ("truncated superkmer block in %s", getFileName(file_id).c_str());
+		}
+
+		*data = _maps[file_id] + offset;
+		_mapOffsets[file_id] = offset + *nb_bytes_read;
+
+		_synchros[file_id]->unlock();
+		return *nb_bytes_read;
+	}
+
 	//block header
 	int nbr = _files[file_id]->fread(nb_bytes_read, sizeof(*max_block_size),1);
 
@@ -379,6 +455,7 @@ int SuperKmerBinFiles::readBlock(unsigned char ** block, unsigned int* max_block
 	
 	//block
 	_files[file_id]->fread(*block, sizeof(unsigned char),*nb_bytes_read);
+	*data = *block;
 	
 	_synchros[file_id]->unlock();
 	
@@ -417,6 +494,20 @@ void SuperKmerBinFiles::getFilesStats(u_int64_t & total, u_int64_t & biggest, u_
 	
 void SuperKmerBinFiles::writeBlock(unsigned char * block, unsigned int block_size, int file_id, int nbkmers)
 {
+	if(_lockFreeWrites)
+	{
+		//reserve the range of the block (header + block) at the end of the file, then write it in place
+		u_int64_t offset = __sync_fetch_and_add(&_writeOffsets[file_id], (u_int64_t)(block_size+sizeof(block_size)));
+		__sync_fetch_and_add(&_nbKmerperFile[file_id], nbkmers);
+		__sync_fetch_and_add(&_FileSize[file_id], (u_int64_t)(block_size+sizeof(block_size)));
+
+		if(_files[file_id]->pwrite(&block_size, sizeof(block_size), offset) != sizeof(block_size)
+		|| _files[file_id]->pwrite(block, block_size, offset+sizeof(block_size)) != block_size)
+		{
+			throw system::Exception ("cannot write superkmer block in %s", getFileName(file_id).c_str());
+		}
+		return;
+	}
 
 	_synchros[file_id]->lock();
 	
@@ -466,6 +557,7 @@ void SuperKmerBinFiles::closeFile(  int fileId)
 	{
 		delete _files[fileId];
 		_files[fileId] = 0;
+		_maps[fileId] = 0;
 		_synchros[fileId]->forget();
 	}
 }
@@ -479,6 +571,7 @@ void SuperKmerBinFiles::closeFiles()
 		{
 			delete _files[ii];
 			_files[ii] = 0;
+			_maps[ii] = 0;
 			_synchros[ii]->forget();
 		}
 	}
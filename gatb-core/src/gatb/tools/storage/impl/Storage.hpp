@@ -72,7 +72,9 @@ enum StorageMode_e
     /** Experimental. */
     STORAGE_GZFILE,
     /** Experimental. */
-    STORAGE_COMPRESSED_FILE
+    STORAGE_COMPRESSED_FILE,
+    /** Single memory mapped file. */
+    STORAGE_MMAP
 };
 
 /********************************************************************************/
@@ -192,6 +194,14 @@ public:
      */
     template <class Type>  CollectionNode<Type>& getCollection (const std::string& name);
 
+    /** Get the items of a child collection in place, ie. without copying them into memory. This is
+     * possible only when the storage maps its content in memory (see STORAGE_MMAP).
+     * \param[in] name : name of the child collection
+     * \param[out] nbItems : number of items of the collection
+     * \return the items of the collection, 0 if the collection can't be accessed in place.
+     */
+    template <class Type>  Type* mapCollection (const std::string& name, size_t& nbItems);
+
     /** \copydoc Cell::remove */
     void remove ();
 
@@ -250,7 +260,9 @@ public:
 	
 	//construtor will open the files for writing
 	//use closeFiles to close them all then openFiles to open in different mode
-	SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files);
+	//with lockFreeWrites, writeBlock reserves the range of the block in the file with an atomic offset
+	//and writes it without locking, so that threads flushing to the same partition do not serialize
+	SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files, bool lockFreeWrites=true);
 	
 	~SuperKmerBinFiles();
 
@@ -261,9 +273,16 @@ public:
 	void openFile( const char* mode, int fileId);
 	void closeFile(  int fileId);
 
+	//files opened for reading are memory mapped when possible
+	//prefetchFile opens (if needed) the file and asks the OS to read it ahead, to be called on the next partition while the current one is processed
+	void prefetchFile(int fileId);
+
 	//read/write block of superkmers to filefile_id
 	//readBlock will re-allocate the block buffer if needed (current size passed by max_block_size)
 	int readBlock(unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id);
+	//zero-copy version : *data points directly to the block in the file mapping,
+	//or to the buffer (re-allocated as above) if the file could not be mapped
+	int readBlock(const unsigned char ** data, unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id);
 	void writeBlock(unsigned char * block, unsigned int block_size, int file_id, int nbkmers);
 
 	int nbFiles();
@@ -283,6 +302,10 @@ private:
 	std::vector<u_int64_t> _FileSize;
 
 	std::vector<system::IFile* > _files;
+	std::vector<const u_int8_t*> _maps;
+	std::vector<u_int64_t> _mapOffsets;
+	std::vector<u_int64_t> _writeOffsets;
+	bool _lockFreeWrites;
 	std::vector <system::ISynchronizer*> _synchros;
 	int _nb_files;
 };
@@ -486,6 +509,57 @@ protected:
 
     std::vector <collections::impl::CollectionCacheSorted<Type>* > _cachedCollections;
 };
+
+/********************************************************************************/
+
+/** \brief Cache of a Partition, writing sorted runs.
+ *
+ * This class is used like PartitionCache (one instance per thread, all of them referring the
+ * same Partition), but each cache is sorted in place before being appended to its collection
+ * (see collections::impl::BagCacheSorted). Each collection of the referred partition is then
+ * a sequence of sorted runs, which the readers can merge lazily with
+ * dp::impl::SortedRunsIterator instead of sorting the whole collection.
+ *
+ * Compared to PartitionCacheSorted, there is no buffer shared by the threads: a flush takes a
+ * single lock (the one of the collection) and makes no copy of the items.
+ */
+template<typename Type>
+class PartitionCacheSortedRuns
+{
+public:
+
+    /** Constructor */
+    PartitionCacheSortedRuns (Partition<Type>& ref, size_t nbItemsCache, system::ISynchronizer* synchro=0);
+
+    /** Copy constructor. */
+    PartitionCacheSortedRuns (const PartitionCacheSortedRuns<Type>& p);
+
+    /** Destructor. */
+    ~PartitionCacheSortedRuns ();
+
+    /** Return the number of collections for this partition.
+     * \return the number of collections. */
+    size_t size() const;
+
+    /** Get the ith collection
+     * \param[in] idx : index of the collection to be retrieved
+     * \return the wanted collection.
+     */
+    collections::impl::CollectionCacheSortedRuns<Type>& operator[] (size_t idx);
+
+    /** Flush the whole partition (ie flush each collection). */
+    void flush ();
+
+    /** Remove physically the partition (ie. remove each collection). */
+    void remove ();
+
+protected:
+    Partition<Type>& _ref;
+    size_t                     _nbItemsCache;
+    system::ISynchronizer*     _synchro;
+    std::vector <system::ISynchronizer*> _synchros;
+    std::vector <collections::impl::CollectionCacheSortedRuns<Type>* > _cachedCollections;
+};
     
 /********************************************************************************
          #####   #######  #######  ######      #      #####   #######
@@ -556,7 +630,11 @@ public:
     class istream : public std::istream
     {
     public:
-        istream (Group& group, const std::string& name);
+        /** Constructor.
+         * \param[in] group : group holding the collection to be read
+         * \param[in] name : name of the collection
+         * \param[in] bufferSize : number of bytes read from the collection at once (big buffers for big arrays) */
+        istream (Group& group, const std::string& name, size_t bufferSize = 1024);
         ~istream();
     };
 
@@ -652,6 +730,15 @@ public:
     template<typename Type>
     CollectionNode<Type>* createCollection (ICell* parent, const std::string& name, system::ISynchronizer* synchro);
 
+    /** Get the items of a collection in place, if the storage maps its content in memory.
+     * \param[in] parent : parent of the collection
+     * \param[in] name : name of the collection
+     * \param[out] nbItems : number of items of the collection
+     * \return the items of the collection, 0 if the storage doesn't map this collection.
+     */
+    template<typename Type>
+    Type* mapCollection (ICell* parent, const std::string& name, size_t& nbItems);
+
 private:
 
     StorageMode_e _mode;
@@ -156,6 +156,14 @@ inline CollectionNode<Type>&  Group::getCollection (const std::string& name)
     return *result;
 }
 
+/*********************************************************************
+*********************************************************************/
+template <class Type>
+inline Type* Group::mapCollection (const std::string& name, size_t& nbItems)
+{
+    return _factory->mapCollection<Type> (this, name, nbItems);
+}
+
 /*********************************************************************
 *********************************************************************/
 inline void Group::remove ()
@@ -501,12 +509,98 @@ inline void PartitionCacheSorted<Type>::remove ()
     for (size_t i=0; i<_cachedCollections.size(); i++)  { _cachedCollections[i]->remove ();  } 
 }
 
+/*********************************************************************
+ *********************************************************************/
+template<typename Type>
+inline PartitionCacheSortedRuns<Type>::PartitionCacheSortedRuns (Partition<Type>& ref, size_t nbItemsCache, system::ISynchronizer* synchro)
+    :  _ref(ref), _nbItemsCache(nbItemsCache), _synchro(synchro), _synchros(ref.size()), _cachedCollections(ref.size())
+{
+    /** We create the partition files. */
+    for (size_t i=0; i<_cachedCollections.size(); i++)
+    {
+        if(synchro==0)
+        {
+            _synchros[i] = system::impl::System::thread().newSynchronizer();
+        }
+        else
+        {
+            _synchros[i] = synchro;
+        }
+        _synchros[i]->use();
+
+        _cachedCollections[i] = new collections::impl::CollectionCacheSortedRuns<Type> (ref[i], nbItemsCache, _synchros[i]);
+        _cachedCollections[i]->use ();
+    }
+}
+
+/*********************************************************************
+ *********************************************************************/
+template<typename Type>
+inline PartitionCacheSortedRuns<Type>::PartitionCacheSortedRuns (const PartitionCacheSortedRuns<Type>& p)
+    : _ref(p._ref), _nbItemsCache(p._nbItemsCache), _synchro(p._synchro), _synchros(p._synchros), _cachedCollections(p.size())
+{
+    /** We create the partition files; the copies share the synchronizers but not the caches. */
+    for (size_t i=0; i<_cachedCollections.size(); i++)
+    {
+        PartitionCacheSortedRuns<Type>& pp = (PartitionCacheSortedRuns<Type>&)p;
+
+        _cachedCollections[i] = new collections::impl::CollectionCacheSortedRuns<Type> (pp[i].getRef(), p._nbItemsCache, p._synchros[i]);
+        _cachedCollections[i]->use ();
+        _synchros[i]->use();
+    }
+}
+
+/*********************************************************************
+ *********************************************************************/
+template<typename Type>
+inline PartitionCacheSortedRuns<Type>::~PartitionCacheSortedRuns ()
+{
+    flush ();
+    for (size_t i=0; i<_cachedCollections.size(); i++)  {
+        _cachedCollections[i]->forget ();
+        _synchros[i]->forget();
+    }
+}
+
+/*********************************************************************
+ *********************************************************************/
+template<typename Type>
+inline size_t  PartitionCacheSortedRuns<Type>::size() const
+{
+    return _cachedCollections.size();
+}
+
+/*********************************************************************
+ *********************************************************************/
+template<typename Type>
+inline collections::impl::CollectionCacheSortedRuns<Type>&   PartitionCacheSortedRuns<Type>::operator[] (size_t idx)
+{
+    return * _cachedCollections[idx];
+}
+
+/*********************************************************************
+ *********************************************************************/
+template<typename Type>
+inline void PartitionCacheSortedRuns<Type>::flush ()
+{
+    for (size_t i=0; i<_cachedCollections.size(); i++)  { _cachedCollections[i]->flush();  }
+}
+
+/*********************************************************************
+ *********************************************************************/
+template<typename Type>
+inline void PartitionCacheSortedRuns<Type>::remove ()
+{
+    for (size_t i=0; i<_cachedCollections.size(); i++)  { _cachedCollections[i]->remove ();  }
+}
+
 /********************************************************************************/
 } } } } } /* end of namespaces. */
 /********************************************************************************/
 
 #include <gatb/tools/storage/impl/StorageHDF5.hpp>
 #include <gatb/tools/storage/impl/StorageFile.hpp>
+#include <gatb/tools/storage/impl/StorageMmap.hpp>
 
 /********************************************************************************/
 namespace gatb  {  namespace core  {  namespace tools  {  namespace storage  {  namespace impl {
@@ -532,6 +626,7 @@ inline Storage* StorageFactory::create (const std::string& name, bool deleteIfEx
         case STORAGE_FILE:  return StorageFileFactory::createStorage (name, deleteIfExist, autoRemove);
         case STORAGE_GZFILE:  return StorageGzFileFactory::createStorage (name, deleteIfExist, autoRemove);
         case STORAGE_COMPRESSED_FILE:  return StorageSortedFactory::createStorage (name, deleteIfExist, autoRemove);
+        case STORAGE_MMAP:  return StorageMmapFactory::createStorage (name, deleteIfExist, autoRemove, dont_add_extension, append);
         default:            throw system::Exception ("Unknown mode in StorageFactory::createStorage");
     }
 }
@@ -546,6 +641,7 @@ inline bool StorageFactory::exists (const std::string& name)
         case STORAGE_FILE:              return StorageFileFactory::exists (name);
         case STORAGE_GZFILE:            return StorageGzFileFactory::exists (name);
         case STORAGE_COMPRESSED_FILE:   return StorageSortedFactory::exists (name);
+        case STORAGE_MMAP:              return StorageMmapFactory::exists (name);
         default:            throw system::Exception ("Unknown mode in StorageFactory::exists");
     }
 }
@@ -560,6 +656,7 @@ inline Group* StorageFactory::createGroup (ICell* parent, const std::string& nam
         case STORAGE_FILE:  return StorageFileFactory::createGroup (parent, name);
         case STORAGE_GZFILE:  return StorageGzFileFactory::createGroup (parent, name);
         case STORAGE_COMPRESSED_FILE:  return StorageSortedFactory::createGroup (parent, name);
+        case STORAGE_MMAP:  return StorageMmapFactory::createGroup (parent, name);
 
         default:            throw system::Exception ("Unknown mode in StorageFactory::createGroup");
     }
@@ -576,6 +673,7 @@ inline Partition<Type>* StorageFactory::createPartition (ICell* parent, const st
         case STORAGE_FILE:  return StorageFileFactory::createPartition<Type> (parent, name, nb);
         case STORAGE_GZFILE:  return StorageGzFileFactory::createPartition<Type> (parent, name, nb);
         case STORAGE_COMPRESSED_FILE:  return StorageSortedFactory::createPartition<Type> (parent, name, nb);
+        case STORAGE_MMAP:  return StorageMmapFactory::createPartition<Type> (parent, name, nb);
 
         default:            throw system::Exception ("Unknown mode in StorageFactory::createPartition");
     }
@@ -592,11 +690,25 @@ inline CollectionNode<Type>* StorageFactory::createCollection (ICell* parent, co
         case STORAGE_FILE:  return StorageFileFactory::createCollection<Type> (parent, name, synchro);
         case STORAGE_GZFILE:  return StorageGzFileFactory::createCollection<Type> (parent, name, synchro);
         case STORAGE_COMPRESSED_FILE:  return StorageSortedFactory::createCollection<Type> (parent, name, synchro);
+        case STORAGE_MMAP:  return StorageMmapFactory::createCollection<Type> (parent, name, synchro);
 
         default:            throw system::Exception ("Unknown mode in StorageFactory::createCollection");
     }
 }
 
+/*********************************************************************
+*********************************************************************/
+template<typename Type>
+inline Type* StorageFactory::mapCollection (ICell* parent, const std::string& name, size_t& nbItems)
+{
+    switch (_mode)
+    {
+        case STORAGE_MMAP:  return StorageMmapFactory::mapCollection<Type> (parent, name, nbItems);
+
+        default:            nbItems = 0;  return 0;
+    }
+}
+
 /********************************************************************************/
 } } } } } /* end of namespaces. */
 /********************************************************************************/
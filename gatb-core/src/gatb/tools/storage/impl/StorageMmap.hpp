@@ -0,0 +1,504 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file StorageMmap.hpp
+ *  \brief Storage as a single memory mapped file
+ */
+
+#ifndef _GATB_CORE_TOOLS_STORAGE_IMPL_STORAGE_MMAP_HPP_
+#define _GATB_CORE_TOOLS_STORAGE_IMPL_STORAGE_MMAP_HPP_
+
+/********************************************************************************/
+
+#include <cassert>
+#include <gatb/tools/storage/impl/CollectionFile.hpp>
+#include <gatb/tools/storage/impl/CollectionMmap.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
+#include <json/json.hpp>
+#include <unistd.h>
+#include <map>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace tools     {
+namespace storage   {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Factory used for storage of kind STORAGE_MMAP
+ *
+ * The whole storage is a single file (with a '.gmap' extension), made of page aligned sections
+ * and a table of these sections:
+ *   - the content of each collection is a section (named after the full id of the collection)
+ *   - the properties of each group and collection are JSON sections ('.json' and '.props' suffixes)
+ *
+ * The file is opened with 'mmap', so the collections can be used in place (see Group::mapCollection)
+ * and the pages are shared by all the processes that open the same file.
+ *
+ * Collections and properties written through the storage are staged in a folder next to the file;
+ * they are packed with the untouched sections into a new file when the storage is deleted.
+ * A storage opened without 'append' on an existing file is read only.
+ */
+class StorageMmapFactory
+{
+public:
+
+    /** Create a Storage instance.
+     * \param[in] name : name of the instance to be created
+     * \param[in] deleteIfExist : if the storage exits in file system, delete it if true.
+     * \param[in] autoRemove : auto delete the storage from file system during Storage destructor.
+     * \param[in] dont_add_extension : don't add the '.gmap' extension to the name
+     * \param[in] append : open an existing file for adding new collections
+     * \return the created Storage instance
+     */
+    static Storage* createStorage (const std::string& name, bool deleteIfExist, bool autoRemove, bool dont_add_extension = false, bool append = false)
+    {
+        return new StorageMmap (STORAGE_MMAP, name, deleteIfExist, autoRemove, dont_add_extension, append);
+    }
+
+    /** Tells whether or not a Storage exists in file system given a name
+     * \param[in] name : name of the storage to be checked
+     * \return true if the storage exists in file system, false otherwise.
+     */
+    static bool exists (const std::string& name)
+    {
+        return system::impl::System::file().doesExist (name) || system::impl::System::file().doesExist (name + getExtension());
+    }
+
+    /** Create a Group instance and attach it to a cell in a storage.
+     * \param[in] parent : parent of the group to be created
+     * \param[in] name : name of the group to be created
+     * \return the created Group instance.
+     */
+    static Group* createGroup (ICell* parent, const std::string& name)
+    {
+        StorageMmap* storage = dynamic_cast<StorageMmap*> (ICell::getRoot (parent));
+        assert (storage != 0);
+
+        return new GroupMmap (storage, parent, name);
+    }
+
+    /** Create a Partition instance and attach it to a cell in a storage.
+     * \param[in] parent : parent of the partition to be created
+     * \param[in] name : name of the partition to be created
+     * \param[in] nb : number of collections of the partition (0 for retrieving it from the storage)
+     * \return the created Partition instance.
+     */
+    template<typename Type>
+    static Partition<Type>* createPartition (ICell* parent, const std::string& name, size_t nb)
+    {
+        StorageMmap* storage = dynamic_cast<StorageMmap*> (ICell::getRoot (parent));
+        assert (storage != 0);
+
+        /** The number of collections is a property of the partition group (as for HDF5). */
+        GroupMmap group (storage, parent, name);
+
+        if (nb==0)
+        {
+            nb = atoi (group.getProperty (getNbPartitionsName()).c_str());
+            if (nb==0)  {  throw system::Exception ("Partition '%s' has 0 items", name.c_str());  }
+        }
+        else
+        {
+            group.setProperty (getNbPartitionsName(), misc::impl::Stringify::format ("%d", nb));
+        }
+
+        return new Partition<Type> (storage->getFactory(), parent, name, nb);
+    }
+
+    /** Create a Collection instance and attach it to a cell in a storage.
+     * \param[in] parent : parent of the collection to be created
+     * \param[in] name : name of the collection to be created
+     * \param[in] synchro : synchronizer instance if needed
+     * \return the created Collection instance.
+     */
+    template<typename Type>
+    static CollectionNode<Type>* createCollection (ICell* parent, const std::string& name, system::ISynchronizer* synchro)
+    {
+        StorageMmap* storage = dynamic_cast<StorageMmap*> (ICell::getRoot (parent));
+        assert (storage != 0);
+
+        std::string section     = getSectionName (parent, name);
+        std::string stagingName = storage->getStagingName (section);
+
+        collections::Collection<Type>* ref = 0;
+
+        u_int8_t* data = 0;  u_int64_t size = 0;
+
+        if (storage->getSection (section, data, size) || stagingName.empty())
+        {
+            /** The collection is read in place (it may be empty for a read only storage). */
+            std::string props;  storage->getSection (section + ".props", props);
+            ref = new CollectionMmap<Type> ((Type*)data, size/sizeof(Type), stagingName, props);
+        }
+        else
+        {
+            /** New collections are staged as simple files. */
+            ref = new CollectionFile<Type> (stagingName);
+        }
+
+        return new CollectionNode<Type> (storage->getFactory(), parent, name, ref);
+    }
+
+    /** Get the items of a collection in place.
+     * \param[in] parent : parent of the collection
+     * \param[in] name : name of the collection
+     * \param[out] nbItems : number of items of the collection
+     * \return the items of the collection, 0 if the collection is not in the mapped file.
+     */
+    template<typename Type>
+    static Type* mapCollection (ICell* parent, const std::string& name, size_t& nbItems)
+    {
+        StorageMmap* storage = dynamic_cast<StorageMmap*> (ICell::getRoot (parent));
+        assert (storage != 0);
+
+        u_int8_t* data = 0;  u_int64_t size = 0;
+        storage->getSection (getSectionName (parent, name), data, size);
+
+        nbItems = size / sizeof(Type);
+        return (Type*) data;
+    }
+
+    /** Extension of the storage files. */
+    static const char* getExtension ()  { return ".gmap"; }
+
+private:
+
+    /* */
+    static const char* getNbPartitionsName()  { return "nb_partitions"; }
+
+    /** Name of the section of a collection. */
+    static std::string getSectionName (ICell* parent, const std::string& name)
+    {
+        std::string parentId = parent->getFullId('.');
+        return parentId.empty() ? name : parentId + "." + name;
+    }
+
+    /************************************************************/
+    class StorageMmap : public Storage
+    {
+    public:
+
+        StorageMmap (StorageMode_e mode, const std::string& name, bool deleteIfExist, bool autoRemove, bool dont_add_extension, bool append)
+            : Storage (mode, name, autoRemove), _actualName(name), _file(0), _map(0), _mapSize(0), _readOnly(false), _removed(false)
+        {
+            /** We check whether the given name has a ".gmap" suffix. */
+            if (!dont_add_extension && ("." + system::impl::System::file().getExtension (name)) != getExtension())  {  _actualName += getExtension();  }
+
+            if (deleteIfExist)  {  system::impl::System::file().remove (_actualName);  }
+
+            bool exists = system::impl::System::file().doesExist (_actualName);
+
+            if (exists)  {  open ();  }
+
+            _readOnly = exists && !append;
+
+            /** The staging folder is specific to the process, so several processes may open the same file. */
+            if (!_readOnly)
+            {
+                _stagingFolder = misc::impl::Stringify::format ("%s.%d.staging/", _actualName.c_str(), getpid());
+                system::impl::System::file().mkdir (_stagingFolder, 0755);
+            }
+        }
+
+        virtual ~StorageMmap ()
+        {
+            /** We release the groups first, so the staged collections are closed before being packed. */
+            setRoot (0);
+
+            if (_autoRemove)  { remove(); }
+
+            /** A destructor can't throw, so we can only report a failure here. */
+            if (!_readOnly && !_removed)
+            {
+                try  { pack (); }
+                catch (system::Exception& e)  { std::cout << "Error while writing '" << _actualName << "': " << e.getMessage() << std::endl; }
+            }
+
+            clearStaging ();
+
+            if (_file != 0)  { delete _file; }
+        }
+
+        void remove ()
+        {
+            Storage::remove ();
+            system::impl::System::file().remove (_actualName);
+            _removed = true;
+        }
+
+        /** Get the file name of a staged section, empty if the storage is read only. */
+        std::string getStagingName (const std::string& section) const  {  return _readOnly ? "" : _stagingFolder + section;  }
+
+        /** Get a section of the mapped file (not overridden by a staged section). */
+        bool getSection (const std::string& section, u_int8_t*& data, u_int64_t& size)
+        {
+            std::map<std::string, std::pair<u_int64_t,u_int64_t> >::iterator it = _sections.find (section);
+            if (it == _sections.end() || (!_readOnly && system::impl::System::file().doesExist (getStagingName (section))))  { return false; }
+
+            data = _map + it->second.first;
+            size = it->second.second;
+            return true;
+        }
+
+        /** Get a text section, from the staging folder if staged, from the mapped file otherwise. */
+        bool getSection (const std::string& section, std::string& text)
+        {
+            std::string stagingName = getStagingName (section);
+
+            if (!stagingName.empty() && system::impl::System::file().doesExist (stagingName))
+            {
+                std::ifstream file (stagingName);
+                std::string line;
+                for (text.clear(); getline (file, line); )  { text += line; }
+                return true;
+            }
+
+            u_int8_t* data = 0;  u_int64_t size = 0;
+            if (getSection (section, data, size))  {  text.assign ((const char*)data, size);  return true;  }
+
+            return false;
+        }
+
+    private:
+
+        std::string    _actualName;
+        std::string    _stagingFolder;
+        system::IFile* _file;
+        u_int8_t*      _map;
+        u_int64_t      _mapSize;
+        bool           _readOnly;
+        bool           _removed;
+
+        /** Offset and size of the sections of the mapped file. */
+        std::map<std::string, std::pair<u_int64_t,u_int64_t> > _sections;
+
+        /** File layout: header in the first page, page aligned sections, then the sections table
+         * (offset, size, name length and name of each section). */
+        struct Header
+        {
+            char      magic[8];
+            u_int32_t version;
+            u_int32_t nbSections;
+            u_int64_t tableOffset;
+            u_int64_t tableSize;
+        };
+
+        static const char*     getMagic ()  { return "GATBMMAP"; }
+        static const u_int32_t VERSION   = 1;
+        static const u_int64_t PAGE_SIZE = 4096;
+
+        /** */
+        void open ()
+        {
+            _file = system::impl::System::file().newFile (_actualName, "rb");
+            if (_file == 0)  { throw system::Exception ("Unable to open '%s'", _actualName.c_str()); }
+
+            /** The sections are accessed randomly (Bloom filters, hash tables...). */
+            _map     = _file->map (false);
+            _mapSize = _file->getMapSize();
+
+            Header* header = (Header*) _map;
+
+            if (_mapSize < sizeof(Header) || memcmp (header->magic, getMagic(), sizeof(header->magic)) != 0)
+            {
+                throw system::Exception ("'%s' is not a GATB mapped storage file", _actualName.c_str());
+            }
+            if (header->version != VERSION)
+            {
+                throw system::Exception ("'%s' has version %d, expected %d", _actualName.c_str(), header->version, VERSION);
+            }
+            if (header->tableOffset + header->tableSize > _mapSize)
+            {
+                throw system::Exception ("'%s' is truncated", _actualName.c_str());
+            }
+
+            const u_int8_t* ptr = _map + header->tableOffset;
+            const u_int8_t* end = ptr  + header->tableSize;
+
+            for (u_int32_t i=0; i<header->nbSections; i++)
+            {
+                u_int64_t offset, size;  u_int32_t len;
+
+                if (ptr + 2*sizeof(u_int64_t) + sizeof(u_int32_t) > end)  { throw system::Exception ("'%s' has a bad sections table", _actualName.c_str()); }
+
+                memcpy (&offset, ptr, sizeof(offset));  ptr += sizeof(offset);
+                memcpy (&size,   ptr, sizeof(size));    ptr += sizeof(size);
+                memcpy (&len,    ptr, sizeof(len));     ptr += sizeof(len);
+
+                if (ptr + len > end || offset + size > _mapSize)  { throw system::Exception ("'%s' has a bad sections table", _actualName.c_str()); }
+
+                _sections[std::string ((const char*)ptr, len)] = std::make_pair (offset, size);
+                ptr += len;
+            }
+        }
+
+        /** */
+        void write (system::IFile* file, const void* data, u_int64_t size, u_int64_t& offset)
+        {
+            if (size > 0 && file->fwrite (data, size, 1) != 1)  { throw system::Exception ("Unable to write '%s'", file->getPath().c_str()); }
+            offset += size;
+        }
+
+        /** We write a new file with the mapped sections and the staged ones, then we replace
+         * the mapped file by the new one (processes that still map the old file are not affected). */
+        void pack ()
+        {
+            /** We list the staged sections, which override the mapped ones. */
+            std::map<std::string,std::string> sources;
+
+            for (std::map<std::string, std::pair<u_int64_t,u_int64_t> >::iterator it = _sections.begin(); it != _sections.end(); ++it)
+            {
+                sources[it->first] = "";
+            }
+
+            size_t nbStaged = 0;
+            std::vector<std::string> staged = system::impl::System::file().listdir (_stagingFolder);
+            for (size_t i=0; i<staged.size(); i++)
+            {
+                if (staged[i] == "." || staged[i] == "..")  { continue; }
+                sources[staged[i]] = _stagingFolder + staged[i];
+                nbStaged++;
+            }
+
+            /** Nothing to do if nothing has been written. */
+            if (nbStaged == 0 && _file != 0)  { return; }
+
+            std::string tmpName = misc::impl::Stringify::format ("%s.%d.tmp", _actualName.c_str(), getpid());
+
+            system::IFile* file = system::impl::System::file().newFile (tmpName, "wb");
+            if (file == 0)  { throw system::Exception ("Unable to create '%s'", tmpName.c_str()); }
+
+            std::vector<u_int8_t> buffer (4*1024*1024);
+            std::vector<u_int8_t> zeros  (PAGE_SIZE, 0);
+            std::vector<u_int8_t> table;
+            u_int64_t offset = 0;
+
+            /** The first page is for the header, written at the end. */
+            write (file, zeros.data(), PAGE_SIZE, offset);
+
+            for (std::map<std::string,std::string>::iterator it = sources.begin(); it != sources.end(); ++it)
+            {
+                /** Each section begins on a new page. */
+                if (offset % PAGE_SIZE != 0)  {  write (file, zeros.data(), PAGE_SIZE - offset % PAGE_SIZE, offset);  }
+
+                u_int64_t start = offset;
+
+                if (it->second.empty())
+                {
+                    std::pair<u_int64_t,u_int64_t>& section = _sections[it->first];
+                    write (file, _map + section.first, section.second, offset);
+                }
+                else
+                {
+                    system::IFile* in = system::impl::System::file().newFile (it->second, "rb");
+                    if (in == 0)  { throw system::Exception ("Unable to open '%s'", it->second.c_str()); }
+
+                    for (size_t n=0; (n = in->fread (buffer.data(), 1, buffer.size())) > 0; )  {  write (file, buffer.data(), n, offset);  }
+                    delete in;
+                }
+
+                u_int64_t size = offset - start;
+                u_int32_t len  = it->first.size();
+
+                table.insert (table.end(), (u_int8_t*)&start, (u_int8_t*)&start + sizeof(start));
+                table.insert (table.end(), (u_int8_t*)&size,  (u_int8_t*)&size  + sizeof(size));
+                table.insert (table.end(), (u_int8_t*)&len,   (u_int8_t*)&len   + sizeof(len));
+                table.insert (table.end(), it->first.begin(), it->first.end());
+            }
+
+            Header header;
+            memcpy (header.magic, getMagic(), sizeof(header.magic));
+            header.version     = VERSION;
+            header.nbSections  = sources.size();
+            header.tableOffset = offset;
+            header.tableSize   = table.size();
+
+            write (file, table.data(), table.size(), offset);
+            file->flush ();
+
+            if (file->pwrite (&header, sizeof(header), 0) != sizeof(header))  { throw system::Exception ("Unable to write '%s'", tmpName.c_str()); }
+            delete file;
+
+            if (system::impl::System::file().rename (tmpName, _actualName) != 0)
+            {
+                throw system::Exception ("Unable to rename '%s' into '%s'", tmpName.c_str(), _actualName.c_str());
+            }
+        }
+
+        /** */
+        void clearStaging ()
+        {
+            if (_stagingFolder.empty())  { return; }
+
+            std::vector<std::string> staged = system::impl::System::file().listdir (_stagingFolder);
+            for (size_t i=0; i<staged.size(); i++)
+            {
+                if (staged[i] == "." || staged[i] == "..")  { continue; }
+                system::impl::System::file().remove (_stagingFolder + staged[i]);
+            }
+            system::impl::System::file().rmdir (_stagingFolder);
+        }
+    };
+
+    /************************************************************/
+    class GroupMmap : public Group
+    {
+    public:
+
+        GroupMmap (StorageMmap* storage, ICell* parent, const std::string& name)
+            : Group (storage->getFactory(), parent, name), _filename (storage->getStagingName (getFullId('.') + ".json"))
+        {
+            std::string data;
+            if (storage->getSection (getFullId('.') + ".json", data) && data.size() > 0)  {  _json = json::LoadJson (data);  }
+        }
+
+        /** */
+        void addProperty (const std::string& key, const std::string value)  {  setProperty (key, value);  }
+
+        /** */
+        std::string getProperty (const std::string& key)
+        {
+            return _json.hasKey(key) ? _json[key].ToString() : std::string("");
+        }
+
+        /** */
+        void setProperty (const std::string& key, const std::string value)
+        {
+            if (_filename.empty())  { throw system::Exception ("Can't set property '%s' of a storage opened in read only mode", key.c_str()); }
+
+            _json[key] = value;
+
+            std::ofstream file (_filename);
+            file << _json.dump();
+        }
+
+    private:
+
+        std::string _filename;
+        json::JSON  _json;
+    };
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_STORAGE_IMPL_STORAGE_MMAP_HPP_ */
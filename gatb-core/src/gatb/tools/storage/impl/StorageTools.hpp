@@ -76,12 +76,12 @@ public:
     /** Load a Collection instance from a group
      * \param[in] group : group where the collection has to be load
      * \param[in] name : name of the collection the group
-     * \return a Collection instance, loaded from the group
+     * \return a Collection instance, loaded from the group (with an Eytzinger layout for fast 'contains' queries)
      */
     template<typename T>  collections::Container<T>*  loadContainer (Group& group, const std::string& name)
     {
         collections::Collection<T>*  storageCollection = & group.getCollection<T> (name);
-        return new collections::impl::ContainerSet<T> (storageCollection->iterator());
+        return new collections::impl::ContainerEytzinger<T> (storageCollection->iterator());
     }
 
     /** Save a Bloom filter into a group
@@ -121,7 +121,8 @@ public:
         bloomCollection->flush (); // R: wasn't there before but I guess this can't hurt
     }
 
-    /** Load a Bloom filter from a group
+    /** Load a Bloom filter from a group. If the storage maps the Bloom filter in memory (see
+     * Group::mapCollection), the bit set is used in place instead of being read.
      * \param[in] group : group where the Bloom filter is
      * \param[in] name : name of the Bloom filter in the group
      * \return the Bloom filter as an instance of IBloom
@@ -131,15 +132,27 @@ public:
         /** We retrieve the raw data buffer for the Bloom filter. */
         tools::collections::Collection<tools::math::NativeInt8>* bloomArray = & group.getCollection<tools::math::NativeInt8> (name);
 
+        size_t    mappedSize = 0;
+        u_int8_t* mapped     = (u_int8_t*) group.mapCollection<tools::math::NativeInt8> (name, mappedSize);
+
         /** We create the Bloom fiter. */
         tools::collections::impl::IBloom<T>* bloom = tools::collections::impl::BloomFactory::singleton().createBloom<T> (
             bloomArray->getProperty("type"),
             bloomArray->getProperty("size"),
             bloomArray->getProperty("nb_hash"),
-            bloomArray->getProperty("kmer_size")
+            bloomArray->getProperty("kmer_size"),
+            mapped
         );
 
-        if (bloomMode == 0)
+        if (mapped != 0)
+        {
+            if (bloom->getSize() > mappedSize)
+            {
+                u_int64_t size = bloom->getSize();  delete bloom;
+                throw system::Exception ("Bloom filter '%s' has %ld bytes instead of %ld", name.c_str(), (long)mappedSize, (long)size);
+            }
+        }
+        else if (bloomMode == 0)
         {
             /** We set the bloom with the provided array given as an iterable of NativeInt8 objects. */
             bloomArray->getItems ((tools::math::NativeInt8*&)bloom->getArray());
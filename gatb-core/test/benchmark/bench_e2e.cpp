@@ -0,0 +1,439 @@
+/* end-to-end benchmark on seeded synthetic datasets: kmers counting, graph creation, unitigs construction,
+ * graph simplifications and Leon compression/decompression, for several numbers of threads.
+ *
+ * usage: bench_e2e [options]  (bench_e2e -help for the list)
+ *
+ * Each dataset is a random genome (BankRandom) and reads sampled at random positions on both strands, with
+ * substitution errors at a given rate; the datasets only depend on the seed, so the results of two versions of
+ * the library can be compared on the same data.
+ *
+ * Each step is run in a child process, so the peak memory (RSS) is the one of the step only; the temporary disk
+ * is the peak size of the working directory of the step, polled while the step runs.
+ *
+ * The results are written as JSON: one object per (dataset, step, threads) run, with the time, the throughputs
+ * (reads/s, Mnt/s), the peak RSS, the temporary disk, the cpu times and some results of the step.
+ */
+
+#include <gatb/gatb_core.hpp>
+#include <gatb/tools/compression/Leon.hpp>
+
+#include <json/json.hpp>
+
+#include <chrono>
+#define get_wtime() chrono::system_clock::now()
+#define diff_wtime(x,y) chrono::duration_cast<chrono::nanoseconds>(y - x).count()
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+typedef GraphUnitigsTemplate<32> GraphUnitigs;
+
+/********************************************************************************/
+/** Description of a synthetic dataset. */
+struct Dataset
+{
+    size_t      genomeLength;
+    double      errorRate;
+    size_t      coverage;
+    size_t      readLength;
+    u_int64_t   seed;
+    string      readsFile;
+    u_int64_t   nbReads;
+    u_int64_t   nbNucleotides;
+};
+
+/** Parameters of a run of a step. */
+struct Run
+{
+    string  step;
+    size_t  nbCores;
+    size_t  kmerSize;
+    string  dir;
+};
+
+/********************************************************************************/
+/** Generate the reads of a dataset into a FASTA file (only if it doesn't exist yet). */
+void generateDataset (Dataset& dataset)
+{
+    static const char ACGT[] = "ACGT";
+    static const char TGCA[] = "TGCA";
+
+    dataset.nbReads       = (u_int64_t)dataset.genomeLength * dataset.coverage / dataset.readLength;
+    dataset.nbNucleotides = dataset.nbReads * dataset.readLength;
+
+    if (System::file().doesExist (dataset.readsFile))  { return; }
+
+    /** The genome is given by a BankRandom instance (seeded). */
+    string genome;
+    BankRandom genomeBank (1, dataset.genomeLength, dataset.seed);
+    Iterator<Sequence>* itGenome = genomeBank.iterator();  LOCAL (itGenome);
+    for (itGenome->first(); !itGenome->isDone(); itGenome->next())  {  genome = itGenome->item().toString();  }
+
+    /** The reads are sampled on both strands, with substitution errors. */
+    std::mt19937_64 rng (dataset.seed + 1);
+    std::uniform_real_distribution<double> uniform (0.0, 1.0);
+
+    string tmpFile = dataset.readsFile + ".tmp";
+    ofstream os (tmpFile.c_str());
+    string   read (dataset.readLength, 'A');
+
+    for (u_int64_t i=0; i<dataset.nbReads; i++)
+    {
+        size_t pos     = rng() % (dataset.genomeLength - dataset.readLength + 1);
+        bool   reverse = rng() & 1;
+
+        for (size_t j=0; j<dataset.readLength; j++)
+        {
+            read[j] = reverse ? TGCA [strchr (ACGT, genome[pos + dataset.readLength - 1 - j]) - ACGT] : genome[pos + j];
+
+            if (dataset.errorRate > 0 && uniform(rng) < dataset.errorRate)
+            {
+                read[j] = ACGT [(strchr (ACGT, read[j]) - ACGT + 1 + rng() % 3) % 4];
+            }
+        }
+
+        os << ">read" << i << "\n" << read << "\n";
+    }
+
+    os.close();
+    System::file().rename (tmpFile, dataset.readsFile);
+}
+
+/********************************************************************************/
+/** Size of the files of a directory (recursively). */
+u_int64_t getDirectorySize (const string& dir)
+{
+    u_int64_t result = 0;
+
+    vector<string> entries = System::file().listdir (dir);
+    for (size_t i=0; i<entries.size(); i++)
+    {
+        if (entries[i] == "." || entries[i] == "..")  { continue; }
+
+        string path = dir + "/" + entries[i];
+        if (System::file().doesExistDirectory (path))  {  result += getDirectorySize (path);    }
+        else                                           {  result += System::file().getSize (path);  }
+    }
+
+    return result;
+}
+
+/** Remove a directory and its content. */
+void removeDirectory (const string& dir)
+{
+    vector<string> entries = System::file().listdir (dir);
+    for (size_t i=0; i<entries.size(); i++)
+    {
+        if (entries[i] == "." || entries[i] == "..")  { continue; }
+
+        string path = dir + "/" + entries[i];
+        if (System::file().doesExistDirectory (path))  {  removeDirectory (path);       }
+        else                                           {  System::file().remove (path); }
+    }
+    System::file().rmdir (dir);
+}
+
+/** Order independent checksum of the sequences of a bank. */
+pair<u_int64_t,u_int64_t> getChecksum (const string& uri)
+{
+    u_int64_t nb = 0, checksum = 0;
+
+    IBank* bank = Bank::open (uri);  LOCAL (bank);
+    Iterator<Sequence>* it = bank->iterator();  LOCAL (it);
+    for (it->first(); !it->isDone(); it->next())
+    {
+        nb ++;
+        checksum += std::hash<string>() (it->item().toString());
+    }
+    return make_pair (nb, checksum);
+}
+
+/********************************************************************************/
+/** Execution of a step, in the child process. The time of the step and some of its results are set in 'result'. */
+void executeStep (const Dataset& dataset, const Run& run, json::JSON& result)
+{
+    string options = Stringify::format ("-in %s -kmer-size %d -abundance-min 2 -nb-cores %d -verbose 0 -out %s/graph -out-tmp %s",
+        dataset.readsFile.c_str(), (int)run.kmerSize, (int)run.nbCores, run.dir.c_str(), run.dir.c_str()
+    );
+
+    if (run.step == "counting")
+    {
+        IOptionsParser* parser = SortingCountAlgorithm<>::getOptionsParser();  LOCAL (parser);
+        IProperties* props = parser->parseString (options);
+
+        IBank* bank = Bank::open (dataset.readsFile);  LOCAL (bank);
+
+        auto t0 = get_wtime();
+        SortingCountAlgorithm<> algo (bank, props);
+        algo.execute();
+        result["time"] = diff_wtime (t0, get_wtime()) / 1e9;
+
+        result["nb_solid_kmers"] = algo.getSolidCounts()->getNbItems();
+    }
+    else if (run.step == "graph")
+    {
+        auto t0 = get_wtime();
+        Graph graph = Graph::create ("%s", options.c_str());
+        result["time"] = diff_wtime (t0, get_wtime()) / 1e9;
+
+        result["nb_solid_kmers"] = atol (graph.getGroup().getProperty ("nb_solid_kmers").c_str());
+    }
+    else if (run.step == "unitigs")
+    {
+        auto t0 = get_wtime();
+        GraphUnitigs graph = GraphUnitigs::create ("%s", options.c_str());
+        result["time"] = diff_wtime (t0, get_wtime()) / 1e9;
+
+        result["nb_unitigs"] = atol (graph.getGroup().getProperty ("nb_unitigs").c_str());
+    }
+    else if (run.step == "simplify")
+    {
+        GraphUnitigs graph = GraphUnitigs::create ("%s", options.c_str());
+
+        /** Only the simplifications are timed (the peak memory includes the graph creation). */
+        auto t0 = get_wtime();
+        graph.simplify (run.nbCores, false);
+        result["time"] = diff_wtime (t0, get_wtime()) / 1e9;
+    }
+    else if (run.step == "leon")
+    {
+        /** Leon writes its files next to its input, so we work on a link to the reads. */
+        string input = run.dir + "/reads.fa";
+        if (symlink (System::file().getRealPath(dataset.readsFile).c_str(), input.c_str()) != 0)  { throw Exception ("unable to link %s", input.c_str()); }
+
+        string compress   = Stringify::format ("-file %s -c -nb-cores %d -verbose 0",      input.c_str(), (int)run.nbCores);
+        string decompress = Stringify::format ("-file %s.leon -d -nb-cores %d -verbose 0", input.c_str(), (int)run.nbCores);
+
+        auto t0 = get_wtime();
+        { Leon leon;  leon.run (leon.getParser()->parseString (compress)); }
+        auto t1 = get_wtime();
+
+        result["compressed_size"] = System::file().getSize (input + ".leon");
+        System::file().remove (input);
+
+        { Leon leon;  leon.run (leon.getParser()->parseString (decompress)); }
+        auto t2 = get_wtime();
+
+        result["time"]            = diff_wtime (t0, t2) / 1e9;
+        result["compress_time"]   = diff_wtime (t0, t1) / 1e9;
+        result["decompress_time"] = diff_wtime (t1, t2) / 1e9;
+        result["ratio"]           = (double) System::file().getSize (dataset.readsFile) / result["compressed_size"].ToInt();
+
+        /** We check the round trip on the decompressed file. */
+        result["round_trip_ok"] = getChecksum (run.dir + "/reads.fasta.d") == getChecksum (dataset.readsFile);
+    }
+    else
+    {
+        throw Exception ("unknown step '%s'", run.step.c_str());
+    }
+}
+
+/********************************************************************************/
+/** Run a step in a child process, and gather its measures. */
+json::JSON runStep (const Dataset& dataset, const Run& run)
+{
+    json::JSON result;
+    result["step"]          = run.step;
+    result["threads"]       = run.nbCores;
+    result["kmer_size"]     = run.kmerSize;
+    result["genome_length"] = dataset.genomeLength;
+    result["error_rate"]    = dataset.errorRate;
+    result["coverage"]      = dataset.coverage;
+    result["read_length"]   = dataset.readLength;
+    result["seed"]          = dataset.seed;
+    result["nb_reads"]      = dataset.nbReads;
+
+    System::file().mkdir (run.dir, S_IRWXU);
+
+    int fds[2];
+    if (pipe (fds) != 0)  { throw Exception ("unable to create a pipe"); }
+
+    pid_t pid = fork ();
+    if (pid < 0)  { throw Exception ("unable to fork"); }
+
+    if (pid == 0)
+    {
+        /** Child process: we execute the step and send its results as a JSON line. */
+        ::close (fds[0]);
+
+        json::JSON childResult;
+        try                     {  executeStep (dataset, run, childResult);  }
+        catch (Exception& e)    {  childResult["error"] = e.getMessage();    }
+
+        string line = childResult.dump (1, "");
+        std::replace (line.begin(), line.end(), '\n', ' ');
+        if (::write (fds[1], line.data(), line.size()) < 0)  {}
+        ::close (fds[1]);
+        _exit (0);
+    }
+
+    ::close (fds[1]);
+
+    /** We poll the size of the working directory while the step runs. */
+    u_int64_t     diskMax = 0;
+    int           status  = 0;
+    struct rusage usage;
+    while (wait4 (pid, &status, WNOHANG, &usage) == 0)
+    {
+        diskMax = std::max (diskMax, getDirectorySize (run.dir));
+        usleep (100*1000);
+    }
+
+    string line;
+    char   buffer[4096];
+    for (ssize_t n; (n = ::read (fds[0], buffer, sizeof(buffer))) > 0; )  {  line.append (buffer, n);  }
+    ::close (fds[0]);
+
+    json::JSON childResult = line.empty() ? json::JSON() : json::LoadJson (line);
+
+    if (line.empty() || childResult.hasKey ("error"))
+    {
+        result["error"] = line.empty() ? string ("no result (status " + Stringify::format("%d", status) + ")") : childResult["error"].ToString();
+    }
+    else
+    {
+        double time = childResult["time"].ToFloat();
+
+        for (auto& item : childResult.ObjectRange())  {  result[item.first] = item.second;  }
+
+        result["reads_per_s"] = time > 0 ? dataset.nbReads / time : 0;
+        result["mnt_per_s"]   = time > 0 ? dataset.nbNucleotides / time / 1e6 : 0;
+    }
+
+    /** The peak RSS is given in KB by wait4 on Linux. */
+    result["peak_rss_mb"]   = usage.ru_maxrss / 1024;
+    result["tmp_disk_mb"]   = diskMax / (1024*1024);
+    result["cpu_user"]      = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+    result["cpu_sys"]       = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+
+    removeDirectory (run.dir);
+
+    return result;
+}
+
+/********************************************************************************/
+/** Split a comma separated list. */
+template<typename T> vector<T> getList (const string& s)
+{
+    vector<T> result;
+    stringstream ss (s);
+    for (string item; getline (ss, item, ','); )  {  stringstream is (item);  T value;  is >> value;  result.push_back (value);  }
+    return result;
+}
+
+/********************************************************************************/
+int main (int argc, char* argv[])
+{
+    OptionsParser parser ("bench_e2e");
+
+    parser.push_back (new OptionOneParam ("-genome-sizes", "genome lengths of the datasets (comma separated)",   false, "1000000,10000000"));
+    parser.push_back (new OptionOneParam ("-error-rates",  "substitution rates of the reads (comma separated)", false, "0,0.01"));
+    parser.push_back (new OptionOneParam ("-threads",      "numbers of threads (comma separated)",             false, "1,4"));
+    parser.push_back (new OptionOneParam ("-steps",        "steps among counting,graph,unitigs,simplify,leon", false, "counting,graph,unitigs,simplify,leon"));
+    parser.push_back (new OptionOneParam ("-coverage",     "coverage of the reads",                            false, "30"));
+    parser.push_back (new OptionOneParam ("-read-len",     "length of the reads",                              false, "150"));
+    parser.push_back (new OptionOneParam (STR_KMER_SIZE,   "size of a kmer",                                   false, "31"));
+    parser.push_back (new OptionOneParam ("-seed",         "seed of the datasets",                             false, "42"));
+    parser.push_back (new OptionOneParam ("-dir",          "working directory (datasets and temporary files)", false, "bench_e2e_data"));
+    parser.push_back (new OptionOneParam ("-out",          "JSON file of the results",                         false, "bench_e2e.json"));
+
+    try
+    {
+        IProperties* options = parser.parse (argc, argv);
+
+        string dir = options->getStr ("-dir");
+        System::file().mkdir (dir, S_IRWXU);
+
+        json::JSON report;
+        report["benchmark"]    = "bench_e2e";
+        report["version"]      = System::info().getVersion();
+        report["host"]         = System::info().getHostName();
+        report["nb_cores"]     = System::info().getNbCores();
+        report["memory_mb"]    = System::info().getMemoryPhysicalTotal() / (1024*1024);
+        report["results"]      = json::JSON::Make (json::JSON::Class::Array);
+
+        vector<size_t> genomeSizes = getList<size_t> (options->getStr ("-genome-sizes"));
+        vector<double> errorRates  = getList<double> (options->getStr ("-error-rates"));
+        vector<size_t> threads     = getList<size_t> (options->getStr ("-threads"));
+        vector<string> steps       = getList<string> (options->getStr ("-steps"));
+
+        cout.setf (ios_base::fixed);
+        cout.precision (3);
+
+        for (size_t g=0; g<genomeSizes.size(); g++)
+        {
+            for (size_t e=0; e<errorRates.size(); e++)
+            {
+                Dataset dataset;
+                dataset.genomeLength = genomeSizes[g];
+                dataset.errorRate    = errorRates[e];
+                dataset.coverage     = options->getInt ("-coverage");
+                dataset.readLength   = options->getInt ("-read-len");
+                dataset.seed         = options->getInt ("-seed");
+                dataset.readsFile    = Stringify::format ("%s/reads_%ld_%g_%ld_%ld_%ld.fa", dir.c_str(),
+                    dataset.genomeLength, dataset.errorRate, dataset.coverage, dataset.readLength, dataset.seed
+                );
+
+                generateDataset (dataset);
+
+                cout << "dataset " << dataset.readsFile << " : " << dataset.nbReads << " reads" << endl;
+
+                for (size_t s=0; s<steps.size(); s++)
+                {
+                    for (size_t t=0; t<threads.size(); t++)
+                    {
+                        Run run;
+                        run.step     = steps[s];
+                        run.nbCores  = threads[t];
+                        run.kmerSize = options->getInt (STR_KMER_SIZE);
+                        run.dir      = dir + "/run_" + run.step;
+
+                        json::JSON result = runStep (dataset, run);
+
+                        if (result.hasKey ("error"))
+                        {
+                            cout << "    " << run.step << " threads " << run.nbCores << " : ERROR " << result["error"].ToString() << endl;
+                        }
+                        else
+                        {
+                            cout << "    " << run.step << " threads " << run.nbCores
+                                 << " : time " << result["time"].ToFloat() << " s   " << result["mnt_per_s"].ToFloat() << " Mnt/s"
+                                 << "   rss " << result["peak_rss_mb"].ToInt() << " MB   tmp disk " << result["tmp_disk_mb"].ToInt() << " MB"
+                                 << endl;
+                        }
+
+                        report["results"].append (result);
+                    }
+                }
+            }
+        }
+
+        /** We write the results. */
+        ofstream os (options->getStr("-out").c_str());
+        os << report.dump() << endl;
+    }
+    catch (OptionFailure& e)
+    {
+        return e.displayErrors (std::cout);
+    }
+    catch (Exception& e)
+    {
+        cerr << "EXCEPTION: " << e.getMessage() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+/* micro-benchmark of kmer rolling (canonical kmers, revcomp, hash) for each span of KSIZE_LIST */
+
+#include <chrono>
+#define get_wtime() chrono::system_clock::now()
+#define diff_wtime(x,y) chrono::duration_cast<chrono::nanoseconds>(y - x).count()
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/tools/math/Integer.hpp>
+#include <gatb/tools/misc/api/Data.hpp>
+#include <gatb/tools/misc/api/Macros.hpp>
+#include <gatb/kmer/impl/Model.hpp>
+
+#include <iostream>
+#include <string>
+#include <random>
+
+using namespace std;
+
+using namespace gatb::core::kmer;
+using namespace gatb::core::kmer::impl;
+using namespace gatb::core::system;
+using namespace gatb::core::tools::misc;
+using namespace gatb::core::tools::math;
+
+/********************************************************************************/
+struct Parameter
+{
+    Parameter (size_t k, const string& seq, size_t nbRepetitions) : k(k), seq(seq), nbRepetitions(nbRepetitions) {}
+    size_t        k;
+    const string& seq;
+    size_t        nbRepetitions;
+};
+
+/********************************************************************************/
+template<size_t span> struct kmer_rolling_bench {  void operator ()  (Parameter params)
+{
+    typedef typename Kmer<span>::Type            Type;
+    typedef typename Kmer<span>::ModelCanonical  ModelCanonical;
+
+    double unit = 1000000000;
+    cout.setf(ios_base::fixed);
+    cout.precision(3);
+
+    ModelCanonical model (params.k);
+    Data data (params.seq);
+
+    /** Rolling of canonical kmers over the sequence. */
+    u_int64_t checksum = 0;
+    size_t    nbKmers  = 0;
+
+    auto start_t = get_wtime();
+    for (size_t r=0; r<params.nbRepetitions; r++)
+    {
+        model.iterate (data, [&] (const typename ModelCanonical::Kmer& kmer, size_t idx)
+        {
+            checksum ^= kmer.value().getVal();
+            nbKmers++;
+        });
+    }
+    auto end_t = get_wtime();
+    double rollTime = diff_wtime(start_t, end_t) / unit;
+
+    /** Revcomp and hash of the forward kmers. */
+    vector<Type> kmers;
+    model.iterate (data, [&] (const typename ModelCanonical::Kmer& kmer, size_t idx)  {  kmers.push_back (kmer.forward());  });
+
+    start_t = get_wtime();
+    for (size_t r=0; r<params.nbRepetitions; r++)
+    {
+        for (size_t i=0; i<kmers.size(); i++)  {  checksum ^= hash1 (revcomp (kmers[i], params.k), 0);  }
+    }
+    end_t = get_wtime();
+    double revcompTime = diff_wtime(start_t, end_t) / unit;
+
+    cout << "span " << span << " (" << Type::getName() << ")  k=" << params.k
+         << "  rolling: "        << nbKmers / rollTime / 1000000.0 << " Mkmers/s"
+         << "  revcomp+hash: "   << kmers.size() * params.nbRepetitions / revcompTime / 1000000.0 << " Mkmers/s"
+         << "  (checksum " << hex << checksum << dec << ")" << endl;
+}};
+
+/********************************************************************************/
+int main (int argc, char* argv[])
+{
+    size_t seqLength     = argc > 1 ? atol (argv[1]) : 1000000;
+    size_t nbRepetitions = argc > 2 ? atol (argv[2]) : 10;
+
+    /** We build a random sequence (fixed seed for reproducibility). */
+    const char ACGT[] = "ACGT";
+    std::mt19937_64 rng (42);
+    string seq (seqLength, 'A');
+    for (size_t i=0; i<seqLength; i++)  {  seq[i] = ACGT[rng() & 3];  }
+
+    try
+    {
+        /** One run per span of KSIZE_LIST, with the largest kmer size supported by the span. */
+        size_t spans[] = { KSIZE_LIST };
+
+        for (size_t i=0; i<ARRAY_SIZE(spans); i++)
+        {
+            size_t k = spans[i] - 1;
+            Integer::apply<kmer_rolling_bench, Parameter> (k, Parameter (k, seq, nbRepetitions));
+        }
+    }
+    catch (Exception& e)
+    {
+        cerr << "EXCEPTION: " << e.getMessage() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+/* benchmark of contigs generation from a GraphUnitigs (simple paths traversal, as done by minia), in contigs per second
+ *
+ * usage: bench_unitigs [reads file [kmer size [nb cores]]]
+ * without reads file, the graph is built from a random genome with many SNP variants, so it has many unitigs.
+ */
+
+#include <chrono>
+#define get_wtime() chrono::system_clock::now()
+#define diff_wtime(x,y) chrono::duration_cast<chrono::nanoseconds>(y - x).count()
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/bank/impl/BankStrings.hpp>
+#include <gatb/debruijn/impl/GraphUnitigs.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+
+using namespace std;
+
+using namespace gatb::core::debruijn;
+using namespace gatb::core::debruijn::impl;
+using namespace gatb::core::bank::impl;
+using namespace gatb::core::system;
+
+typedef GraphUnitigsTemplate<32> GraphUnitigs;
+
+/********************************************************************************/
+int main (int argc, char* argv[])
+{
+    string readsFile = argc > 1 ? argv[1] : "";
+    size_t kmerSize  = argc > 2 ? atol (argv[2]) : 31;
+    size_t nbCores   = argc > 3 ? atol (argv[3]) : 0;
+
+    double unit = 1000000000;
+
+    try
+    {
+        GraphUnitigs graph;
+
+        if (readsFile != "")
+        {
+            graph = GraphUnitigs::create ("-in %s -kmer-size %d -abundance-min 2 -nb-cores %d -verbose 0 -out bench_unitigs",
+                readsFile.c_str(), kmerSize, nbCores
+            );
+        }
+        else
+        {
+            /** Random genome (fixed seed for reproducibility), plus copies of random windows with one SNP. */
+            const char ACGT[] = "ACGT";
+            std::mt19937_64 rng (42);
+            size_t genomeLength = 10*1000*1000;
+            string genome (genomeLength, 'A');
+            for (size_t i=0; i<genomeLength; i++)  {  genome[i] = ACGT[rng() & 3];  }
+
+            vector<string> seqs (1, genome);
+            for (size_t i=0; i<genomeLength/1000; i++)
+            {
+                size_t pos = rng() % (genomeLength - 2*kmerSize);
+                string variant = genome.substr (pos, 2*kmerSize);
+                variant[kmerSize] = ACGT[(rng() & 3)];
+                seqs.push_back (variant);
+            }
+
+            graph = GraphUnitigs::create (new BankStrings (seqs), "-kmer-size %d -abundance-min 1 -nb-cores %d -verbose 0 -out bench_unitigs",
+                kmerSize, nbCores
+            );
+        }
+
+        cout << "graph built, benchmarking.." << endl;
+
+        cout.setf(ios_base::fixed);
+        cout.precision(3);
+
+        /** We generate the contigs as minia does: each simple path is traversed once from one of its unitigs. */
+        size_t    nbContigs = 0;
+        u_int64_t nbNucl    = 0;
+
+        auto start_t = get_wtime();
+
+        GraphIterator<NodeGU> it = graph.iterator();
+        for (it.first(); !it.isDone(); it.next())
+        {
+            const NodeGU& node = it.item();
+
+            if (graph.unitigIsMarked(node))  { continue; }
+
+            bool  isolatedLeft, isolatedRight;
+            float coverage = 0;
+            string seq = graph.simplePathBothDirections (node, isolatedLeft, isolatedRight, true, coverage);
+
+            nbContigs ++;
+            nbNucl    += seq.size();
+        }
+
+        auto end_t = get_wtime();
+
+        double t = diff_wtime(start_t, end_t) / unit;
+
+        cout << "contigs: " << nbContigs << "  nucleotides: " << nbNucl << "  time: " << t << " s" << endl;
+        cout << "contigs per second: " << nbContigs / t << "  Mnt per second: " << nbNucl / t / 1000000 << endl;
+    }
+    catch (Exception& e)
+    {
+        cerr << "EXCEPTION: " << e.getMessage() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
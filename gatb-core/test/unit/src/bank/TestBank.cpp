@@ -26,10 +26,14 @@
 #include <gatb/bank/impl/BankHelpers.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 
+#include <kff-cpp-api/kff_io.hpp>
+
 #include <list>
+#include <sstream>
 #include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
 
@@ -71,12 +75,15 @@ class TestBank : public Test
         CPPUNIT_TEST_GATB (bank_checkEstimateNbSequences);
         CPPUNIT_TEST_GATB (bank_checkProgress);
         CPPUNIT_TEST_GATB (bank_checkConvertBinary);
+        CPPUNIT_TEST_GATB (bank_checkBinaryIndexed);
+        CPPUNIT_TEST_GATB (bank_checkKff);
         CPPUNIT_TEST_GATB (bank_checkRegistery1);
         CPPUNIT_TEST_GATB (bank_checkRegistery2);
         CPPUNIT_TEST_GATB (bank_strings1);
         CPPUNIT_TEST_GATB (bank_sequence);
         CPPUNIT_TEST_GATB (bank_splitter_1);
         CPPUNIT_TEST_GATB (bank_random_1);
+        CPPUNIT_TEST_GATB (bank_random_2);
         CPPUNIT_TEST_GATB (bank_composite);
         CPPUNIT_TEST_GATB (bank_album1);
         CPPUNIT_TEST_GATB (bank_album2);
@@ -641,6 +648,253 @@ public:
         bank_checkConvertBinary_aux (DBPATH("reads2.fa"),     true);
     }
 
+    /********************************************************************************/
+    struct CountSequencesFunctor
+    {
+        u_int64_t& nbSequences;  u_int64_t& nbNucleotides;
+        CountSequencesFunctor (u_int64_t& nbSequences, u_int64_t& nbNucleotides) : nbSequences(nbSequences), nbNucleotides(nbNucleotides) {}
+        void operator() (Sequence& seq)
+        {
+            __sync_fetch_and_add (&nbSequences, 1);
+            __sync_fetch_and_add (&nbNucleotides, seq.getDataSize());
+        }
+    };
+
+    /** \brief Check the indexed binary bank: invalid characters, comments and qualities are kept,
+     * counts are exact, sequences can be accessed randomly and blocks can be read by several threads.
+     */
+    void bank_checkBinaryIndexed ()
+    {
+        string filename = "test.bin2";
+
+        /** We build sequences with invalid characters, and enough of them to get several blocks. */
+        vector<string> sequences;
+        sequences.push_back ("ACGTNNNNACGTacgtRYACGTACGTAN");
+        sequences.push_back ("NNNNN");
+        sequences.push_back ("");
+        sequences.push_back ("ACGTACGTACG");
+        for (size_t i=0; i<20000; i++)  {  sequences.push_back (string (100 + i%300, "ACGT"[i%4]) + (i%7==0 ? "N" : "") + "GATTACA");  }
+
+        u_int64_t totalSize = 0, maxSize = 0;
+        for (size_t i=0; i<sequences.size(); i++)  {  totalSize += sequences[i].size();  maxSize = std::max (maxSize, (u_int64_t)sequences[i].size());  }
+
+        BankStrings bank1 (sequences);
+
+        BankBinaryIndexed* bank2 = new BankBinaryIndexed (filename, true, true);
+        LOCAL (bank2);
+
+        /** We insert the sequences (with a comment and a quality) and flush the bank (which writes the index). */
+        Iterator<Sequence>* itSeq1 = bank1.iterator();  LOCAL (itSeq1);
+        for (itSeq1->first(); !itSeq1->isDone(); itSeq1->next())
+        {
+            stringstream ss;  ss << "seq" << itSeq1->item().getIndex();
+            itSeq1->item().setComment (ss.str());
+            itSeq1->item().setQuality (string (itSeq1->item().getDataSize(), 'I'));
+            bank2->insert (itSeq1->item());
+        }
+        bank2->flush ();
+
+        CPPUNIT_ASSERT (BankBinaryIndexed::check (filename) == true);
+        CPPUNIT_ASSERT (Bank::getType (filename) == BankBinaryIndexed::name());
+
+        /** We check the exact counts (read from another instance). */
+        BankBinaryIndexed* bank3 = new BankBinaryIndexed (filename);
+        LOCAL (bank3);
+
+        u_int64_t nb=0, total=0, max=0;
+        bank3->estimate (nb, total, max);
+        CPPUNIT_ASSERT (bank3->getNbItems() == (int64_t)sequences.size());
+        CPPUNIT_ASSERT (nb == sequences.size());
+        CPPUNIT_ASSERT (total == totalSize);
+        CPPUNIT_ASSERT (max == maxSize);
+
+        /** We check the sequences: invalid characters are read as 'N', valid ones in upper case. */
+        Iterator<Sequence>* itSeq3 = bank3->iterator();  LOCAL (itSeq3);
+        size_t idx = 0;
+        for (itSeq3->first(); !itSeq3->isDone(); itSeq3->next(), idx++)
+        {
+            Sequence& seq = itSeq3->item();
+
+            stringstream ss;  ss << "seq" << idx;
+
+            CPPUNIT_ASSERT (idx < sequences.size());
+            CPPUNIT_ASSERT (seq.getIndex() == idx);
+            CPPUNIT_ASSERT (seq.getDataSize() == sequences[idx].size());
+            CPPUNIT_ASSERT (seq.getComment() == ss.str());
+            CPPUNIT_ASSERT (seq.getQuality() == string (seq.getDataSize(), 'I'));
+
+            for (size_t i=0; i<seq.getDataSize(); i++)
+            {
+                char c = sequences[idx][i];
+                bool valid = Data::validNucleotide[(unsigned char)c] == 0;
+
+                if (seq.getDataEncoding() == Data::BINARY)
+                {
+                    CPPUNIT_ASSERT (valid && Data::ConvertBinary::get (seq.getDataBuffer(), i).first == Data::ConvertASCII::get (&c, 0).first);
+                }
+                else
+                {
+                    CPPUNIT_ASSERT (seq.getDataBuffer()[i] == (valid ? toupper(c) : 'N'));
+                }
+            }
+        }
+        CPPUNIT_ASSERT (idx == sequences.size());
+
+        /** We go directly to some sequences. */
+        BankBinaryIndexed::Iterator itRandom (*bank3);
+        for (size_t i=0; i<sequences.size(); i+=997)
+        {
+            stringstream ss;  ss << "seq" << i;
+
+            itRandom.first (i);
+            CPPUNIT_ASSERT (itRandom.isDone() == false);
+            CPPUNIT_ASSERT (itRandom.item().getIndex() == i);
+            CPPUNIT_ASSERT (itRandom.item().getDataSize() == sequences[i].size());
+            CPPUNIT_ASSERT (itRandom.item().getComment() == ss.str());
+
+            itRandom.next();
+            CPPUNIT_ASSERT (itRandom.isDone() == (i+1 == sequences.size()));
+        }
+        itRandom.first (sequences.size());
+        CPPUNIT_ASSERT (itRandom.isDone() == true);
+
+        /** We iterate the blocks with several threads. */
+        u_int64_t nbSequences = 0, nbNucleotides = 0;
+        Dispatcher dispatcher (4);
+        bank3->iterate (&dispatcher, CountSequencesFunctor (nbSequences, nbNucleotides));
+        CPPUNIT_ASSERT (nbSequences   == sequences.size());
+        CPPUNIT_ASSERT (nbNucleotides == totalSize);
+
+        bank3->remove ();
+        CPPUNIT_ASSERT (System::file().doesExist (filename) == false);
+    }
+
+    /********************************************************************************/
+    struct CheckKffFunctor
+    {
+        u_int64_t& nbKmers;  u_int64_t& sumData;
+        CheckKffFunctor (u_int64_t& nbKmers, u_int64_t& sumData) : nbKmers(nbKmers), sumData(sumData) {}
+        void operator() (BankKff::Iterator& it)
+        {
+            __sync_fetch_and_add (&nbKmers, it.getNbKmers());
+            for (size_t i=0; i<it.getNbKmers(); i++)  {  __sync_fetch_and_add (&sumData, it.getKmerData(i));  }
+        }
+    };
+
+    /** Encode nucleotides on 2 bits with the default KFF encoding (A=0 C=1 G=3 T=2), aligned on the right. */
+    vector<u_int8_t> kffEncode (const string& seq)
+    {
+        vector<u_int8_t> result ((seq.size()+3)/4, 0);
+        size_t padding = 4*result.size() - seq.size();
+        for (size_t i=0; i<seq.size(); i++)
+        {
+            u_int8_t code = seq[i]=='A' ? 0 : seq[i]=='C' ? 1 : seq[i]=='G' ? 3 : 2;
+            result[(i+padding)/4] |= code << (2*(3 - (i+padding)%4));
+        }
+        return result;
+    }
+
+    /** \brief Check the KFF bank: the blocks of the raw and minimizer sections are read as sequences,
+     * with the data of their kmers, by one or several threads.
+     */
+    void bank_checkKff ()
+    {
+        string filename = "test.kff";
+
+        /** Blocks of a raw section (up to 4 kmers of size 5) and of a minimizer section (1 kmer each, minimizer size 3). */
+        const char* rawBlocks[] = { "ACGTACGT", "GGGAT", "TTACAGA" };
+        const char* miniBlocks[] = { "CATTG", "AAGCT" };
+
+        {
+            Kff_file file (filename, "w");
+            file.write_encoding (0, 1, 3, 2);
+            file.set_uniqueness (true);
+            file.set_canonicity (false);
+            file.write_metadata (0, nullptr);
+
+            Section_GV gv1 (&file);
+            gv1.write_var ("k", 5);  gv1.write_var ("max", 4);  gv1.write_var ("data_size", 1);
+            gv1.close ();
+
+            Section_Raw raw (&file);
+            for (size_t i=0; i<ARRAY_SIZE(rawBlocks); i++)
+            {
+                string seq = rawBlocks[i];
+                vector<u_int8_t> bytes = kffEncode (seq);
+                vector<u_int8_t> data (seq.size()-4, i+1);
+                raw.write_compacted_sequence (bytes.data(), seq.size(), data.data());
+            }
+            raw.close ();
+
+            Section_GV gv2 (&file);
+            gv2.write_var ("k", 5);  gv2.write_var ("m", 3);  gv2.write_var ("max", 1);  gv2.write_var ("data_size", 2);
+            gv2.close ();
+
+            /** The minimizer of each block is at position 1 (its 3 nucleotides are not stored in the block). */
+            for (size_t i=0; i<ARRAY_SIZE(miniBlocks); i++)
+            {
+                string seq = miniBlocks[i];
+                vector<u_int8_t> mini   = kffEncode (seq.substr (1, 3));
+                vector<u_int8_t> suffix = kffEncode (seq.substr (0, 1) + seq.substr (4));
+                u_int8_t data[] = { 1, 0 };
+
+                Section_Minimizer section (&file);
+                section.write_minimizer (mini.data());
+                section.write_compacted_sequence_without_mini (suffix.data(), 2, 1, data);
+                section.close ();
+            }
+
+            file.close ();
+        }
+
+        CPPUNIT_ASSERT (BankKff::check (filename) == true);
+        CPPUNIT_ASSERT (Bank::getType (filename) == BankKff::name());
+
+        IBank* bank = Bank::open (filename);
+        LOCAL (bank);
+
+        BankKff* bankKff = dynamic_cast<BankKff*> (bank);
+        CPPUNIT_ASSERT (bankKff != 0);
+
+        /** We check the exact counts. */
+        u_int64_t nb=0, total=0, max=0;
+        bank->estimate (nb, total, max);
+        CPPUNIT_ASSERT (nb    == ARRAY_SIZE(rawBlocks) + ARRAY_SIZE(miniBlocks));
+        CPPUNIT_ASSERT (total == 8 + 5 + 7 + 5 + 5);
+        CPPUNIT_ASSERT (max   == 8);
+        CPPUNIT_ASSERT (bankKff->getKmerSize() == 5);
+        CPPUNIT_ASSERT (bankKff->getNbKmers()  == 4 + 1 + 3 + 1 + 1);
+        CPPUNIT_ASSERT (bankKff->getDataSize() == 2);
+
+        /** We check the sequences and the data of their kmers. */
+        BankKff::Iterator it (*bankKff);
+        size_t idx = 0;
+        for (it.first(); !it.isDone(); it.next(), idx++)
+        {
+            Sequence& seq = it.item();
+            string expected = idx < ARRAY_SIZE(rawBlocks) ? rawBlocks[idx] : miniBlocks[idx - ARRAY_SIZE(rawBlocks)];
+
+            CPPUNIT_ASSERT (seq.toString() == expected);
+            CPPUNIT_ASSERT (it.getNbKmers() == expected.size() - 4);
+
+            for (size_t i=0; i<it.getNbKmers(); i++)
+            {
+                CPPUNIT_ASSERT (it.getKmerData(i) == (idx < ARRAY_SIZE(rawBlocks) ? idx+1 : 256));
+            }
+        }
+        CPPUNIT_ASSERT (idx == ARRAY_SIZE(rawBlocks) + ARRAY_SIZE(miniBlocks));
+
+        /** We iterate the sections with several threads. */
+        u_int64_t nbKmers = 0, sumData = 0;
+        Dispatcher dispatcher (4);
+        bankKff->iterateBlocks (&dispatcher, CheckKffFunctor (nbKmers, sumData));
+        CPPUNIT_ASSERT (nbKmers == bankKff->getNbKmers());
+        CPPUNIT_ASSERT (sumData == 4*1 + 1*2 + 3*3 + 256 + 256);
+
+        bank->remove ();
+        CPPUNIT_ASSERT (System::file().doesExist (filename) == false);
+    }
+
     /********************************************************************************/
     /** \brief Performance test
      */
@@ -824,6 +1078,40 @@ public:
         }
     }
 
+    /********************************************************************************/
+    void bank_random_getSequences (BankRandom& bank, vector<string>& sequences)
+    {
+        Iterator<Sequence>* it = bank.iterator ();
+        LOCAL (it);
+
+        for (it->first(); !it->isDone(); it->next())  {  sequences.push_back (it->item().toString());  }
+    }
+
+    /** */
+    void bank_random_2 ()
+    {
+        vector<string> s1, s2, s3, s4;
+
+        /** Two iterators of a seeded bank give the same sequences. */
+        BankRandom bank1 (10, 1000, 42);
+        bank_random_getSequences (bank1, s1);
+        bank_random_getSequences (bank1, s2);
+
+        /** Another bank with the same seed too. */
+        BankRandom bank2 (10, 1000, 42);
+        bank_random_getSequences (bank2, s3);
+
+        /** But not a bank with another seed. */
+        BankRandom bank3 (10, 1000, 43);
+        bank_random_getSequences (bank3, s4);
+
+        CPPUNIT_ASSERT (s1.size() == 10);
+        CPPUNIT_ASSERT (s1[0] != s1[1]);
+        CPPUNIT_ASSERT (s1 == s2);
+        CPPUNIT_ASSERT (s1 == s3);
+        CPPUNIT_ASSERT (s1 != s4);
+    }
+
     /********************************************************************************/
     void bank_splitter_1 ()
     {
@@ -25,6 +25,7 @@
 #include <gatb/kmer/impl/SortingCountAlgorithm.hpp>
 #include <gatb/kmer/impl/BloomAlgorithm.hpp>
 #include <gatb/kmer/impl/DebloomAlgorithm.hpp>
+#include <gatb/kmer/impl/BloomBuilder.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
@@ -45,6 +46,7 @@ using namespace gatb::core::kmer;
 using namespace gatb::core::kmer::impl;
 
 using namespace gatb::core::tools::dp;
+using namespace gatb::core::tools::dp::impl;
 
 using namespace gatb::core::tools::collections;
 using namespace gatb::core::tools::collections::impl;
@@ -68,6 +70,7 @@ class TestDebloom : public Test
     CPPUNIT_TEST_SUITE_GATB (TestDebloom);
 
         CPPUNIT_TEST_GATB (Debloom_check1);
+        CPPUNIT_TEST_GATB (Debloom_bloomByBlocks);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -160,6 +163,44 @@ public:
 
         CPPUNIT_ASSERT (checkValues.size() == okValues.size());
     }
+
+    /********************************************************************************/
+    void Debloom_bloomByBlocks_aux (BloomKind kind, size_t nbCores)
+    {
+        size_t kmerSize = 31;
+
+        vector<Kmer<>::Count> kmers;
+        for (size_t i=0; i<200*1000; i++)
+        {
+            Kmer<>::Count c;
+            c.value.setVal (((u_int64_t)rand() << 31 | rand()) & ((1ULL << (2*kmerSize)) - 1));
+            c.abundance = 1 + rand() % 3;
+            kmers.push_back (c);
+        }
+
+        /** The Bloom filter built by blocks must be the same as the one built with atomic insertions. */
+        BloomBuilder<> builderAtomic (kmers.size()*12, 7, kmerSize, kind, nbCores, 2, false);
+        BloomBuilder<> builderBlocks (kmers.size()*12, 7, kmerSize, kind, nbCores, 2, true);
+
+        IBloom<Kmer<>::Type>* bloomAtomic = builderAtomic.build (new VectorIterator2<Kmer<>::Count> (kmers));  LOCAL (bloomAtomic);
+        IBloom<Kmer<>::Type>* bloomBlocks = builderBlocks.build (new VectorIterator2<Kmer<>::Count> (kmers));  LOCAL (bloomBlocks);
+
+        CPPUNIT_ASSERT (bloomAtomic->getSize() == bloomBlocks->getSize());
+        CPPUNIT_ASSERT (memcmp (bloomAtomic->getArray(), bloomBlocks->getArray(), bloomAtomic->getSize()) == 0);
+
+        for (size_t i=0; i<kmers.size(); i++)
+        {
+            if (kmers[i].abundance >= 2)  {  CPPUNIT_ASSERT (bloomBlocks->contains (kmers[i].value));  }
+        }
+    }
+
+    /** */
+    void Debloom_bloomByBlocks ()
+    {
+        Debloom_bloomByBlocks_aux (BLOOM_CACHE,    4);
+        Debloom_bloomByBlocks_aux (BLOOM_NEIGHBOR, 4);
+        Debloom_bloomByBlocks_aux (BLOOM_NEIGHBOR, 3);
+    }
 };
 
 /********************************************************************************/
@@ -25,6 +25,7 @@
 #include <gatb/system/impl/FileSystemCommon.hpp>
 
 #include <list>
+#include <vector>
 #include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
 
@@ -50,6 +51,7 @@ class TestSystem : public Test
         CPPUNIT_TEST_GATB (types_check);
 
         CPPUNIT_TEST_GATB (info_get);
+        CPPUNIT_TEST_GATB (info_counters);
 
 #ifdef WITH_MEMORY_SIZE_STORE
         CPPUNIT_TEST_GATB (memory_basicAlloc);
@@ -58,6 +60,7 @@ class TestSystem : public Test
         CPPUNIT_TEST_GATB (memory_realloc);
         CPPUNIT_TEST_GATB (memory_boundedAllocator);
         CPPUNIT_TEST_GATB (memory_perfAllocator);
+        CPPUNIT_TEST_GATB (memory_alignedAlloc);
 #endif
         CPPUNIT_TEST_GATB (memory_memset);
         CPPUNIT_TEST_GATB (memory_memcpy);
@@ -118,6 +121,51 @@ public:
         CPPUNIT_ASSERT (System::info().getVersion().empty() == false);
     }
 
+    /********************************************************************************/
+    void info_counters_aux (bool thread)
+    {
+        ISystemInfo::CountersInfo* info = System::info().createCountersInfo (thread);
+        LOCAL (info);
+
+        string filename = System::file().getTemporaryDirectory() + string("/counters");
+        vector<char> buffer (1<<20, 'a');
+
+        info->start();
+
+        /** We do something, and we write some bytes into a file. */
+        volatile u_int64_t sum = 0;
+        for (u_int64_t i=0; i<50*1000*1000; i++)  { sum += i*i; }
+
+        FILE* file = fopen (filename.c_str(), "w");
+        CPPUNIT_ASSERT (file != 0);
+        CPPUNIT_ASSERT (fwrite (buffer.data(), 1, buffer.size(), file) == buffer.size());
+        fclose (file);
+
+        info->stop();
+
+        const ISystemInfo::Counters& c = info->getCounters();
+
+        /** Not all the counters are available everywhere, so we check only the available ones. */
+        if (c.available[ISystemInfo::Counters::INSTRUCTIONS])   { CPPUNIT_ASSERT (c.values[ISystemInfo::Counters::INSTRUCTIONS] >= 50*1000*1000); }
+        if (c.available[ISystemInfo::Counters::CPU_USER] && c.available[ISystemInfo::Counters::CPU_SYS])
+        {
+            CPPUNIT_ASSERT (c.values[ISystemInfo::Counters::CPU_USER] + c.values[ISystemInfo::Counters::CPU_SYS] > 0);
+        }
+        if (c.available[ISystemInfo::Counters::BYTES_WRITTEN])  { CPPUNIT_ASSERT (c.values[ISystemInfo::Counters::BYTES_WRITTEN] >= buffer.size()); }
+
+#ifdef __linux__
+        CPPUNIT_ASSERT (c.available[ISystemInfo::Counters::CPU_USER]);
+#endif
+
+        System::file().remove (filename);
+    }
+
+    void info_counters ()
+    {
+        info_counters_aux (false);
+        info_counters_aux (true);
+    }
+
     /********************************************************************************/
     class Check
     {
@@ -375,6 +423,60 @@ public:
         Check::singleton().memory_boundedAllocator (mem);
     }
 
+    /********************************************************************************/
+    /** \brief Aligned and huge blocks allocations, with statistics through a bounded allocator
+     *
+     * Test of \ref gatb::core::system::IMemory::memalign()    \n
+     * Test of \ref gatb::core::system::IMemory::callocHuge()  \n
+     * Test of \ref gatb::core::system::IMemory::free()        \n
+     */
+    void memory_alignedAlloc ()
+    {
+        IMemory::BlockSize_t alignTable[] = { 8, 64, 4*KBYTE, 2*MBYTE };
+
+        IMemoryAllocator* allocTable[] = { &System::memory(), &System::memoryNuma() };
+
+        for (size_t a=0; a<sizeof(allocTable)/sizeof(allocTable[0]); a++)
+        {
+            MemoryBounded bounded (*allocTable[a], 64*MBYTE, 256*MBYTE);
+
+            IMemoryAllocator* memTable[] = { allocTable[a], &bounded };
+
+            for (size_t m=0; m<sizeof(memTable)/sizeof(memTable[0]); m++)
+            {
+                IMemoryAllocator& mem = *memTable[m];
+
+                for (size_t i=0; i<sizeof(alignTable)/sizeof(alignTable[0]); i++)
+                {
+                    u_int8_t* ptr = (u_int8_t*) mem.memalign (100*KBYTE, alignTable[i]);
+                    CPPUNIT_ASSERT (ptr != 0);
+                    CPPUNIT_ASSERT ((size_t)ptr % alignTable[i] == 0);
+                    ptr[0] = ptr[100*KBYTE-1] = 1;
+                    mem.free (ptr);
+                }
+
+                /** Small and big huge blocks must be zeroed. */
+                IMemory::BlockSize_t sizeTable[] = { 1*KBYTE, 5*MBYTE+3 };
+                for (size_t i=0; i<sizeof(sizeTable)/sizeof(sizeTable[0]); i++)
+                {
+                    u_int8_t* ptr = (u_int8_t*) mem.callocHuge (sizeTable[i]);
+                    CPPUNIT_ASSERT (ptr != 0);
+                    for (size_t j=0; j<sizeTable[i]; j+=97)  {  CPPUNIT_ASSERT (ptr[j] == 0);  }
+                    ptr[sizeTable[i]-1] = 1;
+                    mem.free (ptr);
+                }
+            }
+
+            /** Everything has been released. */
+            CPPUNIT_ASSERT (bounded.getNbBlocks()     == 0);
+            CPPUNIT_ASSERT (bounded.getCurrentUsage() == 0);
+
+            /** The bounded allocator rejects too big blocks. */
+            CPPUNIT_ASSERT_THROW (bounded.callocHuge (128*MBYTE),         gatb::core::system::Exception);
+            CPPUNIT_ASSERT_THROW (bounded.memalign   (128*MBYTE, 64),     gatb::core::system::Exception);
+        }
+    }
+
     /********************************************************************************/
     /** \brief Memory allocation performance test
      *
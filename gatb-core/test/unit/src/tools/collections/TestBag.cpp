@@ -27,11 +27,13 @@
 
 #include <gatb/tools/designpattern/api/ICommand.hpp>
 #include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 
 #include <gatb/system/api/ISmartPointer.hpp>
 #include <gatb/system/impl/System.hpp>
 
 #include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -59,6 +61,7 @@ class TestBag : public Test
 
         CPPUNIT_TEST_GATB (bag_checkFile);
         CPPUNIT_TEST_GATB (bag_checkCache);
+        CPPUNIT_TEST_GATB (bag_checkCacheSorted);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -191,6 +194,101 @@ public:
             }
         }
     }
+
+    /********************************************************************************/
+
+    class BagSortedInsertCommand : public ICommand, public SmartPointer
+    {
+    public:
+        BagSortedInsertCommand (Bag<u_int32_t>* ref, size_t cacheSize, ISynchronizer* synchro, size_t nbIters, u_int32_t seed)
+            : _cache(ref, cacheSize, synchro), _nbIters(nbIters), _seed(seed) {}
+
+        void execute ()
+        {
+            /** We insert items in a pseudo random order. */
+            for (u_int32_t i=1; i<=_nbIters; i++)  {  _cache.insert ((i * 2654435761u) ^ _seed);  }
+
+            _cache.flush();
+        }
+
+    private:
+        BagCacheSorted<u_int32_t> _cache;
+        size_t                    _nbIters;
+        u_int32_t                 _seed;
+    };
+
+    /** */
+    void bag_checkCacheSorted_aux (size_t nbItersTotal, size_t nbCores, size_t cacheSize)
+    {
+        /** We build the uri of the test file. */
+        string filename = System::file().getTemporaryDirectory() + string("/bagfile");
+
+        /** We set the number of iterations to be done in each thread. */
+        u_int64_t nbItersPerThread = nbItersTotal / nbCores;
+
+        /** We instantiate a bag. */
+        BagFile<u_int32_t>* bag = new BagFile<u_int32_t>(filename);
+        LOCAL (bag);
+
+        /** We need a command dispatcher. */
+        Dispatcher dispatcher (nbCores);
+
+        /** The threads share the synchronizer of the bag, as the collections of a PartitionCacheSortedRuns do. */
+        ISynchronizer* synchro = System::thread().newSynchronizer();
+        LOCAL (synchro);
+
+        /** We create several commands that will insert items into the bag file through a sorted cache. */
+        vector<ICommand*> commands (dispatcher.getExecutionUnitsNumber());
+        for (size_t i=0; i<commands.size(); i++)  { commands[i] = new BagSortedInsertCommand (bag, cacheSize, synchro, nbItersPerThread, i); }
+
+        /** We dispatch the commands. */
+        dispatcher.dispatchCommands (commands, 0);
+
+        /** We read the file. */
+        vector<u_int32_t> items;
+        IteratorFile<u_int32_t> it (filename);
+        for (it.first(); !it.isDone(); it.next())  {  items.push_back (*it);  }
+
+        CPPUNIT_ASSERT (items.size() == nbItersTotal);
+
+        /** The merge of the sorted runs of the file must give the sorted items. */
+        vector<u_int32_t> check (items);
+        std::sort (check.begin(), check.end());
+
+        size_t nbItemsRead = 0;
+        SortedRunsIterator<u_int32_t> itRuns (items);
+        for (itRuns.first(); !itRuns.isDone(); itRuns.next(), nbItemsRead++)
+        {
+            CPPUNIT_ASSERT (nbItemsRead < check.size());
+            CPPUNIT_ASSERT (itRuns.item() == check[nbItemsRead]);
+        }
+
+        /** We check we read the correct number of items. */
+        CPPUNIT_ASSERT (nbItemsRead == nbItersTotal);
+
+        /** We remove the temporary file. */
+        System::file().remove (filename);
+    }
+
+    /** */
+    void bag_checkCacheSorted ()
+    {
+        /** WARNING: nbItersTotal has to be a multiple of nbCores. */
+        size_t nbItersTotalTable[] = { 8, 5*1000, 500*1000};
+        size_t nbCoresTable[]      = { 1, 2, 4, 8};
+        size_t cacheSizeTable[]    = { 10, 1000, 100*1000};
+
+        for (size_t h=0; h<ARRAY_SIZE(nbItersTotalTable); h++)
+        {
+            for (size_t i=0; i<ARRAY_SIZE(nbCoresTable); i++)
+            {
+                for (size_t j=0; j<ARRAY_SIZE(cacheSizeTable); j++)
+                {
+                    bag_checkCacheSorted_aux (nbItersTotalTable[h], nbCoresTable[i], cacheSizeTable[j]);
+                }
+            }
+        }
+    }
 };
 
 
@@ -20,6 +20,8 @@
 
 #define USE_LARGEINT_CONSTRUCTOR 1 // one of the only cases where LargeInt should be using its constructor; but got lazy to want to change the unit tests here.
 #include <gatb/tools/collections/impl/Bloom.hpp>
+#include <gatb/tools/collections/impl/ContainerSet.hpp>
+#include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 
@@ -36,6 +38,7 @@ using namespace std;
 using namespace gatb::core::tools::collections;
 using namespace gatb::core::tools::collections::impl;
 using namespace gatb::core::tools::math;
+using namespace gatb::core::tools::dp::impl;
 
 /********************************************************************************/
 namespace gatb  {  namespace tests  {
@@ -51,6 +54,7 @@ class TestContainer : public Test
     CPPUNIT_TEST_SUITE_GATB (TestContainer);
 
         CPPUNIT_TEST_GATB (bloom_checkContains);
+        CPPUNIT_TEST_GATB (eytzinger_checkContains);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -132,6 +136,38 @@ public:
         bloom_checkContains_aux<LargeInt<5> > (values2, ARRAY_SIZE(values2));
         bloom_checkContains_aux<LargeInt<5> > (values3, ARRAY_SIZE(values3));
     }
+
+    /********************************************************************************/
+    template<typename Item> void eytzinger_checkContains_aux (size_t size)
+    {
+        /** We insert odd values (shuffled, with duplicates) and check against the sorted vector container. */
+        vector<Item> values;
+        for (size_t i=0; i<size; i++)  {  Item item;  item.setVal (2*(rand()%(2*size+1))+1);  values.push_back (item);  }
+
+        ContainerSet<Item>*       set = new ContainerSet<Item>       (new VectorIterator<Item> (values));  LOCAL (set);
+        ContainerEytzinger<Item>* eyt = new ContainerEytzinger<Item> (new VectorIterator<Item> (values));  LOCAL (eyt);
+
+        for (size_t i=0; i<size; i++)  {  CPPUNIT_ASSERT (eyt->contains (values[i]) == true);  }
+
+        for (u_int64_t i=0; i<4*size+4; i++)
+        {
+            Item item;  item.setVal (i);
+            CPPUNIT_ASSERT (eyt->contains (item) == set->contains (item));
+        }
+    }
+
+    /** */
+    void eytzinger_checkContains ()
+    {
+        size_t sizes[] = { 0, 1, 2, 3, 7, 8, 100, 1000, 12345 };
+
+        for (size_t i=0; i<ARRAY_SIZE(sizes); i++)
+        {
+            eytzinger_checkContains_aux<NativeInt64>  (sizes[i]);
+            eytzinger_checkContains_aux<LargeInt<2> > (sizes[i]);
+            eytzinger_checkContains_aux<LargeInt<3> > (sizes[i]);
+        }
+    }
 };
 
 /********************************************************************************/
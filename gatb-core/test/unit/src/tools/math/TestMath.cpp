@@ -22,6 +22,7 @@
 
 #include <gatb/tools/math/LargeInt.hpp>
 #include <gatb/tools/math/Integer.hpp>
+#include <gatb/tools/math/HyperLogLog.hpp>
 
 using namespace std;
 using namespace gatb::core::tools::math;
@@ -38,6 +39,8 @@ class TestMath : public Test
         CPPUNIT_TEST_GATB (math_checkBasic);
         CPPUNIT_TEST_GATB (math_checkFibo);
         CPPUNIT_TEST_GATB (math_test1);
+        CPPUNIT_TEST_GATB (math_revcomp);
+        CPPUNIT_TEST_GATB (math_hyperloglog);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -172,6 +175,75 @@ public:
         math_test1_template <LargeInt<4> >();
         math_test1_template <LargeInt<5> >();
     }
+
+    /********************************************************************************/
+    template <typename T> T math_revcomp_random (u_int64_t& seed, size_t kmerSize)
+    {
+        T res (0);
+        for (size_t i=0; i<kmerSize; i++)
+        {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            res = (res << 2) + T(seed >> 62);
+        }
+        return res;
+    }
+
+    template <typename T, typename U> void math_revcomp_template (size_t kmerSizeMax)
+    {
+        u_int64_t seedT = 17;
+        u_int64_t seedU = 17;
+
+        for (size_t kmerSize=1; kmerSize<=kmerSizeMax; kmerSize++)
+        {
+            T t = math_revcomp_random<T> (seedT, kmerSize);
+            U u = math_revcomp_random<U> (seedU, kmerSize);
+
+            /** The two integer types must agree on the kmer string and its reverse complement. */
+            CPPUNIT_ASSERT (t.toString(kmerSize) == u.toString(kmerSize));
+            CPPUNIT_ASSERT (revcomp(t,kmerSize).toString(kmerSize) == revcomp(u,kmerSize).toString(kmerSize));
+
+            CPPUNIT_ASSERT (revcomp (revcomp(t,kmerSize), kmerSize) == t);
+
+            /** Shifts must give the same nucleotides whatever the word boundaries are. */
+            CPPUNIT_ASSERT ( ((t >> 2) << 2).toString(kmerSize) == ((u >> 2) << 2).toString(kmerSize) );
+        }
+    }
+
+    void math_revcomp ()
+    {
+        math_revcomp_template <LargeInt<1>, LargeInt<2> > (32);
+        math_revcomp_template <LargeInt<2>, LargeInt<3> > (64);
+        math_revcomp_template <LargeInt<3>, LargeInt<4> > (95);
+        math_revcomp_template <LargeInt<4>, LargeInt<5> > (127);
+    }
+
+    /********************************************************************************/
+    void math_hyperloglog ()
+    {
+        size_t nbValues[] = { 10, 1000, 100000, 1000000 };
+
+        for (size_t n=0; n<sizeof(nbValues)/sizeof(nbValues[0]); n++)
+        {
+            HyperLogLog hll, hllEven, hllOdd;
+
+            for (u_int64_t i=0; i<nbValues[n]; i++)
+            {
+                /** Each value is added twice, it must be counted once. */
+                hll.add (hash1 (LargeInt<1>(i), 0));
+                hll.add (hash1 (LargeInt<1>(i), 0));
+
+                if (i%2==0)  { hllEven.add (hash1 (LargeInt<1>(i), 0)); }
+                else         { hllOdd.add  (hash1 (LargeInt<1>(i), 0)); }
+            }
+
+            double error = std::abs ((double)hll.estimate() - (double)nbValues[n]) / nbValues[n];
+            CPPUNIT_ASSERT (error < 0.03);
+
+            /** The merge of two estimators must give the estimator of the union. */
+            hllEven.merge (hllOdd);
+            CPPUNIT_ASSERT (hllEven.estimate() == hll.estimate());
+        }
+    }
 };
 
 /********************************************************************************/
@@ -29,10 +29,18 @@
 #include <gatb/tools/misc/impl/Property.hpp>
 
 #include <gatb/tools/misc/impl/StringLine.hpp>
+#include <gatb/tools/misc/impl/TimeInfo.hpp>
+#include <gatb/tools/misc/impl/ProgressJson.hpp>
+
+#include <gatb/tools/designpattern/impl/Command.hpp>
 
 #include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
 #include <memory>
+#include <fstream>
+#include <unistd.h>
+
+#include <json/json.hpp>
 
 using namespace std;
 
@@ -40,6 +48,7 @@ using namespace gatb::core::system;
 using namespace gatb::core::system::impl;
 
 using namespace gatb::core::tools::dp;
+using namespace gatb::core::tools::dp::impl;
 using namespace gatb::core::tools::misc;
 using namespace gatb::core::tools::misc::impl;
 
@@ -67,6 +76,11 @@ class TestMisc : public Test
 
         CPPUNIT_TEST_GATB (stringline_check1);
 
+        CPPUNIT_TEST_GATB (timeinfo_checkCounters);
+
+        CPPUNIT_TEST_GATB (progressjson_checkProperties);
+        CPPUNIT_TEST_GATB (progressjson_checkSink);
+
     CPPUNIT_TEST_SUITE_GATB_END();
 
 public:
@@ -406,6 +420,166 @@ public:
         CPPUNIT_ASSERT (StringLine::format (s1).size() == StringLine::getDefaultWidth());
         CPPUNIT_ASSERT (StringLine::format (s2).size() == StringLine::getDefaultWidth());
     }
+
+    /********************************************************************************/
+    struct BusyCommand : public ICommand, public SmartPointer
+    {
+        BusyCommand (u_int64_t nb) : _nb(nb)  {}
+        void execute ()  {  volatile u_int64_t sum = 0;  for (u_int64_t i=0; i<_nb; i++)  { sum += i*i; }  }
+        u_int64_t _nb;
+    };
+
+    void timeinfo_checkCounters (void)
+    {
+        TimeInfo::setCounters (true);
+
+        TimeInfo ti;
+        Dispatcher dispatcher (2);
+
+        {
+            TIME_INFO (ti, "dispatch");
+
+            /** The second command has more work, so the threads are unbalanced. */
+            vector<ICommand*> commands;
+            commands.push_back (new BusyCommand (10*1000*1000));
+            commands.push_back (new BusyCommand (40*1000*1000));
+            dispatcher.dispatchCommands (commands);
+        }
+
+        TimeInfo::setCounters (false);
+
+        const IDispatcher::CommandsCounters& counters = dispatcher.getCommandsCounters();
+        CPPUNIT_ASSERT (counters.nbDispatches == 1);
+        CPPUNIT_ASSERT (counters.nbCommands   == 2);
+
+        /** The instructions may not be available, but the cpu times should be (at least on Linux). */
+        if (counters.total.available[ISystemInfo::Counters::INSTRUCTIONS])
+        {
+            CPPUNIT_ASSERT (counters.total.values[ISystemInfo::Counters::INSTRUCTIONS] >= 50*1000*1000);
+            CPPUNIT_ASSERT (counters.getImbalance(ISystemInfo::Counters::INSTRUCTIONS) > 1.2);
+            CPPUNIT_ASSERT (ti.getCountersByKey("dispatch").values[ISystemInfo::Counters::INSTRUCTIONS] >= 50*1000*1000);
+        }
+
+#ifdef __linux__
+        CPPUNIT_ASSERT (ti.getCountersByKey("dispatch").available[ISystemInfo::Counters::CPU_USER] == true);
+        CPPUNIT_ASSERT (counters.total.available[ISystemInfo::Counters::CPU_USER] == true);
+#endif
+
+        /** The counters are given with the times. */
+        IProperties* props = ti.getProperties ("time");
+        LOCAL (props);
+        CPPUNIT_ASSERT (props->get ("dispatch") != 0);
+#ifdef __linux__
+        CPPUNIT_ASSERT (props->get ("cpu_user") != 0);
+#endif
+
+        /** An unknown label has no counter. */
+        CPPUNIT_ASSERT (ti.getCountersByKey("foo").available[ISystemInfo::Counters::CPU_USER] == false);
+    }
+
+    /********************************************************************************/
+    void progressjson_checkProperties (void)
+    {
+        Properties props;
+        props.add (0, "root");
+        props.add (1, "nb",     "%d", 12);
+        props.add (1, "time",   "%.3f", 1.5);
+        props.add (2, "step",   "%s", "foo");
+        props.add (1, "kind",   "%s", "bar");
+
+        json::JSON root;
+        JsonPropertiesVisitor visitor (root);
+        props.accept (&visitor);
+
+        /** The numbers are JSON numbers; a property having children is an object, with its value in the 'value' field. */
+        CPPUNIT_ASSERT (root["root"]["nb"].ToInt() == 12);
+        CPPUNIT_ASSERT (root["root"]["time"]["value"].ToFloat() == 1.5);
+        CPPUNIT_ASSERT (root["root"]["time"]["step"].ToString() == "foo");
+        CPPUNIT_ASSERT (root["root"]["kind"].ToString() == "bar");
+    }
+
+    /********************************************************************************/
+    void progressjson_checkSink (void)
+    {
+        string filename = System::file().getTemporaryDirectory() + "/" + System::file().getTemporaryFilename("progress.json");
+
+        ProgressJsonSink& sink = ProgressJsonSink::singleton();
+        CPPUNIT_ASSERT (sink.isOpen() == false);
+
+        /** The listeners are not wrapped while the sink is closed. */
+        IteratorListener* listener0 = ProgressJson::wrap (new IteratorListener(), 10, "foo");
+        LOCAL (listener0);
+        CPPUNIT_ASSERT (dynamic_cast<ProgressJson*> (listener0) == 0);
+
+        CPPUNIT_ASSERT (sink.open (filename, 0.1) == true);
+        CPPUNIT_ASSERT (sink.open (filename, 0.1) == false);
+
+        sink.beginStage ("stage1");
+        {
+            IteratorListener* listener = ProgressJson::wrap (new IteratorListener(), 1000, "my task   ");
+            LOCAL (listener);
+            CPPUNIT_ASSERT (dynamic_cast<ProgressJson*> (listener) != 0);
+
+            listener->init ();
+            listener->inc (400);
+
+            /** We let the sink write some snapshots. */
+            usleep (500*1000);
+
+            listener->finish ();
+        }
+
+        Properties info;
+        info.add (0, "stage1");
+        info.add (1, "nb_items", "%d", 1000);
+        sink.endStage ("stage1", &info);
+
+        Properties report;
+        report.add (0, "job");
+        report.add (1, "result", "%s", "done");
+        sink.close (&report);
+        CPPUNIT_ASSERT (sink.isOpen() == false);
+
+        /** We check the JSON lines of the file. */
+        ifstream is (filename.c_str());
+        string line;
+        vector<json::JSON> objects;
+        while (getline (is, line))  {  objects.push_back (json::LoadJson (line));  }
+        is.close();
+        System::file().remove (filename);
+
+        /** The 'progress' snapshots are written by the thread of the sink, so they may be interleaved
+         * with the other objects; we check them apart. */
+        vector<json::JSON> events;
+        size_t nbProgress = 0;
+        for (size_t i=0; i<objects.size(); i++)
+        {
+            if (objects[i]["type"].ToString() != "progress")  {  events.push_back (objects[i]);  continue;  }
+
+            /** The task is padded with spaces for the progress bars, not in the snapshots. */
+            if (objects[i]["task"].ToString() == "my task" && objects[i]["stage"].ToString() == "stage1")
+            {
+                CPPUNIT_ASSERT (objects[i]["todo"].ToInt() == 1000);
+                CPPUNIT_ASSERT (objects[i]["done"].ToInt() >= 400);
+                nbProgress++;
+            }
+        }
+        CPPUNIT_ASSERT (nbProgress >= 1);
+
+        CPPUNIT_ASSERT (events.size() == 3);
+        CPPUNIT_ASSERT (events[0]["type"].ToString()  == "stage_begin");
+        CPPUNIT_ASSERT (events[0]["stage"].ToString() == "stage1");
+
+        json::JSON& end = events[1];
+        CPPUNIT_ASSERT (end["type"].ToString() == "stage_end");
+        CPPUNIT_ASSERT (end["info"]["stage1"]["nb_items"].ToInt() == 1000);
+
+        json::JSON& last = events[2];
+        CPPUNIT_ASSERT (last["type"].ToString()   == "report");
+        CPPUNIT_ASSERT (last["status"].ToString() == "ok");
+        CPPUNIT_ASSERT (last["stages"].length()   == 1);
+        CPPUNIT_ASSERT (last["info"]["job"]["result"].ToString() == "done");
+    }
 };
 
 /********************************************************************************/
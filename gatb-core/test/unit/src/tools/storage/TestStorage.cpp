@@ -74,6 +74,8 @@ class TestStorage : public Test
 
         CPPUNIT_TEST_GATB (storage_HDF5_check_collection);
         CPPUNIT_TEST_GATB (storage_HDF5_check_partition);
+
+        CPPUNIT_TEST_GATB (storage_mmap_check);
         
         CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -453,6 +455,85 @@ public:
     }
 
 
+    /********************************************************************************/
+    void storage_mmap_check ()
+    {
+        NativeInt64 values[1<<12];  for (size_t i=0; i<ARRAY_SIZE(values); i++)  { values[i]=3*i+1; }
+        size_t nbParts = 4;
+
+        /** We create a storage and fill it; the file is written when the storage is released. */
+        {
+            Storage* storage = StorageFactory(STORAGE_MMAP).create ("aStorage", true, false);
+            LOCAL (storage);
+
+            Group& group = (*storage)().getGroup ("test");
+            group.setProperty ("foo", "bar");
+
+            Collection<NativeInt64>& collection = group.getCollection<NativeInt64> ("values");
+            collection.insert (values, ARRAY_SIZE(values));
+            collection.addProperty ("nb", "4096");
+
+            Partition<NativeInt64>& partition = group.getPartition<NativeInt64> ("parts", nbParts);
+            for (size_t i=0; i<ARRAY_SIZE(values); i++)  {  partition[i%nbParts].insert (values[i]);  }
+            partition.flush ();
+
+            Storage::ostream os (group, "stream");
+            os.write ((const char*)values, sizeof(values));
+            os.flush ();
+        }
+
+        CPPUNIT_ASSERT (StorageFactory(STORAGE_MMAP).exists ("aStorage"));
+
+        /** We open the storage again, in read only mode. */
+        Storage* storage = StorageFactory(STORAGE_MMAP).create ("aStorage", false, false);
+        LOCAL (storage);
+
+        Group& group = (*storage)().getGroup ("test");
+        CPPUNIT_ASSERT (group.getProperty ("foo") == "bar");
+
+        /** The items of the collection are read in place. */
+        size_t nbItems = 0;
+        NativeInt64* mapped = group.mapCollection<NativeInt64> ("values", nbItems);
+        CPPUNIT_ASSERT (mapped != 0);
+        CPPUNIT_ASSERT (nbItems == ARRAY_SIZE(values));
+        for (size_t i=0; i<nbItems; i++)  {  CPPUNIT_ASSERT (mapped[i] == values[i]);  }
+
+        Collection<NativeInt64>& collection = group.getCollection<NativeInt64> ("values");
+        CPPUNIT_ASSERT (collection.getNbItems() == (int)ARRAY_SIZE(values));
+        CPPUNIT_ASSERT (collection.getProperty ("nb") == "4096");
+
+        size_t idx=0;
+        Iterator<NativeInt64>* it = collection.iterator();  LOCAL(it);
+        for (it->first(); !it->isDone(); it->next(), idx++)  {  CPPUNIT_ASSERT (it->item() == values[idx]);  }
+        CPPUNIT_ASSERT (idx == ARRAY_SIZE(values));
+
+        /** The number of parts of the partition is retrieved from the storage. */
+        Partition<NativeInt64>& partition = group.getPartition<NativeInt64> ("parts");
+        CPPUNIT_ASSERT (partition.size() == nbParts);
+        for (size_t p=0; p<nbParts; p++)
+        {
+            idx=0;
+            Iterator<NativeInt64>* itp = partition[p].iterator();  LOCAL(itp);
+            for (itp->first(); !itp->isDone(); itp->next(), idx++)  {  CPPUNIT_ASSERT (itp->item() == values[idx*nbParts + p]);  }
+            CPPUNIT_ASSERT (idx == ARRAY_SIZE(values)/nbParts);
+        }
+
+        NativeInt64 check[ARRAY_SIZE(values)];
+        Storage::istream is (group, "stream");
+        is.read ((char*)check, sizeof(check));
+        CPPUNIT_ASSERT ((size_t)is.gcount() == sizeof(check));
+        CPPUNIT_ASSERT (memcmp (check, values, sizeof(check)) == 0);
+
+        /** A storage opened in read only mode can't be modified. */
+        bool hasThrown = false;
+        try  {  group.setProperty ("foo", "baz");  }  catch (gatb::core::system::Exception&)  { hasThrown = true; }
+        CPPUNIT_ASSERT (hasThrown);
+
+        /** We remove physically the storage. */
+        storage->remove ();
+        CPPUNIT_ASSERT (StorageFactory(STORAGE_MMAP).exists ("aStorage") == false);
+    }
+
 };
 
 /********************************************************************************/
@@ -20,12 +20,19 @@
 #include <gatb/gatb_core.hpp>
 
 #include <sstream>
+#include <random>
 
 /********************************************************************************/
-void SaveAsFasta (IBank* bank, const std::string& uri)
+/** Save a bank; substitution errors may be added to the sequences with the given rate. */
+void SaveAsFasta (IBank* bank, const std::string& uri, double errorRate=0, u_int64_t seed=0)
 {
+    static const char ACGT[] = "ACGT";
+
     BankFasta output (uri);
 
+    std::mt19937_64 random (seed != 0 ? seed : time(NULL));
+    std::uniform_real_distribution<double> uniform (0.0, 1.0);
+
     Iterator<Sequence>* it = bank->iterator();
     LOCAL (it);
 
@@ -42,7 +49,22 @@ void SaveAsFasta (IBank* bank, const std::string& uri)
         ss << count++ << "__len__" << seq.getDataSize();
         seq.setComment (ss.str());
 
-        output.insert (seq);
+        if (errorRate <= 0)  {  output.insert (seq);  continue;  }
+
+        /** The sequence may refer to the data of another bank (BankSplitter), so the errors are put in a copy. */
+        std::string data = seq.toString();
+        for (size_t i=0; i<data.size(); i++)
+        {
+            if (uniform (random) < errorRate)
+            {
+                const char* nt = strchr (ACGT, data[i]);
+                data[i] = ACGT [((nt ? nt-ACGT : 0) + 1 + random()%3) % 4];
+            }
+        }
+
+        Sequence read ((char*)data.c_str());
+        read.setComment (seq.getComment());
+        output.insert (read);
     }
 }
 
@@ -57,12 +79,16 @@ int main (int argc, char* argv[])
     const char* READ_LEN      = "-read-len";
     const char* OVERLAP_LEN   = "-overlap-len";
     const char* COVERAGE      = "-coverage";
+    const char* ERROR_RATE    = "-error-rate";
+    const char* SEED          = "-seed";
 
     parser.push_back (new OptionOneParam (OUTPUT_PREFIX,  "output prefix",               true));
     parser.push_back (new OptionOneParam (SEQ_LEN,        "sequence length",             false,  "1000000"));
     parser.push_back (new OptionOneParam (READ_LEN,       "read length",                 false,  "150" ));
     parser.push_back (new OptionOneParam (OVERLAP_LEN,    "overlap between two reads",   false,  "50" ));
     parser.push_back (new OptionOneParam (COVERAGE,       "coverage",                    false,  "3" ));
+    parser.push_back (new OptionOneParam (ERROR_RATE,     "substitution rate of the reads", false,  "0" ));
+    parser.push_back (new OptionOneParam (SEED,           "seed of the random generators (0 for a seed given by the time)", false,  "0" ));
 
     try
     {
@@ -70,7 +96,7 @@ int main (int argc, char* argv[])
         IProperties* options = parser.parse (argc, argv);
 
         /** We create the random sequence. */
-        IBank* randomBank = new BankRandom (1, options->getInt(SEQ_LEN));
+        IBank* randomBank = new BankRandom (1, options->getInt(SEQ_LEN), options->getInt(SEED));
         LOCAL (randomBank);
 
         /** We create the reads bank. */
@@ -86,7 +112,9 @@ int main (int argc, char* argv[])
         SaveAsFasta (randomBank, options->getStr(OUTPUT_PREFIX) + "_sequence.fa");
 
         /** We save the reads bank. */
-        SaveAsFasta (readsBank, options->getStr(OUTPUT_PREFIX) + "_reads.fa");
+        SaveAsFasta (readsBank, options->getStr(OUTPUT_PREFIX) + "_reads.fa", options->getDouble(ERROR_RATE),
+            options->getInt(SEED) != 0 ? options->getInt(SEED) + 1 : 0
+        );
     }
     catch (OptionFailure& e)
     {